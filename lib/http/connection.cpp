@@ -9,6 +9,8 @@
 //
 
 #include "connection.hpp"
+#include <algorithm>
+#include <cctype>
 #include <utility>
 #include <vector>
 #include "connection_manager.hpp"
@@ -19,6 +21,46 @@ namespace http
 namespace server
 {
 
+const std::size_t connection::max_body_size = 16 * 1024 * 1024;
+
+namespace
+{
+/// Find the body length announced by the request, 0 if there is none.
+/// Returns false if the Content-Length header is malformed.
+bool
+content_length(const request& req, std::size_t& length)
+{
+    static const std::string name = "content-length";
+    length = 0;
+    for (auto const& h : req.headers)
+    {
+        if (h.name.size() != name.size() ||
+            !std::equal(h.name.begin(), h.name.end(), name.begin(),
+                        [](char a, char b)
+                        {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            }))
+        {
+            continue;
+        }
+        // more digits than that could overflow
+        if (h.value.empty() || h.value.size() > 18)
+        {
+            return false;
+        }
+        for (char c : h.value)
+        {
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+            {
+                return false;
+            }
+            length = length * 10 + (c - '0');
+        }
+    }
+    return true;
+}
+}
+
 connection::connection(asio::ip::tcp::socket socket,
                        connection_manager& manager, server& handler)
     : socket_(std::move(socket))
@@ -50,14 +92,32 @@ connection::do_read()
         if (!ec)
         {
             request_parser::result_type result;
-            std::tie(result, std::ignore) = request_parser_.parse(
-                request_, buffer_.data(), buffer_.data() + bytes_transferred);
+            char* parsed;
+            char* end = buffer_.data() + bytes_transferred;
+            std::tie(result, parsed) =
+                request_parser_.parse(request_, buffer_.data(), end);
+
+            std::size_t length = 0;
+            if (result == request_parser::good &&
+                !content_length(request_, length))
+            {
+                result = request_parser::bad;
+            }
 
-            if (result == request_parser::good)
+            if (result == request_parser::good && length > max_body_size)
             {
-                request_handler_.handle_request(request_, reply_);
+                reply_ = reply::stock_reply(reply::request_entity_too_large);
                 do_write();
             }
+            else if (result == request_parser::good)
+            {
+                // whatever followed the headers in the buffer starts the body
+                request_.body.reserve(length);
+                request_.body.assign(
+                    parsed, std::min(length, static_cast<std::size_t>(
+                                                 end - parsed)));
+                do_read_body(length);
+            }
             else if (result == request_parser::bad)
             {
                 reply_ = reply::stock_reply(reply::bad_request);
@@ -75,6 +135,44 @@ connection::do_read()
     });
 }
 
+void
+connection::do_read_body(std::size_t length)
+{
+    if (request_.body.size() >= length)
+    {
+        handle_request();
+        return;
+    }
+
+    auto self(shared_from_this());
+    socket_.async_read_some(asio::buffer(buffer_),
+                            [this, self, length](asio::error_code ec,
+                                                 std::size_t bytes_transferred)
+                            {
+        if (!ec)
+        {
+            request_.body.append(
+                buffer_.data(),
+                std::min(bytes_transferred, length - request_.body.size()));
+            do_read_body(length);
+        }
+        else if (ec != asio::error::operation_aborted)
+        {
+            connection_manager_.stop(shared_from_this());
+        }
+    });
+}
+
+void
+connection::handle_request()
+{
+    auto self(shared_from_this());
+    request_handler_.handle_request(request_, reply_, [this, self]()
+                                    {
+        do_write();
+    });
+}
+
 void
 connection::do_write()
 {
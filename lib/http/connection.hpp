@@ -45,10 +45,20 @@ public:
   /// Stop all asynchronous operations associated with the connection.
   void stop();
 
+  /// Largest request body accepted, larger requests are refused.
+  static const std::size_t max_body_size;
+
 private:
   /// Perform an asynchronous read operation.
   void do_read();
 
+  /// Read the rest of a request body of the given length.
+  void do_read_body(std::size_t length);
+
+  /// Hand the complete request to the handler, the reply is written once the
+  /// handler is done with it.
+  void handle_request();
+
   /// Perform an asynchronous write operation.
   void do_write();
 
@@ -31,6 +31,8 @@ const std::string bad_request = "HTTP/1.0 400 Bad Request\r\n";
 const std::string unauthorized = "HTTP/1.0 401 Unauthorized\r\n";
 const std::string forbidden = "HTTP/1.0 403 Forbidden\r\n";
 const std::string not_found = "HTTP/1.0 404 Not Found\r\n";
+const std::string request_entity_too_large =
+    "HTTP/1.0 413 Request Entity Too Large\r\n";
 const std::string internal_server_error =
     "HTTP/1.0 500 Internal Server Error\r\n";
 const std::string not_implemented = "HTTP/1.0 501 Not Implemented\r\n";
@@ -66,6 +68,8 @@ to_buffer(reply::status_type status)
         return asio::buffer(forbidden);
     case reply::not_found:
         return asio::buffer(not_found);
+    case reply::request_entity_too_large:
+        return asio::buffer(request_entity_too_large);
     case reply::internal_server_error:
         return asio::buffer(internal_server_error);
     case reply::not_implemented:
@@ -155,6 +159,11 @@ const char not_found[] = "<html>"
                          "<head><title>Not Found</title></head>"
                          "<body><h1>404 Not Found</h1></body>"
                          "</html>";
+const char request_entity_too_large[] =
+    "<html>"
+    "<head><title>Request Entity Too Large</title></head>"
+    "<body><h1>413 Request Entity Too Large</h1></body>"
+    "</html>";
 const char internal_server_error[] =
     "<html>"
     "<head><title>Internal Server Error</title></head>"
@@ -203,6 +212,8 @@ to_string(reply::status_type status)
         return forbidden;
     case reply::not_found:
         return not_found;
+    case reply::request_entity_too_large:
+        return request_entity_too_large;
     case reply::internal_server_error:
         return internal_server_error;
     case reply::not_implemented:
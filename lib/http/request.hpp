@@ -26,6 +26,9 @@ struct request
   int http_version_major;
   int http_version_minor;
   std::vector<header> headers;
+
+  /// The request body, as announced by the Content-Length header.
+  std::string body;
 };
 
 } // namespace server
@@ -57,6 +57,12 @@ server::addRoute(const std::string& routeName, routeHandler callback)
     mRoutes[routeName] = callback;
 }
 
+void
+server::addPostRoute(const std::string& routeName, postRouteHandler callback)
+{
+    mPostRoutes[routeName] = callback;
+}
+
 void
 server::do_accept()
 {
@@ -85,22 +91,20 @@ server::~server()
     connection_manager_.stop_all();
 }
 
-void
-server::handle_request(const request& req, reply& rep)
+bool
+server::parse_uri(const request& req, std::string& command,
+                  std::string& params)
 {
     // Decode url to path.
     std::string request_path;
     if (!url_decode(req.uri, request_path))
     {
-        rep = reply::stock_reply(reply::bad_request);
-        return;
+        return false;
     }
 
     if (request_path.size() && request_path[0] == '/')
         request_path = request_path.substr(1);
 
-    std::string command;
-    std::string params;
     auto pos = request_path.find('?');
     if (pos == std::string::npos)
         command = request_path;
@@ -109,30 +113,42 @@ server::handle_request(const request& req, reply& rep)
         command = request_path.substr(0, pos);
         params = request_path.substr(pos);
     }
+    return true;
+}
+
+void
+server::set_content(reply& rep, const std::string& contentType)
+{
+    rep.status = reply::ok;
+    rep.headers.resize(2);
+    rep.headers[0].name = "Content-Length";
+    rep.headers[0].value = std::to_string(rep.content.size());
+    rep.headers[1].name = "Content-Type";
+    rep.headers[1].value = contentType;
+}
+
+void
+server::handle_request(const request& req, reply& rep)
+{
+    std::string command;
+    std::string params;
+    if (!parse_uri(req, command, params))
+    {
+        rep = reply::stock_reply(reply::bad_request);
+        return;
+    }
 
     if (mRoutes.find(command) != mRoutes.end())
     {
         mRoutes[command](params, rep.content);
-
-        rep.status = reply::ok;
-        rep.headers.resize(2);
-        rep.headers[0].name = "Content-Length";
-        rep.headers[0].value = std::to_string(rep.content.size());
-        rep.headers[1].name = "Content-Type";
-        rep.headers[1].value = "application/json";
+        set_content(rep, "application/json");
     }
     else
     {
         if(mRoutes.find("404") != mRoutes.end())
         {
             mRoutes["404"](params, rep.content);
-
-            rep.status = reply::ok;
-            rep.headers.resize(2);
-            rep.headers[0].name = "Content-Length";
-            rep.headers[0].value = std::to_string(rep.content.size());
-            rep.headers[1].name = "Content-Type";
-            rep.headers[1].value = "text/html";
+            set_content(rep, "text/html");
         } else
         {
             rep = reply::stock_reply(reply::not_found);
@@ -141,6 +157,29 @@ server::handle_request(const request& req, reply& rep)
     }
 }
 
+void
+server::handle_request(const request& req, reply& rep,
+                       std::function<void()> done)
+{
+    std::string command;
+    std::string params;
+    if (req.method != "POST" || !parse_uri(req, command, params) ||
+        mPostRoutes.find(command) == mPostRoutes.end())
+    {
+        handle_request(req, rep);
+        done();
+        return;
+    }
+
+    mPostRoutes[command](params, req.body,
+                         [&rep, done](const std::string& content)
+                         {
+        rep.content = content;
+        set_content(rep, "application/json");
+        done();
+    });
+}
+
 bool
 server::url_decode(const std::string& in, std::string& out)
 {
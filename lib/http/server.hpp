@@ -30,6 +30,13 @@ class server
 
 public:
     typedef std::function<void(const std::string&, std::string&)> routeHandler;
+    // called with the content of the reply once it is ready
+    typedef std::function<void(const std::string&)> replyHandler;
+    // handles a request to a POST route: gets the params and the body of the
+    // request, and calls the replyHandler when done, possibly later on
+    typedef std::function<void(const std::string&, const std::string&,
+                               replyHandler)>
+        postRouteHandler;
     server(const server&) = delete;
     server& operator=(const server&) = delete;
 
@@ -42,9 +49,15 @@ public:
     ~server();
 
     void addRoute(const std::string& routeName, routeHandler callback);
+    void addPostRoute(const std::string& routeName,
+                      postRouteHandler callback);
     void add404(routeHandler callback);
 
     void handle_request(const request& req, reply& rep);
+    // same as above but also dispatches POST routes; `done` is called once
+    // `rep` is ready to be sent
+    void handle_request(const request& req, reply& rep,
+                        std::function<void()> done);
 
     static void parseParams(const std::string& params, std::map<std::string, std::string>& retMap);
 
@@ -56,6 +69,14 @@ private:
     /// invalid.
     static bool url_decode(const std::string& in, std::string& out);
 
+    /// Split the request uri into the route name and its params. Returns
+    /// false if the uri is not valid.
+    static bool parse_uri(const request& req, std::string& command,
+                          std::string& params);
+
+    /// Fill status and headers of a successful reply.
+    static void set_content(reply& rep, const std::string& contentType);
+
     /// The io_service used to perform asynchronous operations.
     asio::io_service& io_service_;
 
@@ -72,6 +93,7 @@ private:
     asio::ip::tcp::socket socket_;
 
     std::map<std::string, routeHandler> mRoutes;
+    std::map<std::string, postRouteHandler> mPostRoutes;
 };
 
 } // namespace server
@@ -48,6 +48,7 @@
 #include "ledger/ExternalSystemAccountID.h"
 #include "medida/medida.h"
 #include "lib/util/format.h"
+#include <algorithm>
 #include <cassert>
 #include <future>
 
@@ -213,6 +214,12 @@ class Bucket::OutputIterator
     {
         if (!mKeepDeadEntries && e.type() == BucketEntryType::DEADENTRY)
         {
+            // the dead entry still overrides a buffered older entry of the
+            // same key, which mergeAll hands over before it
+            if (mBuf && !mCmp(*mBuf, e))
+            {
+                mBuf.reset();
+            }
             return;
         }
 
@@ -447,6 +454,68 @@ Bucket::merge(BucketManager& bucketManager,
     return out.getBucket(bucketManager);
 }
 
+std::shared_ptr<Bucket>
+Bucket::mergeAll(BucketManager& bucketManager,
+                 std::vector<std::shared_ptr<Bucket>> const& buckets,
+                 bool keepDeadEntries)
+{
+    std::vector<std::unique_ptr<Bucket::InputIterator>> iters;
+    iters.reserve(buckets.size());
+    for (auto const& b : buckets)
+    {
+        assert(b);
+        iters.emplace_back(make_unique<Bucket::InputIterator>(b));
+    }
+
+    // Heap of the iterators that still have entries, smallest key on top.
+    // Among iterators positioned on the same key the oldest bucket comes
+    // first: OutputIterator::put replaces a buffered entry with a keywise
+    // equal one, so the entry of the newest bucket is the one written.
+    BucketEntryIdCmp cmp;
+    auto lowerPriority = [&iters, &cmp](size_t a, size_t b) {
+        auto const& ea = **iters[a];
+        auto const& eb = **iters[b];
+        if (cmp(eb, ea))
+        {
+            return true;
+        }
+        if (cmp(ea, eb))
+        {
+            return false;
+        }
+        return a < b;
+    };
+    std::vector<size_t> heap;
+    for (size_t i = 0; i < iters.size(); i++)
+    {
+        if (*iters[i])
+        {
+            heap.push_back(i);
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), lowerPriority);
+
+    auto timer = bucketManager.getMergeTimer().TimeScope();
+    Bucket::OutputIterator out(bucketManager.getTmpDir(), keepDeadEntries);
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), lowerPriority);
+        auto& in = *iters[heap.back()];
+        out.put(*in);
+        ++in;
+        if (in)
+        {
+            std::push_heap(heap.begin(), heap.end(), lowerPriority);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+    }
+    return out.getBucket(bucketManager);
+}
+
 static void
 compareSizes(std::string const& objType, uint64_t inDatabase,
              uint64_t inBucketlist)
@@ -496,17 +565,13 @@ checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
         return;
     }
 
-    // Step 2: merge all buckets into a single super-bucket.
-    auto i = buckets.begin();
-    assert(i != buckets.end());
-    std::shared_ptr<Bucket> superBucket = *i;
-    while (++i != buckets.end())
+    // Step 2: merge all buckets into a single super-bucket; they were
+    // collected from newest to oldest.
+    std::shared_ptr<Bucket> superBucket;
     {
         auto mergeTimer =
             metrics.NewTimer({"bucket", "checkdb", "merge"}).TimeScope();
-        assert(superBucket);
-        assert(*i);
-        superBucket = Bucket::merge(bucketManager, *i, superBucket);
+        superBucket = Bucket::mergeAll(bucketManager, buckets);
         assert(superBucket);
     }
 
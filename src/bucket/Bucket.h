@@ -110,6 +110,16 @@ class Bucket : public std::enable_shared_from_this<Bucket>,
           std::vector<std::shared_ptr<Bucket>> const& shadows =
               std::vector<std::shared_ptr<Bucket>>(),
           bool keepDeadEntries = true);
+
+    // Merge any number of buckets together in a single pass, producing a
+    // fresh one. `buckets` is ordered from newest to oldest: an entry is
+    // overridden by keywise-equal entries in any bucket before it. Gives the
+    // same result as folding the buckets together with pairwise `merge`
+    // calls, without writing out (and hashing) every intermediate bucket.
+    static std::shared_ptr<Bucket>
+    mergeAll(BucketManager& bucketManager,
+             std::vector<std::shared_ptr<Bucket>> const& buckets,
+             bool keepDeadEntries = true);
 };
 
 void checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
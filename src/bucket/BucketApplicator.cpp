@@ -7,17 +7,31 @@
 #include "ledger/LedgerDeltaImpl.h"
 #include "ledger/EntryHelperLegacy.h"
 #include "util/Logging.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 
 namespace stellar
 {
 
+// buckets are read sequentially from start to end, so read them in chunks
+// much larger than the default file buffer
+static const size_t BUCKET_READ_BUFFER_SIZE = 1 << 20;
+
 BucketApplicator::BucketApplicator(Database& db,
-                                   std::shared_ptr<const Bucket> bucket)
+                                   std::shared_ptr<const Bucket> bucket,
+                                   medida::MetricsRegistry* metrics)
     : mDb(db), mBucket(bucket)
 {
     if (!bucket->getFilename().empty())
     {
-        mIn.open(bucket->getFilename());
+        mIn.open(bucket->getFilename(), BUCKET_READ_BUFFER_SIZE);
+    }
+    if (metrics)
+    {
+        mLiveEntryMeter =
+            &metrics->NewMeter({"bucket", "apply", "live-entry"}, "entry");
+        mDeadEntryMeter =
+            &metrics->NewMeter({"bucket", "apply", "dead-entry"}, "entry");
     }
 }
 
@@ -30,30 +44,42 @@ void
 BucketApplicator::advance()
 {
     soci::transaction sqlTx(mDb.getSession());
+    // one delta for the whole batch: keys are unique within a bucket, so
+    // entries never interact with each other, and live entries can be
+    // upserted together once the batch is read
+    LedgerHeader lh;
+    LedgerDeltaImpl delta(lh, mDb, false);
+    std::vector<LedgerEntry> live;
+    size_t dead = 0;
     BucketEntry entry;
     while (mIn && mIn.readOne(entry))
     {
-        LedgerHeader lh;
-        LedgerDeltaImpl delta(lh, mDb, false);
         if (entry.type() == BucketEntryType::LIVEENTRY)
         {
-            EntryFrame::pointer ep = EntryHelperProvider::fromXDREntry(entry.liveEntry());
-            EntryHelperProvider::storeAddOrChangeEntry(delta, mDb, ep->mEntry);
+            live.emplace_back(std::move(entry.liveEntry()));
         }
         else
         {
 			EntryHelperProvider::storeDeleteEntry(delta, mDb, entry.deadEntry());
+            ++dead;
         }
-        // No-op, just to avoid needless rollback.
-        static_cast<LedgerDelta&>(delta).commit();
         if ((++mSize & 0xff) == 0xff)
         {
             break;
         }
     }
+    EntryHelperProvider::storeUpsertEntries(delta, mDb, live);
+    // No-op, just to avoid needless rollback.
+    static_cast<LedgerDelta&>(delta).commit();
     sqlTx.commit();
     mDb.clearPreparedStatementCache();
 
+    if (mLiveEntryMeter)
+    {
+        mLiveEntryMeter->Mark(live.size());
+        mDeadEntryMeter->Mark(dead);
+    }
+
     if (!mIn || (mSize & 0xfff) == 0xfff)
     {
         CLOG(INFO, "Bucket") << "Bucket-apply: committed " << mSize
@@ -9,6 +9,12 @@
 #include "util/XDRStream.h"
 #include <memory>
 
+namespace medida
+{
+class Meter;
+class MetricsRegistry;
+}
+
 namespace stellar
 {
 
@@ -17,6 +23,9 @@ class Database;
 // Class that represents a single apply-bucket-to-database operation in
 // progress. Used during history catchup to split up the task of applying
 // bucket into scheduler-friendly, bite-sized pieces.
+//
+// When a metrics registry is given, applied entries are marked on the
+// "bucket.apply.live-entry" and "bucket.apply.dead-entry" meters.
 
 class BucketApplicator
 {
@@ -24,9 +33,12 @@ class BucketApplicator
     std::shared_ptr<const Bucket> mBucket;
     XDRInputFileStream mIn;
     size_t mSize{0};
+    medida::Meter* mLiveEntryMeter{nullptr};
+    medida::Meter* mDeadEntryMeter{nullptr};
 
   public:
-    BucketApplicator(Database& db, std::shared_ptr<const Bucket> bucket);
+    BucketApplicator(Database& db, std::shared_ptr<const Bucket> bucket,
+                     medida::MetricsRegistry* metrics = nullptr);
     operator bool() const;
     void advance();
 };
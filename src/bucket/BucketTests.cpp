@@ -18,6 +18,8 @@
 #include "main/test.h"
 #include "ledger/LedgerTestUtils.h"
 #include "ledger/AccountHelper.h"
+#include "ledger/AccountFrame.h"
+#include "ledger/EntryHelperLegacy.h"
 #include "util/Fs.h"
 #include "util/TmpDir.h"
 #include "xdrpp/autocheck.h"
@@ -498,6 +500,73 @@ TEST_CASE("merging bucket entries", "[bucket][entries]")
     }
 }
 
+TEST_CASE("merging many buckets at once", "[bucket][entries]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer app = Application::create(clock, cfg);
+    auto& bm = app->getBucketManager();
+
+    autocheck::generator<bool> flip;
+
+    // buckets from newest to oldest, later buckets reuse keys of the first
+    // one so that entries get overridden and annihilated
+    std::vector<LedgerEntry> base(200);
+    for (auto& e : base)
+    {
+        e = LedgerTestUtils::generateValidLedgerEntry(10);
+    }
+    std::vector<std::shared_ptr<Bucket>> buckets;
+    for (int i = 0; i < 5; i++)
+    {
+        std::vector<LedgerEntry> live;
+        std::vector<LedgerKey> dead;
+        for (auto const& e : base)
+        {
+            if (flip())
+            {
+                if (flip())
+                {
+                    live.push_back(e);
+                    live.back().lastModifiedLedgerSeq = i;
+                }
+                else
+                {
+                    dead.push_back(LedgerEntryKey(e));
+                }
+            }
+        }
+        for (int j = 0; j < 50; j++)
+        {
+            live.push_back(LedgerTestUtils::generateValidLedgerEntry(10));
+        }
+        buckets.push_back(Bucket::fresh(bm, live, dead));
+    }
+    buckets.push_back(std::make_shared<Bucket>());
+
+    for (bool keepDeadEntries : {true, false})
+    {
+        // pairwise, dead entries can only be dropped by the merge with the
+        // oldest bucket, they still annihilate older entries until then
+        auto pairwise = buckets.front();
+        for (size_t i = 1; i < buckets.size(); i++)
+        {
+            pairwise = Bucket::merge(
+                bm, buckets[i], pairwise, {},
+                keepDeadEntries || i + 1 < buckets.size());
+        }
+        auto merged = Bucket::mergeAll(bm, buckets, keepDeadEntries);
+
+        REQUIRE(merged->getHash() == pairwise->getHash());
+        REQUIRE(merged->countLiveAndDeadEntries() ==
+                pairwise->countLiveAndDeadEntries());
+        if (!keepDeadEntries)
+        {
+            REQUIRE(merged->countLiveAndDeadEntries().second == 0);
+        }
+    }
+}
+
 static void
 clearFutures(Application::pointer app, BucketList& bl)
 {
@@ -887,6 +956,108 @@ TEST_CASE("bucket apply", "[bucket]")
     REQUIRE(count == 4);
 }
 
+TEST_CASE("bucket apply on top of existing entries", "[bucket]")
+{
+    Config::TestDbMode mode = Config::TESTDB_ON_DISK_SQLITE;
+#ifdef USE_POSTGRES
+    if (!force_sqlite)
+        mode = Config::TESTDB_POSTGRESQL;
+#endif
+
+    VirtualClock clock;
+    Application::pointer app =
+        Application::create(clock, getTestConfig(0, mode));
+    app->start();
+
+    auto& db = app->getDatabase();
+    auto& sess = db.getSession();
+    std::vector<LedgerKey> noDead;
+
+    std::vector<LedgerEntry> existing, added;
+    std::vector<LedgerEntryType> types = {LedgerEntryType::ACCOUNT,
+                                          LedgerEntryType::BALANCE,
+                                          LedgerEntryType::OFFER_ENTRY};
+    while (existing.size() + added.size() < 600)
+    {
+        auto le = EntryHelperProvider::fromXDREntry(
+                      LedgerTestUtils::generateValidLedgerEntry(3))
+                      ->mEntry;
+        if (std::find(types.begin(), types.end(), le.data.type()) ==
+            types.end())
+        {
+            continue;
+        }
+        if (le.data.type() == LedgerEntryType::ACCOUNT)
+        {
+            // roles are references to account_roles
+            AccountFrame frame(le);
+            frame.setAccountRole(nullptr);
+            le = frame.mEntry;
+        }
+        (existing.size() <= added.size() ? existing : added).push_back(le);
+    }
+
+    auto counts = [&]() -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> res;
+        for (auto type : types)
+        {
+            res.push_back(EntryHelperProvider::countObjectsEntry(sess, type));
+        }
+        return res;
+    };
+    auto before = counts();
+
+    Bucket::fresh(app->getBucketManager(), existing, noDead)->apply(db);
+
+    // the second bucket changes every existing entry and adds new ones
+    std::vector<LedgerEntry> live(added);
+    for (auto le : existing)
+    {
+        le.lastModifiedLedgerSeq++;
+        if (le.data.type() == LedgerEntryType::ACCOUNT)
+        {
+            le.data.account().signers.clear();
+        }
+        live.push_back(le);
+    }
+    Bucket::fresh(app->getBucketManager(), live, noDead)->apply(db);
+
+    auto after = counts();
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        auto expected = before[i];
+        for (auto const& le : live)
+        {
+            if (le.data.type() == types[i])
+            {
+                expected++;
+            }
+        }
+        REQUIRE(after[i] == expected);
+    }
+
+    for (auto const& le : live)
+    {
+        auto loaded = EntryHelperProvider::storeLoadEntry(LedgerEntryKey(le), db);
+        REQUIRE(!!loaded);
+        REQUIRE(loaded->mEntry.lastModifiedLedgerSeq ==
+                le.lastModifiedLedgerSeq);
+        if (le.data.type() == LedgerEntryType::ACCOUNT)
+        {
+            REQUIRE(loaded->mEntry.data.account().signers.size() ==
+                    le.data.account().signers.size());
+        }
+    }
+
+    // entries are upserted, not probed one by one
+    auto& m = app->getMetrics();
+    for (auto name : {"account-exists", "balance-exists", "offer-exists"})
+    {
+        REQUIRE(m.NewTimer({"database", "select", name}).count() == 0);
+    }
+}
+
 #ifdef USE_POSTGRES
 TEST_CASE("bucket apply bench", "[bucketbench][hide]")
 {
@@ -10,6 +10,7 @@
 #include "util/basen.h"
 #include <autocheck/autocheck.hpp>
 #include <regex>
+#include <thread>
 #include "test/test_marshaler.h"
 
 using namespace stellar;
@@ -108,6 +109,10 @@ TEST_CASE("HMAC test vector", "[crypto]")
     auto v = hmacSha256(k, s);
     REQUIRE(h == v.mac);
     REQUIRE(hmacSha256Verify(v, k, s));
+
+    // same mac when the input is split in two parts
+    REQUIRE(hmacSha256(k, "The quick brown fox", " jumps over the lazy dog")
+                .mac == h);
 }
 
 TEST_CASE("HKDF test vector", "[crypto]")
@@ -204,6 +209,49 @@ TEST_CASE("sign and verify benchmarking", "[crypto-bench][bench][hide]")
     }
 }
 
+TEST_CASE("verify from multiple threads", "[crypto]")
+{
+    size_t const n = 64;
+    std::vector<SignVerifyTestcase> cases;
+    for (size_t i = 0; i < n; ++i)
+    {
+        cases.push_back(SignVerifyTestcase::create());
+        cases.back().sign();
+    }
+    // every other signature is broken, results must not leak through the
+    // cache between keys
+    for (size_t i = 0; i < n; i += 2)
+    {
+        cases[i].sig[0] ^= 1;
+    }
+
+    PubKeyUtils::clearVerifySigCache();
+    std::vector<std::vector<char>> results(4, std::vector<char>(n));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t)
+    {
+        threads.emplace_back([&cases, &results, t]() {
+            for (size_t i = 0; i < cases.size(); ++i)
+            {
+                auto const& c = cases[i];
+                results[t][i] = PubKeyUtils::verifySig(c.pub, c.sig, c.msg);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto const& result : results)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            REQUIRE(!!result[i] == (i % 2 == 1));
+        }
+    }
+}
+
 TEST_CASE("StrKey tests", "[crypto]")
 {
     std::regex b32("^([A-Z2-7])+$");
@@ -28,6 +28,11 @@ class SHA256
 // HMAC-SHA256 (keyed)
 HmacSha256Mac hmacSha256(HmacSha256Key const& key, ByteSlice const& bin);
 
+// HMAC-SHA256 of the concatenation of head and body, without copying them
+// into one buffer.
+HmacSha256Mac hmacSha256(HmacSha256Key const& key, ByteSlice const& head,
+                         ByteSlice const& body);
+
 // Use this rather than HMAC-output ==, to avoid timing leaks.
 bool hmacSha256Verify(HmacSha256Mac const& hmac, HmacSha256Key const& key,
                       ByteSlice const& bin);
@@ -12,6 +12,7 @@
 #include "util/make_unique.h"
 #include "util/HashOfHash.h"
 #include <mutex>
+#include <atomic>
 #include "main/Config.h"
 #include "util/lrucache.hpp"
 
@@ -24,13 +25,28 @@ namespace stellar
 // to the state of the process; caching its results centrally
 // makes all signature-verification in the program faster and
 // has no effect on correctness.
+//
+// Signatures are verified from worker threads too, so the cache is split
+// into independently locked shards, selected by the first byte of the cache
+// key, to keep threads from serializing on a single mutex.
+
+namespace
+{
+struct VerifySigCacheShard
+{
+    static const size_t SIZE = 0x1000;
+
+    std::mutex mMutex;
+    cache::lru_cache<Hash, bool> mCache{SIZE};
+};
+
+const size_t VERIFY_SIG_CACHE_SHARDS = 16;
+}
 
-static std::mutex gVerifySigCacheMutex;
-static cache::lru_cache<Hash, bool> gVerifySigCache(0xffff);
-static std::unique_ptr<SHA256> gHasher = SHA256::create();
-static uint64_t gVerifyCacheHit = 0;
-static uint64_t gVerifyCacheMiss = 0;
-static uint64_t gVerifyCacheIgnore = 0;
+static VerifySigCacheShard gVerifySigCache[VERIFY_SIG_CACHE_SHARDS];
+static std::atomic<uint64_t> gVerifyCacheHit(0);
+static std::atomic<uint64_t> gVerifyCacheMiss(0);
+static std::atomic<uint64_t> gVerifyCacheIgnore(0);
 
 static bool
 shouldCacheVerifySig(PublicKey const& key, Signature const& signature,
@@ -43,11 +59,17 @@ static Hash
 verifySigCacheKey(PublicKey const& key, Signature const& signature,
                   ByteSlice const& bin)
 {
-    gHasher->reset();
-    gHasher->add(key.ed25519());
-    gHasher->add(signature);
-    gHasher->add(bin);
-    return gHasher->finish();
+    auto hasher = SHA256::create();
+    hasher->add(key.ed25519());
+    hasher->add(signature);
+    hasher->add(bin);
+    return hasher->finish();
+}
+
+static VerifySigCacheShard&
+verifySigCacheShard(Hash const& cacheKey)
+{
+    return gVerifySigCache[cacheKey[0] % VERIFY_SIG_CACHE_SHARDS];
 }
 
 SecretKey::SecretKey() : mKeyType(CryptoKeyType::KEY_TYPE_ED25519)
@@ -202,21 +224,20 @@ SecretKey::fromStrKeySeed(std::string const& strKeySeed)
 void
 PubKeyUtils::clearVerifySigCache()
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    gVerifySigCache.clear();
+    for (auto& shard : gVerifySigCache)
+    {
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        shard.mCache.clear();
+    }
 }
 
 void
 PubKeyUtils::flushVerifySigCacheCounts(uint64_t& hits, uint64_t& misses,
                                        uint64_t& ignores)
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    hits = gVerifyCacheHit;
-    misses = gVerifyCacheMiss;
-    ignores = gVerifyCacheIgnore;
-    gVerifyCacheHit = 0;
-    gVerifyCacheMiss = 0;
-    gVerifyCacheIgnore = 0;
+    hits = gVerifyCacheHit.exchange(0);
+    misses = gVerifyCacheMiss.exchange(0);
+    ignores = gVerifyCacheIgnore.exchange(0);
 }
 
 bool
@@ -229,11 +250,12 @@ PubKeyUtils::verifySig(PublicKey const& key, Signature const& signature,
     if (shouldCache)
     {
         cacheKey = verifySigCacheKey(key, signature, bin);
-        std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-        if (gVerifySigCache.exists(cacheKey))
+        auto& shard = verifySigCacheShard(cacheKey);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        if (shard.mCache.exists(cacheKey))
         {
             ++gVerifyCacheHit;
-            return gVerifySigCache.get(cacheKey);
+            return shard.mCache.get(cacheKey);
         }
         ++gVerifyCacheMiss;
     }
@@ -247,8 +269,9 @@ PubKeyUtils::verifySig(PublicKey const& key, Signature const& signature,
                                      key.ed25519().data()) == 0);
     if (shouldCache)
     {
-        std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-        gVerifySigCache.put(cacheKey, ok);
+        auto& shard = verifySigCacheShard(cacheKey);
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        shard.mCache.put(cacheKey, ok);
     }
     return ok;
 }
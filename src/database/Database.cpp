@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "database/Database.h"
+#include "database/XDRBlob.h"
 #include "overlay/StellarXDR.h"
 #include "main/Application.h"
 #include "main/Config.h"
@@ -23,6 +24,8 @@
 #include "ledger/FeeHelper.h"
 #include "ledger/ReferenceFrame.h"
 #include "ledger/StatisticsFrame.h"
+#include "ledger/AssetPairCache.h"
+#include "ledger/LedgerOverlay.h"
 #include "ledger/AssetPairFrame.h"
 #include "ledger/TrustFrame.h"
 #include "ledger/OfferFrame.h"
@@ -51,6 +54,7 @@
 #include <ledger/AccountKYCHelper.h>
 #include <ledger/AccountRolePermissionHelperImpl.h>
 #include <ledger/KeyValueHelperLegacy.h>
+#include <ledger/BalanceHelperLegacy.h>
 #include <ledger/LimitsV2Helper.h>
 #include <ledger/StatisticsV2Helper.h>
 #include <ledger/PendingStatisticsHelper.h>
@@ -98,10 +102,12 @@ enum databaseSchemaVersion : unsigned long {
     REVIEWABLE_REQUEST_FIX_DEFAULT_VALUE = 19,
     REVIEWABLE_REQUEST_FIX_EXTERNAL_DETAILS = 20,
     ADD_CUSTOMER_DETAILS_TO_CONTRACT = 21,
-    ADD_ACCOUNT_ROLES_AND_POLICIES = 22
+    ADD_ACCOUNT_ROLES_AND_POLICIES = 22,
+    ADD_SCP_TXSETS = 23,
+    ADD_SECONDARY_INDEXES = 24
 };
 
-static unsigned long const SCHEMA_VERSION = databaseSchemaVersion::ADD_ACCOUNT_ROLES_AND_POLICIES;
+static unsigned long const SCHEMA_VERSION = databaseSchemaVersion::ADD_SECONDARY_INDEXES;
 
 static void
 setSerializable(soci::session& sess)
@@ -129,12 +135,25 @@ DatabaseImpl::DatabaseImpl(Application& app)
           app.getMetrics().NewMeter({"database", "query", "exec"}, "query"))
     , mStatementsSize(
           app.getMetrics().NewCounter({"database", "memory", "statements"}))
-    , mEntryCache(4096)
+    , mEntryCache(app.getConfig().ENTRY_CACHE_SIZE, &app.getMetrics())
+    , mAssetPairCache(make_unique<AssetPairCache>())
+    , mLedgerOverlay(make_unique<LedgerOverlay>())
+    , mBinaryXDRBlobs(false)
     , mExcludedQueryTime(0)
     , mExcludedTotalTime(0)
     , mLastIdleQueryTime(0)
     , mLastIdleTotalTime(app.getClock().now())
 {
+    for (auto const& capacity : app.getConfig().ENTRY_CACHE_SIZE_PER_TYPE)
+    {
+        mEntryCache.setCapacity(capacity.first, capacity.second);
+    }
+    // signatures of every system account are checked against master's
+    // signers, so master must not be pushed out by a burst of account loads
+    LedgerKey masterKey(LedgerEntryType::ACCOUNT);
+    masterKey.account().accountID = app.getMasterID();
+    mEntryCache.pin(masterKey);
+
     registerDrivers();
     CLOG(INFO, "Database") << "Connecting to: " << app.getConfig().DATABASE;
     mSession.open(app.getConfig().DATABASE);
@@ -151,6 +170,10 @@ DatabaseImpl::DatabaseImpl(Application& app)
     }
 }
 
+DatabaseImpl::~DatabaseImpl()
+{
+}
+
 void
 DatabaseImpl::applySchemaUpgrade(unsigned long vers)
 {
@@ -225,6 +248,15 @@ DatabaseImpl::applySchemaUpgrade(unsigned long vers)
             AccountHelper::Instance()->addAccountRole(*this);
             std::unique_ptr<AccountRolePermissionHelper>(new AccountRolePermissionHelperImpl(storageHelper))->dropAll();
             break;
+        case databaseSchemaVersion::ADD_SCP_TXSETS:
+            Herder::addSCPTxSets(*this);
+            break;
+        case databaseSchemaVersion::ADD_SECONDARY_INDEXES:
+            // statistics_v2 lookups are covered by its unique constraint
+            BalanceHelperLegacy::Instance()->addAccountIndex(*this);
+            LimitsV2Helper::Instance()->addIndexes(*this);
+            ExternalSystemAccountIDPoolEntryHelperLegacy::Instance()->addIndexes(*this);
+            break;
         default:
             throw std::runtime_error("Unknown DB schema version");
     }
@@ -250,6 +282,25 @@ DatabaseImpl::upgradeToCurrentSchema()
         putSchemaVersion(vers);
     }
     assert(vers == SCHEMA_VERSION);
+    applyXDRBlobStorage();
+}
+
+void
+DatabaseImpl::applyXDRBlobStorage()
+{
+    bool binary = mApp.getConfig().BINARY_XDR_BLOBS;
+    auto& ps = mApp.getPersistentState();
+    bool current =
+        ps.getState(PersistentState::kXDRBlobStorage) == "binary";
+    if (current != binary)
+    {
+        soci::transaction tx(mSession);
+        XDRBlob::migrate(*this, binary);
+        ps.setState(PersistentState::kXDRBlobStorage,
+                    binary ? "binary" : "base64");
+        tx.commit();
+    }
+    mBinaryXDRBlobs = binary;
 }
 
 void
@@ -290,6 +341,7 @@ DatabaseImpl::getInsertTimer(std::string const& entityName)
 {
     mEntityTypes.insert(entityName);
     mQueryMeter.Mark();
+    mLastPreparedQuery.clear();
     return mApp.getMetrics()
         .NewTimer({"database", "insert", entityName})
         .TimeScope();
@@ -300,6 +352,11 @@ DatabaseImpl::getSelectTimer(std::string const& entityName)
 {
     mEntityTypes.insert(entityName);
     mQueryMeter.Mark();
+    if (!mLastPreparedQuery.empty())
+    {
+        mStatementEntities[mLastPreparedQuery].insert(entityName);
+        mLastPreparedQuery.clear();
+    }
     return mApp.getMetrics()
         .NewTimer({"database", "select", entityName})
         .TimeScope();
@@ -310,6 +367,7 @@ DatabaseImpl::getDeleteTimer(std::string const& entityName)
 {
     mEntityTypes.insert(entityName);
     mQueryMeter.Mark();
+    mLastPreparedQuery.clear();
     return mApp.getMetrics()
         .NewTimer({"database", "delete", entityName})
         .TimeScope();
@@ -320,6 +378,7 @@ DatabaseImpl::getUpdateTimer(std::string const& entityName)
 {
     mEntityTypes.insert(entityName);
     mQueryMeter.Mark();
+    mLastPreparedQuery.clear();
     return mApp.getMetrics()
         .NewTimer({"database", "update", entityName})
         .TimeScope();
@@ -360,6 +419,21 @@ DatabaseImpl::clearPreparedStatementCache()
     }
     mStatements.clear();
     mStatementsSize.set_count(mStatements.size());
+    mLastPreparedQuery.clear();
+    mStatementEntities.clear();
+}
+
+Database::StatementEntities
+DatabaseImpl::getPreparedStatementEntities() const
+{
+    StatementEntities res;
+    for (auto const& st : mStatements)
+    {
+        auto it = mStatementEntities.find(st.first);
+        res[st.first] =
+            it == mStatementEntities.end() ? std::set<std::string>() : it->second;
+    }
+    return res;
 }
 
 void
@@ -420,12 +494,48 @@ DatabaseImpl::getPool()
     return *mPool;
 }
 
-cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>&
+Database::EntryCache&
 DatabaseImpl::getEntryCache()
 {
     return mEntryCache;
 }
 
+TxTimingIndex&
+DatabaseImpl::getTxTimingIndex()
+{
+    return mTxTimingIndex;
+}
+
+bool
+DatabaseImpl::hasBinaryXDRBlobs() const
+{
+    return mBinaryXDRBlobs;
+}
+
+FeeIndex&
+DatabaseImpl::getFeeIndex()
+{
+    return mFeeIndex;
+}
+
+KeyValueIndex&
+DatabaseImpl::getKeyValueIndex()
+{
+    return mKeyValueIndex;
+}
+
+AssetPairCache&
+DatabaseImpl::getAssetPairCache()
+{
+    return *mAssetPairCache;
+}
+
+LedgerOverlay&
+DatabaseImpl::getLedgerOverlay()
+{
+    return *mLedgerOverlay;
+}
+
 class SQLLogContext : NonCopyable
 {
     std::string mName;
@@ -479,6 +589,7 @@ DatabaseImpl::getPreparedStatement(std::string const& query)
     {
         p = i->second;
     }
+    mLastPreparedQuery = query;
     StatementContext sc(p);
     return sc;
 }
@@ -4,12 +4,16 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "database/EntryCache.h"
+#include "database/FeeIndex.h"
+#include "database/KeyValueIndex.h"
 #include "database/Marshaler.h"
+#include "database/TxTimingIndex.h"
 #include "medida/timer_context.h"
 #include "overlay/StellarXDR.h"
 #include "util/NonCopyable.h"
 #include "util/Timer.h"
-#include "util/lrucache.hpp"
+#include <map>
 #include <set>
 #include <soci.h>
 #include <string>
@@ -24,6 +28,8 @@ class Counter;
 namespace stellar
 {
 class Application;
+class AssetPairCache;
+class LedgerOverlay;
 class SQLLogContext;
 
 /**
@@ -121,6 +127,12 @@ class Database
     // database.
     virtual void clearPreparedStatementCache() = 0;
 
+    // Return the query of every cached prepared statement, together with the
+    // names of the select timers (see getSelectTimer) acquired right after
+    // the statement was borrowed. Used by IndexAdvisor.
+    typedef std::map<std::string, std::set<std::string>> StatementEntities;
+    virtual StatementEntities getPreparedStatementEntities() const = 0;
+
     // Return metric-gathering timers for various families of SQL operation.
     // These timers automatically count the time they are alive for,
     // so only acquire them immediately before executing an SQL statement.
@@ -171,10 +183,33 @@ class Database
     // Access the LedgerEntry cache. Note: clients are responsible for
     // invalidating entries in this cache as they perform statements
     // against the database. It's kept here only for ease of access.
-    typedef cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>
-        EntryCache;
+    typedef stellar::EntryCache EntryCache;
     virtual EntryCache& getEntryCache() = 0;
 
+    // Access the resident copy of the txtiming table used for replay
+    // protection, see TransactionFrame::timingExists.
+    virtual TxTimingIndex& getTxTimingIndex() = 0;
+
+    // Access the resident copy of the fee_state table, see
+    // FeeHelper::loadForAccount.
+    virtual FeeIndex& getFeeIndex() = 0;
+
+    // Access the resident copy of the key_value_entry table, see
+    // KeyValueHelperLegacy::loadKeyValue.
+    virtual KeyValueIndex& getKeyValueIndex() = 0;
+
+    // Access the asset pairs looked up while closing the current ledger, see
+    // AssetPairHelper::findAssetPairForAssets.
+    virtual AssetPairCache& getAssetPairCache() = 0;
+
+    // Access the pending account and balance changes of the ledger being
+    // closed, see LedgerOverlay.
+    virtual LedgerOverlay& getLedgerOverlay() = 0;
+
+    // Whether XDR blob columns hold BYTEA rather than base64 TEXT, see
+    // XDRBlob.
+    virtual bool hasBinaryXDRBlobs() const = 0;
+
     virtual ~Database()
     {
     }
@@ -189,9 +224,16 @@ class DatabaseImpl : public Database, public NonMovableOrCopyable
 
     std::map<std::string, std::shared_ptr<soci::statement>> mStatements;
     medida::Counter& mStatementsSize;
+    std::string mLastPreparedQuery;
+    StatementEntities mStatementEntities;
 
-    cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>
-        mEntryCache;
+    EntryCache mEntryCache;
+    TxTimingIndex mTxTimingIndex;
+    FeeIndex mFeeIndex;
+    KeyValueIndex mKeyValueIndex;
+    std::unique_ptr<AssetPairCache> mAssetPairCache;
+    std::unique_ptr<LedgerOverlay> mLedgerOverlay;
+    bool mBinaryXDRBlobs;
 
     // Helpers for maintaining the total query time and calculating
     // idle percentage.
@@ -204,11 +246,13 @@ class DatabaseImpl : public Database, public NonMovableOrCopyable
     static bool gDriversRegistered;
     static void registerDrivers();
     void applySchemaUpgrade(unsigned long vers);
+    void applyXDRBlobStorage();
 
   public:
     // Instantiate object and connect to app.getConfig().DATABASE;
     // if there is a connection error, this will throw.
     DatabaseImpl(Application& app);
+    ~DatabaseImpl();
 
   private:
     virtual medida::Meter& getQueryMeter();
@@ -227,6 +271,8 @@ class DatabaseImpl : public Database, public NonMovableOrCopyable
 
     virtual void clearPreparedStatementCache();
 
+    virtual StatementEntities getPreparedStatementEntities() const;
+
     virtual medida::TimerContext getInsertTimer(std::string const& entityName);
     virtual medida::TimerContext getSelectTimer(std::string const& entityName);
     virtual medida::TimerContext getDeleteTimer(std::string const& entityName);
@@ -253,6 +299,18 @@ class DatabaseImpl : public Database, public NonMovableOrCopyable
     virtual soci::connection_pool& getPool();
 
     virtual EntryCache& getEntryCache();
+
+    virtual TxTimingIndex& getTxTimingIndex();
+
+    virtual FeeIndex& getFeeIndex();
+
+    virtual KeyValueIndex& getKeyValueIndex();
+
+    virtual AssetPairCache& getAssetPairCache();
+
+    virtual LedgerOverlay& getLedgerOverlay();
+
+    virtual bool hasBinaryXDRBlobs() const;
 };
 
 class DBTimeExcluder : NonCopyable
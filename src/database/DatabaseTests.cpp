@@ -4,10 +4,15 @@
 
 #include "util/asio.h"
 #include "database/Database.h"
+#include "database/IndexAdvisor.h"
+#include "database/XDRBlob.h"
+#include <lib/gtest/googlemock/include/gmock/gmock.h>
+#include "transactions/test/mocks/MockDatabase.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "main/test.h"
 #include "crypto/Hex.h"
+#include "crypto/SecretKey.h"
 #include <random>
 #include "test/test_marshaler.h"
 
@@ -336,3 +341,235 @@ TEST_CASE("schema test", "[db]")
     auto av = db.getAppSchemaVersion();
     REQUIRE(dbv == av);
 }
+
+TEST_CASE("entry cache", "[db][entrycache]")
+{
+    auto accountKey = []() {
+        LedgerKey res(LedgerEntryType::ACCOUNT);
+        res.account().accountID = PubKeyUtils::random();
+        return res;
+    };
+    auto balanceKey = []() {
+        LedgerKey res(LedgerEntryType::BALANCE);
+        res.balance().balanceID = PubKeyUtils::random();
+        return res;
+    };
+    auto entry = std::make_shared<LedgerEntry const>();
+
+    EntryCache cache(2);
+    cache.setCapacity(LedgerEntryType::BALANCE, 1);
+
+    auto a1 = accountKey();
+    auto a2 = accountKey();
+    auto b1 = balanceKey();
+    auto b2 = balanceKey();
+
+    cache.put(a1, entry);
+    cache.put(a2, entry);
+    cache.put(b1, entry);
+    REQUIRE(cache.size() == 3);
+
+    SECTION("types are evicted independently")
+    {
+        cache.put(b2, entry);
+        REQUIRE(cache.exists(a1));
+        REQUIRE(cache.exists(a2));
+        REQUIRE(!cache.exists(b1));
+        REQUIRE(cache.exists(b2));
+        REQUIRE(cache.get(b2) == entry);
+    }
+    SECTION("erase")
+    {
+        cache.erase_if_exists(a1);
+        cache.erase_if_exists(b2);
+        REQUIRE(!cache.exists(a1));
+        REQUIRE(cache.exists(b1));
+        REQUIRE_THROWS_AS(cache.get(a1), std::range_error);
+    }
+    SECTION("clear single type")
+    {
+        cache.clear(LedgerEntryType::ACCOUNT);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.exists(b1));
+    }
+    SECTION("pinned entries are not evicted")
+    {
+        auto pinned = std::make_shared<LedgerEntry const>();
+        cache.pin(a1);
+        REQUIRE(cache.get(a1) == entry);
+        cache.put(a1, pinned);
+        for (int i = 0; i < 10; i++)
+        {
+            cache.put(accountKey(), entry);
+        }
+        REQUIRE(cache.exists(a1));
+        REQUIRE(cache.get(a1) == pinned);
+        REQUIRE(cache.size() == 4);
+
+        cache.erase_if_exists(a1);
+        REQUIRE(!cache.exists(a1));
+        cache.put(a1, entry);
+        REQUIRE(cache.exists(a1));
+    }
+}
+
+TEST_CASE("fee index", "[db][feeindex]")
+{
+    auto account = PubKeyUtils::random();
+    auto otherAccount = PubKeyUtils::random();
+    AssetCode const asset = "XAAU";
+
+    auto fee = [&asset](int64_t fixed, int64_t lowerBound, int64_t upperBound,
+                        AccountID const* accountID,
+                        AccountType const* accountType) {
+        LedgerEntry res;
+        res.data.type(LedgerEntryType::FEE);
+        auto& entry = res.data.feeState();
+        entry.feeType = FeeType::PAYMENT_FEE;
+        entry.asset = asset;
+        entry.fixedFee = fixed;
+        entry.lowerBound = lowerBound;
+        entry.upperBound = upperBound;
+        if (accountID)
+        {
+            entry.accountID.activate() = *accountID;
+        }
+        if (accountType)
+        {
+            entry.accountType.activate() = *accountType;
+        }
+        return res;
+    };
+
+    FeeIndex index;
+    auto fixedFee = [&](AccountID const& accountID, AccountType accountType,
+                        int64_t amount) -> int64_t {
+        auto res = index.find(FeeType::PAYMENT_FEE, asset, 0, accountID,
+                              accountType, amount);
+        return res ? res->data.feeState().fixedFee : -1;
+    };
+
+    auto const general = AccountType::GENERAL;
+    index.add(fee(1, 0, 99, nullptr, nullptr));
+    index.add(fee(2, 100, 1000, nullptr, nullptr));
+    index.add(fee(3, 0, 10, nullptr, &general));
+    index.add(fee(4, 5, 5, &account, nullptr));
+    REQUIRE(index.size() == 4);
+
+    SECTION("most specific fee covering the amount wins")
+    {
+        REQUIRE(fixedFee(account, general, 5) == 4);
+        REQUIRE(fixedFee(account, general, 6) == 3);
+        REQUIRE(fixedFee(otherAccount, general, 5) == 3);
+        REQUIRE(fixedFee(account, general, 11) == 1);
+        REQUIRE(fixedFee(otherAccount, AccountType::EXCHANGE, 5) == 1);
+        REQUIRE(fixedFee(otherAccount, general, 100) == 2);
+        REQUIRE(fixedFee(otherAccount, general, 1001) == -1);
+    }
+    SECTION("other fee types and assets do not match")
+    {
+        REQUIRE(!index.find(FeeType::OFFER_FEE, asset, 0, account, general,
+                            5));
+        REQUIRE(!index.find(FeeType::PAYMENT_FEE, "XBTC", 0, account, general,
+                            5));
+        REQUIRE(!index.find(FeeType::PAYMENT_FEE, asset, 1, account, general,
+                            5));
+    }
+    SECTION("clear")
+    {
+        index.setLoaded();
+        index.clear();
+        REQUIRE(!index.isLoaded());
+        REQUIRE(index.size() == 0);
+        REQUIRE(fixedFee(account, general, 5) == -1);
+    }
+}
+
+TEST_CASE("index advisor", "[db][indexadvisor]")
+{
+    SECTION("placeholders")
+    {
+        REQUIRE(IndexAdvisor::bindPlaceholders(
+                    "SELECT a FROM t WHERE b = :b AND c = ':c' AND "
+                    "(:d::text IS NULL)") ==
+                "SELECT a FROM t WHERE b = '0' AND c = ':c' AND "
+                "('0'::text IS NULL)");
+    }
+
+    SECTION("full scans are flagged")
+    {
+        Config const& cfg = getTestConfig(0, Config::TESTDB_IN_MEMORY_SQLITE);
+        VirtualClock clock;
+        Application::pointer app = Application::create(clock, cfg);
+        auto& db = app->getDatabase();
+        auto& session = db.getSession();
+
+        session << "DROP TABLE IF EXISTS advised";
+        session << "CREATE TABLE advised (x INTEGER, y INTEGER)";
+        session << "CREATE INDEX advisedbyx ON advised (x)";
+
+        std::string const byX = "SELECT y FROM advised WHERE x = :x";
+        std::string const byY = "SELECT x FROM advised WHERE y = :y";
+        {
+            auto prep = db.getPreparedStatement(byX);
+            auto timer = db.getSelectTimer("advised-by-x");
+        }
+        {
+            auto prep = db.getPreparedStatement(byY);
+        }
+
+        auto report = IndexAdvisor(db, app->getMetrics()).report();
+        REQUIRE(report["full_scans"].asUInt() >= 1);
+
+        bool seenX = false, seenY = false;
+        for (auto const& st : report["statements"])
+        {
+            if (st["sql"].asString() == byX)
+            {
+                seenX = true;
+                REQUIRE(!st["full_scan"].asBool());
+                REQUIRE(st["select_timers"].isMember("advised-by-x"));
+            }
+            else if (st["sql"].asString() == byY)
+            {
+                seenY = true;
+                REQUIRE(st["full_scan"].asBool());
+                REQUIRE(!st.isMember("select_timers"));
+            }
+        }
+        REQUIRE(seenX);
+        REQUIRE(seenY);
+        db.clearPreparedStatementCache();
+        session << "DROP TABLE advised";
+    }
+}
+
+TEST_CASE("xdr blob codec", "[db][xdrblob]")
+{
+    using ::testing::Return;
+    MockDatabase db;
+
+    xdr::opaque_vec<> blob;
+    for (int i = 0; i < 300; i++)
+    {
+        blob.push_back(static_cast<uint8_t>(i));
+    }
+    auto const bytes = xdr::xdr_to_opaque(blob);
+
+    for (bool binary : {false, true})
+    {
+        ON_CALL(db, hasBinaryXDRBlobs()).WillByDefault(Return(binary));
+        auto encoded = XDRBlob::encode(db, bytes);
+        REQUIRE((encoded.compare(0, 2, "\\x") == 0) == binary);
+
+        std::vector<uint8_t> buffer;
+        xdr::opaque_vec<> decoded;
+        XDRBlob::decodeObject(db, encoded, buffer, decoded);
+        REQUIRE(decoded == blob);
+    }
+
+    ON_CALL(db, hasBinaryXDRBlobs()).WillByDefault(Return(true));
+    std::vector<uint8_t> buffer;
+    REQUIRE_THROWS(XDRBlob::decode(db, "\\x0g", buffer));
+    REQUIRE_THROWS(XDRBlob::decode(db, "0a0b", buffer));
+}
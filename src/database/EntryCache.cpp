@@ -0,0 +1,171 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/EntryCache.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "xdrpp/marshal.h"
+
+namespace stellar
+{
+
+EntryCache::EntryCache(size_t defaultCapacity,
+                       medida::MetricsRegistry* metrics)
+    : mDefaultCapacity(defaultCapacity), mMetrics(metrics)
+{
+}
+
+std::string
+EntryCache::toBinaryKey(LedgerKey const& key)
+{
+    auto const bin = xdr::xdr_to_opaque(key);
+    return std::string(bin.begin(), bin.end());
+}
+
+EntryCache::Shard&
+EntryCache::getShard(LedgerEntryType type)
+{
+    auto it = mShards.find(type);
+    if (it != mShards.end())
+    {
+        return *it->second;
+    }
+
+    auto shard = std::unique_ptr<Shard>(new Shard(mDefaultCapacity));
+    if (mMetrics)
+    {
+        std::string typeName =
+            xdr::xdr_traits<LedgerEntryType>::enum_name(type);
+        shard->mHit = &mMetrics->NewMeter(
+            {"database", "entry-cache", typeName + "-hit"}, "entry");
+        shard->mPinnedHit = &mMetrics->NewMeter(
+            {"database", "entry-cache", typeName + "-pinned-hit"}, "entry");
+        shard->mMiss = &mMetrics->NewMeter(
+            {"database", "entry-cache", typeName + "-miss"}, "entry");
+        shard->mEvict = &mMetrics->NewMeter(
+            {"database", "entry-cache", typeName + "-evict"}, "entry");
+    }
+    auto& result = *shard;
+    mShards.emplace(type, std::move(shard));
+    return result;
+}
+
+void
+EntryCache::setCapacity(LedgerEntryType type, size_t capacity)
+{
+    auto& shard = getShard(type);
+    shard.mCapacity = capacity;
+    // lru_cache can not be resized in place, so start over with a new bound
+    shard.mEntries = Lru(capacity);
+}
+
+void
+EntryCache::pin(LedgerKey const& key)
+{
+    auto& shard = getShard(key.type());
+    auto bin = toBinaryKey(key);
+    if (shard.mEntries.exists(bin))
+    {
+        shard.mPinned[bin] = shard.mEntries.get(bin);
+        shard.mEntries.erase_if_exists(bin);
+    }
+    shard.mPinnedKeys.insert(std::move(bin));
+}
+
+void
+EntryCache::put(LedgerKey const& key, EntryPtr const& value)
+{
+    auto& shard = getShard(key.type());
+    auto bin = toBinaryKey(key);
+    if (shard.mPinnedKeys.count(bin) != 0)
+    {
+        shard.mPinned[bin] = value;
+        return;
+    }
+    bool const isNew = !shard.mEntries.exists(bin);
+    auto const sizeBefore = shard.mEntries.size();
+    shard.mEntries.put(bin, value);
+    if (isNew && shard.mEntries.size() == sizeBefore && shard.mEvict)
+    {
+        shard.mEvict->Mark();
+    }
+}
+
+EntryCache::EntryPtr const&
+EntryCache::get(LedgerKey const& key)
+{
+    auto& shard = getShard(key.type());
+    auto bin = toBinaryKey(key);
+    auto pinned = shard.mPinned.find(bin);
+    if (pinned != shard.mPinned.end())
+    {
+        return pinned->second;
+    }
+    return shard.mEntries.get(bin);
+}
+
+void
+EntryCache::erase_if_exists(LedgerKey const& key)
+{
+    auto it = mShards.find(key.type());
+    if (it == mShards.end())
+    {
+        return;
+    }
+    auto bin = toBinaryKey(key);
+    it->second->mPinned.erase(bin);
+    it->second->mEntries.erase_if_exists(bin);
+}
+
+bool
+EntryCache::exists(LedgerKey const& key)
+{
+    auto& shard = getShard(key.type());
+    auto bin = toBinaryKey(key);
+    bool const pinned = shard.mPinned.find(bin) != shard.mPinned.end();
+    bool const res = pinned || shard.mEntries.exists(bin);
+    auto meter = res ? shard.mHit : shard.mMiss;
+    if (meter)
+    {
+        meter->Mark();
+    }
+    if (pinned && shard.mPinnedHit)
+    {
+        shard.mPinnedHit->Mark();
+    }
+    return res;
+}
+
+void
+EntryCache::clear(LedgerEntryType type)
+{
+    auto it = mShards.find(type);
+    if (it != mShards.end())
+    {
+        it->second->mEntries.clear();
+        it->second->mPinned.clear();
+    }
+}
+
+void
+EntryCache::clear()
+{
+    for (auto& shard : mShards)
+    {
+        shard.second->mEntries.clear();
+        shard.second->mPinned.clear();
+    }
+}
+
+size_t
+EntryCache::size() const
+{
+    size_t res = 0;
+    for (auto const& shard : mShards)
+    {
+        res += shard.second->mEntries.size() + shard.second->mPinned.size();
+    }
+    return res;
+}
+}
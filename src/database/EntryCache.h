@@ -0,0 +1,100 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include "util/lrucache.hpp"
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace medida
+{
+class Meter;
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+
+/**
+ * Cache of LedgerEntries loaded from the database, keyed by LedgerKey.
+ *
+ * The cache is split into one LRU shard per LedgerEntryType, so that a burst
+ * of, say, balance loads can not evict every account in the cache. Each shard
+ * has its own capacity (see Config::ENTRY_CACHE_SIZE and
+ * Config::ENTRY_CACHE_SIZE_PER_TYPE) and, when a metrics registry is given,
+ * reports hits, misses and evictions as the meters
+ * "database.entry-cache.<type>-hit", "<type>-miss" and "<type>-evict".
+ *
+ * Inside a shard entries are indexed by the raw XDR encoding of the key, which
+ * is much cheaper to build and to hash than the hex string used previously.
+ *
+ * Keys passed to pin() are kept outside of the LRU: once loaded, their value
+ * stays cached until it is erased (i.e. until a LedgerDelta changes or rolls
+ * back the entry), however many other entries of the same type are loaded.
+ * Hits on pinned keys are additionally reported as
+ * "database.entry-cache.<type>-pinned-hit".
+ */
+class EntryCache : NonMovableOrCopyable
+{
+  public:
+    typedef std::shared_ptr<LedgerEntry const> EntryPtr;
+
+    explicit EntryCache(size_t defaultCapacity,
+                        medida::MetricsRegistry* metrics = nullptr);
+
+    // Sets capacity of the shard holding entries of `type`; entries already
+    // cached for that type are dropped.
+    void setCapacity(LedgerEntryType type, size_t capacity);
+
+    // Marks `key` as never to be evicted; erasing the key drops its value but
+    // keeps it pinned.
+    void pin(LedgerKey const& key);
+
+    void put(LedgerKey const& key, EntryPtr const& value);
+
+    // Throws std::range_error if key is not in the cache.
+    EntryPtr const& get(LedgerKey const& key);
+
+    void erase_if_exists(LedgerKey const& key);
+
+    bool exists(LedgerKey const& key);
+
+    // Drops every entry of `type`.
+    void clear(LedgerEntryType type);
+    void clear();
+
+    size_t size() const;
+
+  private:
+    typedef cache::lru_cache<std::string, EntryPtr> Lru;
+
+    struct Shard
+    {
+        Shard(size_t capacity) : mCapacity(capacity), mEntries(capacity)
+        {
+        }
+
+        size_t mCapacity;
+        Lru mEntries;
+        std::set<std::string> mPinnedKeys;
+        std::map<std::string, EntryPtr> mPinned;
+        medida::Meter* mHit = nullptr;
+        medida::Meter* mPinnedHit = nullptr;
+        medida::Meter* mMiss = nullptr;
+        medida::Meter* mEvict = nullptr;
+    };
+
+    size_t mDefaultCapacity;
+    medida::MetricsRegistry* mMetrics;
+    std::map<LedgerEntryType, std::unique_ptr<Shard>> mShards;
+
+    Shard& getShard(LedgerEntryType type);
+    static std::string toBinaryKey(LedgerKey const& key);
+};
+}
@@ -0,0 +1,112 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/FeeIndex.h"
+
+namespace stellar
+{
+
+bool
+FeeIndex::isLoaded() const
+{
+    return mLoaded;
+}
+
+void
+FeeIndex::setLoaded()
+{
+    mLoaded = true;
+}
+
+void
+FeeIndex::add(LedgerEntry const& fee)
+{
+    auto const& entry = fee.data.feeState();
+    // the hash of a fee set for both an account and an account type is never
+    // looked up by loadForAccount
+    if (entry.accountID && entry.accountType)
+    {
+        return;
+    }
+
+    auto& schedule = mSchedules[ScheduleKey(entry.feeType, entry.asset,
+                                            entry.subtype)];
+    Tier* tier = &schedule.mGlobal;
+    if (entry.accountID)
+    {
+        tier = &schedule.mByAccount[*entry.accountID];
+    }
+    else if (entry.accountType)
+    {
+        tier = &schedule.mByAccountType[*entry.accountType];
+    }
+
+    if (tier->emplace(entry.lowerBound, fee).second)
+    {
+        mSize++;
+    }
+}
+
+LedgerEntry const*
+FeeIndex::find(Tier const& tier, int64_t amount)
+{
+    auto it = tier.upper_bound(amount);
+    if (it == tier.begin())
+    {
+        return nullptr;
+    }
+    --it;
+    if (amount > it->second.data.feeState().upperBound)
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+LedgerEntry const*
+FeeIndex::find(FeeType feeType, AssetCode const& asset, int64_t subtype,
+               AccountID const& accountID, AccountType accountType,
+               int64_t amount) const
+{
+    auto schedule = mSchedules.find(ScheduleKey(feeType, asset, subtype));
+    if (schedule == mSchedules.end())
+    {
+        return nullptr;
+    }
+
+    auto byAccount = schedule->second.mByAccount.find(accountID);
+    if (byAccount != schedule->second.mByAccount.end())
+    {
+        if (auto res = find(byAccount->second, amount))
+        {
+            return res;
+        }
+    }
+
+    auto byType = schedule->second.mByAccountType.find(accountType);
+    if (byType != schedule->second.mByAccountType.end())
+    {
+        if (auto res = find(byType->second, amount))
+        {
+            return res;
+        }
+    }
+
+    return find(schedule->second.mGlobal, amount);
+}
+
+void
+FeeIndex::clear()
+{
+    mLoaded = false;
+    mSize = 0;
+    mSchedules.clear();
+}
+
+size_t
+FeeIndex::size() const
+{
+    return mSize;
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SecretKey.h"
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace stellar
+{
+
+/**
+ * Resident copy of the fee_state table, shaped for FeeHelper::loadForAccount.
+ *
+ * Fees are grouped by (fee type, asset, subtype); each group holds the
+ * account specific, account type and global tiers, and every tier keeps its
+ * fees ordered by lower bound. As bounds of fees with the same hash never
+ * overlap (see FeeHelper::isBoundariesOverlap), finding the fee that covers
+ * an amount is a single ordered lookup per tier.
+ *
+ * The index starts out unloaded; FeeHelper fills it from the table the first
+ * time it is needed and drops it whenever fee_state is written to or a
+ * LedgerDelta holding fee changes is rolled back.
+ */
+class FeeIndex : NonMovableOrCopyable
+{
+  public:
+    bool isLoaded() const;
+    void setLoaded();
+
+    void add(LedgerEntry const& fee);
+
+    // Returns the fee covering `amount`, looking at fees set for `accountID`
+    // first, then at the ones set for `accountType` and at the global ones
+    // last; nullptr if there is none.
+    LedgerEntry const* find(FeeType feeType, AssetCode const& asset,
+                            int64_t subtype, AccountID const& accountID,
+                            AccountType accountType, int64_t amount) const;
+
+    // Drops every fee and marks the index as unloaded.
+    void clear();
+
+    size_t size() const;
+
+  private:
+    // fees of one tier by lower bound
+    typedef std::map<int64_t, LedgerEntry> Tier;
+
+    struct Schedule
+    {
+        std::unordered_map<AccountID, Tier> mByAccount;
+        std::map<AccountType, Tier> mByAccountType;
+        Tier mGlobal;
+    };
+
+    typedef std::tuple<FeeType, std::string, int64_t> ScheduleKey;
+
+    bool mLoaded = false;
+    size_t mSize = 0;
+    std::map<ScheduleKey, Schedule> mSchedules;
+
+    static LedgerEntry const* find(Tier const& tier, int64_t amount);
+};
+}
@@ -0,0 +1,180 @@
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/IndexAdvisor.h"
+#include "database/Database.h"
+#include "util/Logging.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+
+#include <cctype>
+
+namespace stellar
+{
+
+using namespace soci;
+
+namespace
+{
+bool
+isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool
+startsWithKeyword(std::string const& query, std::string const& keyword)
+{
+    size_t i = 0;
+    while (i < query.size() && std::isspace(static_cast<unsigned char>(query[i])))
+    {
+        i++;
+    }
+    if (query.size() - i < keyword.size())
+    {
+        return false;
+    }
+    for (size_t k = 0; k < keyword.size(); k++)
+    {
+        if (std::toupper(static_cast<unsigned char>(query[i + k])) != keyword[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// only statements that read or modify existing rows have interesting plans
+bool
+isExplainable(std::string const& query)
+{
+    return startsWithKeyword(query, "SELECT") ||
+           startsWithKeyword(query, "UPDATE") ||
+           startsWithKeyword(query, "DELETE");
+}
+}
+
+IndexAdvisor::IndexAdvisor(Database& db, medida::MetricsRegistry& metrics)
+    : mDatabase(db), mMetrics(metrics)
+{
+}
+
+std::string
+IndexAdvisor::bindPlaceholders(std::string const& query)
+{
+    std::string res;
+    res.reserve(query.size());
+    bool inLiteral = false;
+    for (size_t i = 0; i < query.size(); i++)
+    {
+        char c = query[i];
+        if (c == '\'')
+        {
+            inLiteral = !inLiteral;
+        }
+        else if (!inLiteral && c == ':')
+        {
+            if (i + 1 < query.size() && query[i + 1] == ':')
+            {
+                // Postgres cast, keep both colons
+                res += "::";
+                i++;
+                continue;
+            }
+            if (i + 1 < query.size() && isIdentifierChar(query[i + 1]))
+            {
+                while (i + 1 < query.size() && isIdentifierChar(query[i + 1]))
+                {
+                    i++;
+                }
+                res += "'0'";
+                continue;
+            }
+        }
+        res += c;
+    }
+    return res;
+}
+
+bool
+IndexAdvisor::isFullScan(std::string const& planLine, bool sqlite)
+{
+    if (sqlite)
+    {
+        // "SCAN TABLE t" (or "SCAN t" in newer versions) without an index
+        return planLine.compare(0, 4, "SCAN") == 0 &&
+               planLine.find("INDEX") == std::string::npos;
+    }
+    return planLine.find("Seq Scan") != std::string::npos;
+}
+
+Json::Value
+IndexAdvisor::report()
+{
+    bool sqlite = mDatabase.isSqlite();
+    auto& sess = mDatabase.getSession();
+
+    Json::Value fullScans(Json::arrayValue);
+    Json::Value others(Json::arrayValue);
+    for (auto const& st : mDatabase.getPreparedStatementEntities())
+    {
+        if (!isExplainable(st.first))
+        {
+            continue;
+        }
+
+        Json::Value entry;
+        entry["sql"] = st.first;
+        bool fullScan = false;
+        try
+        {
+            std::string explain =
+                (sqlite ? "EXPLAIN QUERY PLAN " : "EXPLAIN ") +
+                bindPlaceholders(st.first);
+            rowset<row> rs = sess.prepare << explain;
+            for (auto const& r : rs)
+            {
+                // the detail is the last column of sqlite's plan, postgres
+                // returns a single text column
+                auto line = r.get<std::string>(r.size() - 1);
+                fullScan = fullScan || isFullScan(line, sqlite);
+                entry["plan"].append(line);
+            }
+        }
+        catch (soci_error& e)
+        {
+            entry["error"] = e.what();
+        }
+        entry["full_scan"] = fullScan;
+
+        for (auto const& name : st.second)
+        {
+            auto& timer = mMetrics.NewTimer({"database", "select", name});
+            auto& t = entry["select_timers"][name];
+            t["count"] = Json::UInt64(timer.count());
+            t["mean_ms"] = timer.mean();
+            t["max_ms"] = timer.max();
+        }
+
+        if (fullScan)
+        {
+            CLOG(WARNING, "Database") << "Full table scan in: " << st.first;
+            fullScans.append(entry);
+        }
+        else
+        {
+            others.append(entry);
+        }
+    }
+
+    Json::Value res;
+    res["full_scans"] = fullScans.size();
+    res["statements"] = fullScans;
+    for (auto const& e : others)
+    {
+        res["statements"].append(e);
+    }
+    return res;
+}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/json/json.h"
+#include <string>
+
+namespace medida
+{
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+class Database;
+
+/**
+ * Diagnostic that asks the database for the plan of every cached prepared
+ * statement (i.e. of every query issued through Database::getPreparedStatement
+ * since startup) and flags the plans that scan a whole table.
+ *
+ * Placeholders are replaced with the literal '0', which both SQLite and
+ * Postgres coerce to the type of the column it is compared with; the plans
+ * are therefore generic and may differ from the ones picked for real values.
+ *
+ * Each statement is reported with the select timers acquired right after it
+ * was borrowed (see Database::getPreparedStatementEntities).
+ */
+class IndexAdvisor
+{
+    Database& mDatabase;
+    medida::MetricsRegistry& mMetrics;
+
+  public:
+    IndexAdvisor(Database& db, medida::MetricsRegistry& metrics);
+
+    // Returns {"statements": [...], "full_scans": N}; statements with a full
+    // table scan come first.
+    Json::Value report();
+
+    // Replaces every :name placeholder outside of string literals and of
+    // Postgres casts (::type) with '0'.
+    static std::string bindPlaceholders(std::string const& query);
+
+    // Whether a single line of a query plan describes a full table scan.
+    static bool isFullScan(std::string const& planLine, bool sqlite);
+};
+}
@@ -0,0 +1,47 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/KeyValueIndex.h"
+
+namespace stellar
+{
+
+bool
+KeyValueIndex::isLoaded() const
+{
+    return mLoaded;
+}
+
+void
+KeyValueIndex::setLoaded()
+{
+    mLoaded = true;
+}
+
+void
+KeyValueIndex::add(LedgerEntry const& keyValue)
+{
+    mEntries[keyValue.data.keyValue().key] = keyValue;
+}
+
+LedgerEntry const*
+KeyValueIndex::find(std::string const& key) const
+{
+    auto it = mEntries.find(key);
+    return it == mEntries.end() ? nullptr : &it->second;
+}
+
+void
+KeyValueIndex::clear()
+{
+    mLoaded = false;
+    mEntries.clear();
+}
+
+size_t
+KeyValueIndex::size() const
+{
+    return mEntries.size();
+}
+}
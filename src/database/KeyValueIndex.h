@@ -0,0 +1,46 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <map>
+#include <string>
+
+namespace stellar
+{
+
+/**
+ * Resident copy of the key_value_entry table, see
+ * KeyValueHelperLegacy::loadKeyValue.
+ *
+ * Configuration keys are read by most transactions and operations but only
+ * change through ManageKeyValue, so the whole table is kept in memory.
+ *
+ * The index starts out unloaded; KeyValueHelperLegacy fills it from the table
+ * the first time a key is looked up and drops it whenever key_value_entry is
+ * written to or a LedgerDelta holding key value changes is rolled back.
+ */
+class KeyValueIndex : NonMovableOrCopyable
+{
+  public:
+    bool isLoaded() const;
+    void setLoaded();
+
+    void add(LedgerEntry const& keyValue);
+
+    // nullptr if there is no entry for `key`
+    LedgerEntry const* find(std::string const& key) const;
+
+    // Drops every entry and marks the index as unloaded.
+    void clear();
+
+    size_t size() const;
+
+  private:
+    bool mLoaded = false;
+    std::map<std::string, LedgerEntry> mEntries;
+};
+}
@@ -0,0 +1,68 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/TxTimingIndex.h"
+
+namespace stellar
+{
+
+bool
+TxTimingIndex::isLoaded() const
+{
+    return mLoaded;
+}
+
+void
+TxTimingIndex::setLoaded()
+{
+    mLoaded = true;
+}
+
+void
+TxTimingIndex::add(Hash const& txID, uint64 validBefore)
+{
+    auto res = mValidBefore.emplace(txID, validBefore);
+    if (!res.second)
+    {
+        // txid is the primary key of txtiming, so this only happens when the
+        // index is reloaded on top of itself
+        return;
+    }
+    mByExpiry[validBefore].push_back(txID);
+}
+
+bool
+TxTimingIndex::exists(Hash const& txID) const
+{
+    return mValidBefore.find(txID) != mValidBefore.end();
+}
+
+void
+TxTimingIndex::expire(uint64 closeTime)
+{
+    auto end = mByExpiry.lower_bound(closeTime);
+    for (auto it = mByExpiry.begin(); it != end; ++it)
+    {
+        for (auto const& txID : it->second)
+        {
+            mValidBefore.erase(txID);
+        }
+    }
+    mByExpiry.erase(mByExpiry.begin(), end);
+}
+
+void
+TxTimingIndex::clear()
+{
+    mLoaded = false;
+    mValidBefore.clear();
+    mByExpiry.clear();
+}
+
+size_t
+TxTimingIndex::size() const
+{
+    return mValidBefore.size();
+}
+}
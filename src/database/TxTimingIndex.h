@@ -0,0 +1,54 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/HashOfHash.h"
+#include "util/NonCopyable.h"
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace stellar
+{
+
+/**
+ * Resident copy of the txtiming table: contents hashes of applied
+ * transactions together with the time they stay valid until.
+ *
+ * Lookups are a single hash probe. Entries are bucketed by valid_before, so
+ * dropping everything that expired before a close time only touches the
+ * expired buckets; as maxTime is bounded by txExpirationPeriod, the index
+ * never holds more than that period's worth of transactions.
+ *
+ * The index starts out unloaded; TransactionFrame fills it from the table the
+ * first time it is needed (see TransactionFrame::timingExists). Clients are
+ * responsible for only adding entries whose rows have been committed.
+ */
+class TxTimingIndex : NonMovableOrCopyable
+{
+  public:
+    bool isLoaded() const;
+    void setLoaded();
+
+    void add(Hash const& txID, uint64 validBefore);
+
+    bool exists(Hash const& txID) const;
+
+    // Drops every entry with valid_before < closeTime, matching
+    // TransactionFrame::deleteOldEntries.
+    void expire(uint64 closeTime);
+
+    // Drops every entry and marks the index as unloaded.
+    void clear();
+
+    size_t size() const;
+
+  private:
+    bool mLoaded = false;
+    std::unordered_map<Hash, uint64> mValidBefore;
+    std::map<uint64, std::vector<Hash>> mByExpiry;
+};
+}
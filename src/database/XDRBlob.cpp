@@ -0,0 +1,129 @@
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/XDRBlob.h"
+#include "crypto/Hex.h"
+#include "database/Database.h"
+#include "util/Logging.h"
+#include "util/basen.h"
+
+#include <stdexcept>
+
+namespace stellar
+{
+
+namespace
+{
+struct BlobColumn
+{
+    char const* mTable;
+    char const* mColumn;
+    bool mEmptyDefault;
+};
+
+BlobColumn const BLOB_COLUMNS[] = {{"reviewable_request", "body", false},
+                                   {"reviewable_request", "external_details",
+                                    true},
+                                   {"txhistory", "txbody", false},
+                                   {"txhistory", "txresult", false},
+                                   {"txhistory", "txmeta", false},
+                                   {"txfeehistory", "txchanges", false}};
+
+int
+hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+}
+
+std::string
+XDRBlob::encode(Database& db, std::vector<uint8_t> const& bytes)
+{
+    if (!db.hasBinaryXDRBlobs())
+    {
+        return bn::encode_b64(bytes);
+    }
+    return "\\x" + binToHex(bytes);
+}
+
+void
+XDRBlob::decode(Database& db, std::string const& column,
+                std::vector<uint8_t>& buffer)
+{
+    buffer.clear();
+    if (!db.hasBinaryXDRBlobs())
+    {
+        bn::decode_b64(column, buffer);
+        return;
+    }
+
+    if (column.size() < 2 || column[0] != '\\' || column[1] != 'x' ||
+        column.size() % 2 != 0)
+    {
+        throw std::runtime_error("malformed bytea value");
+    }
+    buffer.reserve((column.size() - 2) / 2);
+    for (size_t i = 2; i < column.size(); i += 2)
+    {
+        int hi = hexValue(column[i]);
+        int lo = hexValue(column[i + 1]);
+        if (hi < 0 || lo < 0)
+        {
+            throw std::runtime_error("malformed bytea value");
+        }
+        buffer.push_back(static_cast<uint8_t>((hi << 4) | lo));
+    }
+}
+
+void
+XDRBlob::migrate(Database& db, bool binary)
+{
+    if (db.isSqlite())
+    {
+        throw std::runtime_error("binary XDR blobs require postgresql");
+    }
+
+    db.clearPreparedStatementCache();
+    auto& sess = db.getSession();
+    for (auto const& c : BLOB_COLUMNS)
+    {
+        std::string alter = std::string("ALTER TABLE ") + c.mTable +
+                            " ALTER COLUMN " + c.mColumn;
+        CLOG(INFO, "Database") << "Converting " << c.mTable << "."
+                               << c.mColumn << " to "
+                               << (binary ? "BYTEA" : "base64 TEXT");
+        if (c.mEmptyDefault)
+        {
+            sess << alter + " DROP DEFAULT";
+        }
+        if (binary)
+        {
+            sess << alter + " TYPE BYTEA USING decode(" + c.mColumn +
+                        ", 'base64')";
+        }
+        else
+        {
+            // encode() breaks its output into lines of 76 characters
+            sess << alter + " TYPE TEXT USING translate(encode(" + c.mColumn +
+                        ", 'base64'), E'\\n', '')";
+        }
+        if (c.mEmptyDefault)
+        {
+            sess << alter + " SET DEFAULT ''";
+        }
+    }
+}
+}
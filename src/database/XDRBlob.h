@@ -0,0 +1,60 @@
+#pragma once
+
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdrpp/marshal.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+class Database;
+
+/**
+ * Encoding of the XDR blobs kept in reviewable_request (body,
+ * external_details), txhistory (txbody, txresult, txmeta) and txfeehistory
+ * (txchanges).
+ *
+ * By default these are base64 TEXT columns. With Config::BINARY_XDR_BLOBS
+ * (postgresql only) they are BYTEA columns holding the raw XDR, exchanged in
+ * postgres' hex format ("\x0a1b..."): a third smaller on disk, and decoded
+ * with a table lookup per byte instead of base64. Database::
+ * upgradeToCurrentSchema converts the columns whenever the configured mode
+ * differs from the one the database is in, see migrate().
+ */
+class XDRBlob
+{
+  public:
+    static std::string encode(Database& db, std::vector<uint8_t> const& bytes);
+
+    template <typename T>
+    static std::string
+    encodeObject(Database& db, T const& t)
+    {
+        return encode(db, xdr::xdr_to_opaque(t));
+    }
+
+    // Decodes a column value into `buffer`, reusing its capacity.
+    static void decode(Database& db, std::string const& column,
+                       std::vector<uint8_t>& buffer);
+
+    // Decodes a column value and unmarshals `out` from it; `buffer` is
+    // scratch space that callers loading many rows should keep across rows.
+    template <typename T>
+    static void
+    decodeObject(Database& db, std::string const& column,
+                 std::vector<uint8_t>& buffer, T& out)
+    {
+        decode(db, column, buffer);
+        xdr::xdr_get g(buffer.data(), buffer.data() + buffer.size());
+        xdr::xdr_argpack_archive(g, out);
+        g.done();
+    }
+
+    // Converts every blob column to BYTEA (`binary`) or base64 TEXT.
+    static void migrate(Database& db, bool binary);
+};
+}
@@ -89,6 +89,16 @@ class Herder
     virtual void recvTxSet(Hash const& hash, TxSetFrame const& txset) = 0;
     // We are learning about a new transaction.
     virtual TransactionSubmitStatus recvTransaction(TransactionFramePtr tx) = 0;
+    // We are learning about a batch of new transactions; their signatures are
+    // prechecked in parallel and they are validated inside of a single SQL
+    // transaction. Returns the status of each transaction, in order.
+    virtual std::vector<TransactionSubmitStatus>
+    recvTransactions(std::vector<TransactionFramePtr> const& txs) = 0;
+    // We are learning about a new transaction from `peer`; it is validated,
+    // and flooded if valid, once admitted from the queue.
+    virtual void recvFloodedTransaction(TransactionFramePtr tx,
+                                        StellarMessage const& msg,
+                                        PeerPtr peer) = 0;
     virtual void peerDoesntHave(stellar::MessageType type,
                                 uint256 const& itemID, PeerPtr peer) = 0;
     virtual TxSetFramePtr getTxSet(Hash const& hash) = 0;
@@ -127,6 +137,7 @@ class Herder
                                          uint32_t ledgerCount,
                                          XDROutputFileStream& scpHistory);
     static void dropAll(Database& db);
+    static void addSCPTxSets(Database& db);
     static void deleteOldEntries(Database& db, uint32_t ledgerSeq);
 };
 }
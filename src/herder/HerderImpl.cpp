@@ -17,6 +17,7 @@
 #include "util/make_unique.h"
 #include "lib/json/json.h"
 #include "scp/LocalNode.h"
+#include "transactions/SignaturePrechecker.h"
 #include "main/PersistentState.h"
 
 #include "medida/meter.h"
@@ -27,6 +28,7 @@
 #include "util/XDRStream.h"
 
 #include <ctime>
+#include <functional>
 
 using namespace std;
 using namespace soci;
@@ -112,6 +114,7 @@ HerderImpl::HerderImpl(Application& app)
     , mApp(app)
     , mLedgerManager(app.getLedgerManager())
     , mSCPMetrics(app)
+    , mTxAdmissionQueue(app, *this)
 {
     Hash hash = mSCP.getLocalNode()->getQuorumSetHash();
     mPendingEnvelopes.recvSCPQuorumSet(hash,
@@ -891,7 +894,7 @@ HerderImpl::recvTransactions(TxSetFramePtr txSet)
     bool allGood = true;
     for (auto tx : txSet->sortForApply())
     {
-        if (recvTransaction(tx) != TX_STATUS_PENDING)
+        if (admitTransaction(tx) != TX_STATUS_PENDING)
         {
             allGood = false;
         }
@@ -927,6 +930,36 @@ HerderImpl::recvTransaction(TransactionFramePtr tx)
     soci::transaction sqltx(mApp.getDatabase().getSession());
     mApp.getDatabase().setCurrentTransactionReadOnly();
 
+    return admitTransaction(tx);
+}
+
+std::vector<Herder::TransactionSubmitStatus>
+HerderImpl::recvTransactions(std::vector<TransactionFramePtr> const& txs)
+{
+    SignaturePrechecker::precheck(mApp, txs);
+
+    std::vector<TransactionSubmitStatus> statuses;
+    statuses.reserve(txs.size());
+
+    soci::transaction sqltx(mApp.getDatabase().getSession());
+    mApp.getDatabase().setCurrentTransactionReadOnly();
+    for (auto const& tx : txs)
+    {
+        statuses.push_back(admitTransaction(tx));
+    }
+    return statuses;
+}
+
+void
+HerderImpl::recvFloodedTransaction(TransactionFramePtr tx,
+                                   StellarMessage const& msg, PeerPtr peer)
+{
+    mTxAdmissionQueue.enqueue(tx, msg, peer);
+}
+
+Herder::TransactionSubmitStatus
+HerderImpl::admitTransaction(TransactionFramePtr tx)
+{
     auto const& acc = tx->getSourceID();
     auto const& txID = tx->getFullHash();
 
@@ -1295,6 +1328,13 @@ HerderImpl::triggerNextLedger(uint32_t ledgerSeqToTrigger)
     auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
     TxSetFramePtr proposedSet = std::make_shared<TxSetFrame>(lcl.hash);
 
+    size_t pendingCount = 0;
+    for (auto const& m : mPendingTransactions)
+    {
+        pendingCount += countTxs(m);
+    }
+    proposedSet->mTransactions.reserve(pendingCount);
+
     for (auto const& m : mPendingTransactions)
     {
         for (auto const& pair : m)
@@ -1503,6 +1543,83 @@ HerderImpl::dumpQuorumInfo(Json::Value& ret, NodeID const& id, bool summary,
     mSCP.dumpQuorumInfo(ret["slots"], id, summary, index);
 }
 
+// Stores a base64 encoded blob under its hash in one of the content addressed
+// SCP tables (scptxsets, scpquorums); if it is there already, only its
+// lastledgerseq is bumped. Without `encode` a blob that is not stored yet is
+// left out.
+static void
+storeSCPBlob(Database& db, std::string const& table,
+             std::string const& hashColumn, std::string const& blobColumn,
+             Hash const& hash, uint32 seq,
+             std::function<std::string()> const& encode)
+{
+    std::string hashHex = binToHex(hash);
+
+    auto prepUp = db.getPreparedStatement("UPDATE " + table +
+                                          " SET lastledgerseq = :l WHERE " +
+                                          hashColumn + " = :h");
+    auto& stUp = prepUp.statement();
+    stUp.exchange(use(seq));
+    stUp.exchange(use(hashHex));
+    stUp.define_and_bind();
+    {
+        auto timer = db.getUpdateTimer(table);
+        stUp.execute(true);
+    }
+    if (stUp.get_affected_rows() == 1 || !encode)
+    {
+        return;
+    }
+
+    std::string blob = encode();
+    auto prepIns = db.getPreparedStatement(
+        "INSERT INTO " + table + " (" + hashColumn + ", lastledgerseq, " +
+        blobColumn + ") VALUES (:h, :l, :v)");
+    auto& stIns = prepIns.statement();
+    stIns.exchange(use(hashHex));
+    stIns.exchange(use(seq));
+    stIns.exchange(use(blob));
+    stIns.define_and_bind();
+    {
+        auto timer = db.getInsertTimer(table);
+        stIns.execute(true);
+    }
+    if (stIns.get_affected_rows() != 1)
+    {
+        throw std::runtime_error("Could not update data in SQL");
+    }
+}
+
+// Loads a blob stored by storeSCPBlob; returns false if there is none.
+static bool
+loadSCPBlob(Database& db, std::string const& table,
+            std::string const& hashColumn, std::string const& blobColumn,
+            Hash const& hash, std::vector<uint8_t>& blob)
+{
+    std::string hashHex = binToHex(hash);
+    std::string blob64;
+
+    auto prep = db.getPreparedStatement("SELECT " + blobColumn + " FROM " +
+                                        table + " WHERE " + hashColumn +
+                                        " = :h");
+    auto& st = prep.statement();
+    st.exchange(use(hashHex));
+    st.exchange(into(blob64));
+    st.define_and_bind();
+    {
+        auto timer = db.getSelectTimer(table);
+        st.execute(true);
+    }
+    if (!st.got_data())
+    {
+        return false;
+    }
+
+    blob.clear();
+    bn::decode_b64(blob64, blob);
+    return true;
+}
+
 void
 HerderImpl::persistSCPState(uint64 slot)
 {
@@ -1513,7 +1630,11 @@ HerderImpl::persistSCPState(uint64 slot)
 
     mLastSlotSaved = slot;
 
-    // saves SCP messages and related data (transaction sets, quorum sets)
+    // saves SCP messages; transaction sets and quorum sets they refer to are
+    // stored by hash, each of them only once. The lastledgerseq of the sets
+    // is bumped to the slot of every state referring to them, which is what
+    // keeps Herder::deleteOldEntries from trimming them; within a slot that
+    // is only done once.
     xdr::xvector<SCPEnvelope> latestEnvs;
     std::map<Hash, TxSetFramePtr> txSets;
     std::map<Hash, SCPQuorumSetPtr> quorumSets;
@@ -1522,39 +1643,101 @@ HerderImpl::persistSCPState(uint64 slot)
     {
         latestEnvs.emplace_back(e);
 
-        // saves transaction sets referred by the statement
         std::vector<Value> vals = Slot::getStatementValues(e.statement);
         for (auto const& v : vals)
         {
             StellarValue wb;
             xdr::xdr_from_opaque(v, wb);
-            TxSetFramePtr txSet = mPendingEnvelopes.getTxSet(wb.txSetHash);
-            txSets.insert(std::make_pair(wb.txSetHash, txSet));
+            if (txSets.find(wb.txSetHash) == txSets.end())
+            {
+                txSets.insert(std::make_pair(
+                    wb.txSetHash, mPendingEnvelopes.getTxSet(wb.txSetHash)));
+            }
         }
         Hash qsHash = Slot::getCompanionQuorumSetHashFromStatement(e.statement);
-        SCPQuorumSetPtr qSet = mPendingEnvelopes.getQSet(qsHash);
-        quorumSets.insert(std::make_pair(qsHash, qSet));
+        if (quorumSets.find(qsHash) == quorumSets.end())
+        {
+            quorumSets.insert(
+                std::make_pair(qsHash, mPendingEnvelopes.getQSet(qsHash)));
+        }
     }
 
-    xdr::xvector<TransactionSet> latestTxSets;
-    for (auto it : txSets)
+    auto& db = mApp.getDatabase();
+    auto seq = static_cast<uint32>(slot);
+    soci::transaction txscope(db.getSession());
+
+    auto persistedAt = [seq](std::map<Hash, uint32> const& persisted,
+                             Hash const& hash) {
+        auto it = persisted.find(hash);
+        return it != persisted.end() && it->second == seq;
+    };
+
+    for (auto const& it : txSets)
     {
-        latestTxSets.emplace_back();
-        it.second->toXDR(latestTxSets.back());
+        auto txSet = it.second;
+        if (persistedAt(mPersistedTxSets, it.first))
+        {
+            continue;
+        }
+        std::function<std::string()> encode;
+        if (txSet)
+        {
+            encode = [&txSet]() {
+                TransactionSet xdrTxSet;
+                txSet->toXDR(xdrTxSet);
+                return bn::encode_b64(xdr::xdr_to_opaque(xdrTxSet));
+            };
+        }
+        storeSCPBlob(db, "scptxsets", "txsethash", "txset", it.first, seq,
+                     encode);
     }
 
-    xdr::xvector<SCPQuorumSet> latestQSets;
-    for (auto it : quorumSets)
+    for (auto const& it : quorumSets)
     {
-        latestQSets.emplace_back(*it.second);
+        auto qSet = it.second;
+        if (persistedAt(mPersistedQSets, it.first))
+        {
+            continue;
+        }
+        std::function<std::string()> encode;
+        if (qSet)
+        {
+            encode = [&qSet]() {
+                return bn::encode_b64(xdr::xdr_to_opaque(*qSet));
+            };
+        }
+        storeSCPBlob(db, "scpquorums", "qsethash", "qset", it.first, seq,
+                     encode);
     }
 
+    // the layout of the blob is unchanged, transaction sets and quorum sets
+    // are just not inlined anymore
     auto latestSCPData =
-        xdr::xdr_to_opaque(latestEnvs, latestTxSets, latestQSets);
-    std::string scpState;
-    scpState = bn::encode_b64(latestSCPData);
+        xdr::xdr_to_opaque(latestEnvs, xdr::xvector<TransactionSet>(),
+                           xdr::xvector<SCPQuorumSet>());
+    mApp.getPersistentState().setState(PersistentState::kLastSCPData,
+                                       bn::encode_b64(latestSCPData));
 
-    mApp.getPersistentState().setState(PersistentState::kLastSCPData, scpState);
+    txscope.commit();
+
+    // only remember what the latest state refers to, older slots are not
+    // persisted again
+    mPersistedTxSets.clear();
+    for (auto const& it : txSets)
+    {
+        if (it.second)
+        {
+            mPersistedTxSets[it.first] = seq;
+        }
+    }
+    mPersistedQSets.clear();
+    for (auto const& it : quorumSets)
+    {
+        if (it.second)
+        {
+            mPersistedQSets[it.first] = seq;
+        }
+    }
 }
 
 void
@@ -1587,6 +1770,8 @@ HerderImpl::restoreSCPState()
     {
         xdr::xdr_from_opaque(buffer, latestEnvs, latestTxSets, latestQSets);
 
+        // states written before tx sets and quorum sets were stored by hash
+        // carry them inline
         for (auto const& txset : latestTxSets)
         {
             TxSetFramePtr cur =
@@ -1599,6 +1784,40 @@ HerderImpl::restoreSCPState()
             Hash hash = sha256(xdr::xdr_to_opaque(qset));
             mPendingEnvelopes.recvSCPQuorumSet(hash, qset);
         }
+
+        auto& db = mApp.getDatabase();
+        std::vector<uint8_t> blob;
+        for (auto const& e : latestEnvs)
+        {
+            for (auto const& v : Slot::getStatementValues(e.statement))
+            {
+                StellarValue wb;
+                xdr::xdr_from_opaque(v, wb);
+                if (mPendingEnvelopes.getTxSet(wb.txSetHash) ||
+                    !loadSCPBlob(db, "scptxsets", "txsethash", "txset",
+                                 wb.txSetHash, blob))
+                {
+                    continue;
+                }
+                TransactionSet txset;
+                xdr::xdr_from_opaque(blob, txset);
+                mPendingEnvelopes.recvTxSet(
+                    wb.txSetHash,
+                    make_shared<TxSetFrame>(mApp.getNetworkID(), txset));
+            }
+
+            Hash qsHash =
+                Slot::getCompanionQuorumSetHashFromStatement(e.statement);
+            if (!mPendingEnvelopes.getQSet(qsHash) &&
+                loadSCPBlob(db, "scpquorums", "qsethash", "qset", qsHash,
+                            blob))
+            {
+                SCPQuorumSet qset;
+                xdr::xdr_from_opaque(blob, qset);
+                mPendingEnvelopes.recvSCPQuorumSet(qsHash, qset);
+            }
+        }
+
         for (auto const& e : latestEnvs)
         {
             mSCP.setStateFromEnvelope(e.statement.slotIndex, e);
@@ -1926,6 +2145,21 @@ Herder::dropAll(Database& db)
                        "qset          TEXT NOT NULL,"
                        "PRIMARY KEY (qsethash)"
                        ")";
+
+    addSCPTxSets(db);
+}
+
+void
+Herder::addSCPTxSets(Database& db)
+{
+    db.getSession() << "DROP TABLE IF EXISTS scptxsets";
+
+    db.getSession() << "CREATE TABLE scptxsets ("
+                       "txsethash     CHARACTER(64) NOT NULL,"
+                       "lastledgerseq INT NOT NULL CHECK (lastledgerseq >= 0),"
+                       "txset         TEXT NOT NULL,"
+                       "PRIMARY KEY (txsethash)"
+                       ")";
 }
 
 void
@@ -1935,5 +2169,7 @@ Herder::deleteOldEntries(Database& db, uint32_t ledgerSeq)
                     << ledgerSeq;
     db.getSession() << "DELETE FROM scpquorums WHERE lastledgerseq <= "
                     << ledgerSeq;
+    db.getSession() << "DELETE FROM scptxsets WHERE lastledgerseq <= "
+                    << ledgerSeq;
 }
 }
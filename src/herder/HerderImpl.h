@@ -8,11 +8,14 @@
 #include <deque>
 #include <unordered_map>
 #include <memory>
+#include <map>
+#include <set>
 #include "herder/Herder.h"
 #include "scp/SCP.h"
 #include "util/Timer.h"
 #include <overlay/ItemFetcher.h>
 #include "PendingEnvelopes.h"
+#include "herder/TxAdmissionQueue.h"
 
 namespace medida
 {
@@ -97,6 +100,21 @@ class HerderImpl : public Herder, public SCPDriver
     void acceptedCommit(uint64 slotIndex, SCPBallot const& ballot) override;
 
     TransactionSubmitStatus recvTransaction(TransactionFramePtr tx) override;
+    std::vector<TransactionSubmitStatus>
+    recvTransactions(std::vector<TransactionFramePtr> const& txs) override;
+    void recvFloodedTransaction(TransactionFramePtr tx,
+                                StellarMessage const& msg,
+                                PeerPtr peer) override;
+
+    // checks tx and adds it to the pending transactions; must be called
+    // inside of a SQL transaction
+    TransactionSubmitStatus admitTransaction(TransactionFramePtr tx);
+
+    TxAdmissionQueue&
+    getTxAdmissionQueue()
+    {
+        return mTxAdmissionQueue;
+    }
 
     void recvSCPEnvelope(SCPEnvelope const& envelope) override;
 
@@ -196,6 +214,11 @@ class HerderImpl : public Herder, public SCPDriver
     // only keep track of the most recent slot
     uint64 mLastSlotSaved;
 
+    // transaction sets and quorum sets referenced by the last persisted
+    // state, with the slot they were last stored for
+    std::map<Hash, uint32> mPersistedTxSets;
+    std::map<Hash, uint32> mPersistedQSets;
+
     // Mark changes to mTrackingSCP in metrics.
     void stateChanged();
     VirtualClock::time_point mLastStateChange;
@@ -289,5 +312,7 @@ class HerderImpl : public Herder, public SCPDriver
     };
 
     SCPMetrics mSCPMetrics;
+
+    TxAdmissionQueue mTxAdmissionQueue;
 };
 }
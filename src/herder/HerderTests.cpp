@@ -3,16 +3,32 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "herder/HerderImpl.h"
+#include "herder/TxSetFrame.h"
 #include "main/Application.h"
+#include "main/PersistentState.h"
 #include "simulation/Simulation.h"
 
 #include "main/test.h"
 #include "main/CommandHandler.h"
+#include "lib/http/connection.hpp"
+#include "database/Database.h"
 #include "ledger/LedgerHeaderFrame.h"
 #include "overlay/OverlayManager.h"
+#include "scp/Slot.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include "util/basen.h"
 #include "xdrpp/marshal.h"
 
 #include "test/test_marshaler.h"
+#include "util/Logging.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <sstream>
 
 using namespace stellar;
 using namespace stellar::txtest;
@@ -150,6 +166,301 @@ TEST_CASE("recvTx", "[herder]")
 {
 }
 
+TEST_CASE("tx admission queue", "[herder]")
+{
+    Config cfg(getTestConfig());
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+
+    Hash const& networkID = app->getNetworkID();
+    app->start();
+
+    auto& herder = static_cast<HerderImpl&>(app->getHerder());
+    auto& queue = herder.getTxAdmissionQueue();
+
+    SecretKey root = getRoot();
+    Salt rootSeq = 1;
+    auto makeTx = [&]() {
+        auto tx = createCreateAccountTx(networkID, root,
+                                        SecretKey::random(), rootSeq++,
+                                        AccountType::GENERAL);
+        StellarMessage msg;
+        msg.type(MessageType::TRANSACTION);
+        msg.transaction() = tx->getEnvelope();
+        return std::make_pair(tx, msg);
+    };
+
+    auto& latency = app->getMetrics().NewTimer(
+        {"herder", "tx-admission", "latency"});
+    auto admitted = latency.count();
+
+    auto first = makeTx();
+    REQUIRE(queue.enqueue(first.first, first.second, nullptr));
+    REQUIRE(queue.isQueued(first.first->getFullHash()));
+
+    SECTION("duplicates are dropped by hash")
+    {
+        REQUIRE_FALSE(queue.enqueue(first.first, first.second, nullptr));
+        REQUIRE(queue.size() == 1);
+    }
+    SECTION("admitted on the main thread")
+    {
+        auto second = makeTx();
+        herder.recvFloodedTransaction(second.first, second.second, nullptr);
+        REQUIRE(queue.size() == 2);
+
+        while (queue.size() != 0)
+        {
+            clock.crank(false);
+        }
+        REQUIRE(latency.count() == admitted + 2);
+        REQUIRE(herder.recvTransaction(first.first) ==
+                Herder::TX_STATUS_DUPLICATE);
+        REQUIRE(herder.recvTransaction(second.first) ==
+                Herder::TX_STATUS_DUPLICATE);
+    }
+    SECTION("backpressure")
+    {
+        for (size_t i = 1; i < TxAdmissionQueue::MAX_QUEUED_PER_PEER; i++)
+        {
+            auto tx = makeTx();
+            REQUIRE(queue.enqueue(tx.first, tx.second, nullptr));
+        }
+        auto extra = makeTx();
+        REQUIRE_FALSE(queue.enqueue(extra.first, extra.second, nullptr));
+        REQUIRE(queue.size() == TxAdmissionQueue::MAX_QUEUED_PER_PEER);
+
+        queue.flush();
+        REQUIRE(queue.size() == 0);
+        REQUIRE(queue.enqueue(extra.first, extra.second, nullptr));
+    }
+}
+
+TEST_CASE("bulk tx submission", "[herder]")
+{
+    Config cfg(getTestConfig());
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+
+    Hash const& networkID = app->getNetworkID();
+    app->start();
+
+    SecretKey root = getRoot();
+    Salt rootSeq = 1;
+
+    // appends `envelope` to `to`, followed by `padding` zero bytes that are
+    // counted in its length
+    auto append = [](std::string& to, TransactionEnvelope const& envelope,
+                     size_t padding) {
+        auto bin = xdr::xdr_to_opaque(envelope);
+        bin.resize(bin.size() + padding);
+        auto sz = static_cast<uint32_t>(bin.size());
+        to.push_back(static_cast<char>((sz >> 24) & 0xff));
+        to.push_back(static_cast<char>((sz >> 16) & 0xff));
+        to.push_back(static_cast<char>((sz >> 8) & 0xff));
+        to.push_back(static_cast<char>(sz & 0xff));
+        to.append(bin.begin(), bin.end());
+    };
+    auto newEnvelope = [&]() {
+        auto tx = createCreateAccountTx(networkID, root, SecretKey::random(),
+                                        rootSeq++, AccountType::GENERAL);
+        return tx->getEnvelope();
+    };
+
+    std::string body;
+    const size_t nbTransactions = 3;
+    for (size_t i = 0; i < nbTransactions; i++)
+    {
+        append(body, newEnvelope(), 0);
+    }
+
+    auto submit = [&](std::string const& txs) {
+        bool done = false;
+        std::string result;
+        app->getCommandHandler().txs("", txs,
+                                     [&](std::string const& reply) {
+                                         result = reply;
+                                         done = true;
+                                     });
+        while (!done)
+        {
+            clock.crank(false);
+        }
+        std::vector<std::string> lines;
+        std::istringstream in(result);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    };
+
+    auto lines = submit(body);
+    REQUIRE(lines.size() == nbTransactions);
+    for (auto const& line : lines)
+    {
+        REQUIRE(line == "{\"status\": \"PENDING\"}");
+    }
+
+    SECTION("resubmitted")
+    {
+        lines = submit(body);
+        REQUIRE(lines.size() == nbTransactions);
+        for (auto const& line : lines)
+        {
+            REQUIRE(line == "{\"status\": \"DUPLICATE\"}");
+        }
+    }
+    SECTION("truncated body")
+    {
+        body.resize(body.size() - 1);
+        lines = submit(body);
+        REQUIRE(lines.size() == nbTransactions);
+        REQUIRE(lines.back().find("exception") != std::string::npos);
+    }
+    SECTION("padded record")
+    {
+        std::string padded;
+        append(padded, newEnvelope(), 4);
+        lines = submit(padded);
+        REQUIRE(lines.size() == 1);
+        REQUIRE(lines.back().find("exception") != std::string::npos);
+    }
+    SECTION("too many transactions")
+    {
+        std::string full;
+        for (size_t i = 0; i < TxAdmissionQueue::MAX_BATCH_SIZE; i++)
+        {
+            append(full, newEnvelope(), 0);
+        }
+        std::string tooMany = full;
+        append(tooMany, newEnvelope(), 0);
+
+        lines = submit(tooMany);
+        REQUIRE(lines.size() == 1);
+        REQUIRE(lines.back().find("too many transactions") !=
+                std::string::npos);
+
+        // nothing of the refused batch was admitted
+        lines = submit(full);
+        REQUIRE(lines.size() == TxAdmissionQueue::MAX_BATCH_SIZE);
+        for (auto const& line : lines)
+        {
+            REQUIRE(line == "{\"status\": \"PENDING\"}");
+        }
+    }
+}
+
+TEST_CASE("bulk tx submission over http", "[herder]")
+{
+    Config cfg(getTestConfig());
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+
+    Hash const& networkID = app->getNetworkID();
+    app->start();
+
+    SecretKey root = getRoot();
+    Salt rootSeq = 1;
+
+    // enough transactions for the body to take several reads
+    std::string body;
+    const size_t nbTransactions = 100;
+    for (size_t i = 0; i < nbTransactions; i++)
+    {
+        auto tx = createCreateAccountTx(networkID, root, SecretKey::random(),
+                                        rootSeq++, AccountType::GENERAL);
+        auto bin = xdr::xdr_to_opaque(tx->getEnvelope());
+        auto sz = static_cast<uint32_t>(bin.size());
+        body.push_back(static_cast<char>((sz >> 24) & 0xff));
+        body.push_back(static_cast<char>((sz >> 16) & 0xff));
+        body.push_back(static_cast<char>((sz >> 8) & 0xff));
+        body.push_back(static_cast<char>(sz & 0xff));
+        body.append(bin.begin(), bin.end());
+    }
+
+    auto request = [](std::string const& content, size_t contentLength) {
+        return "POST /txs HTTP/1.1\r\nContent-Length: " +
+               std::to_string(contentLength) + "\r\n\r\n" + content;
+    };
+
+    // sends `req` to the http server of the application, closing the sending
+    // side once it is written, and returns everything read back until the
+    // server closes the connection
+    auto exchange = [&](std::string const& req) -> std::string {
+        asio::ip::tcp::socket socket(clock.getIOService());
+        socket.connect(asio::ip::tcp::endpoint(
+            asio::ip::address::from_string("127.0.0.1"), cfg.HTTP_PORT));
+
+        std::string response;
+        std::array<char, 4096> buffer;
+        bool done = false;
+        std::function<void()> readSome = [&]() {
+            socket.async_read_some(
+                asio::buffer(buffer),
+                [&](asio::error_code ec, std::size_t bytesTransferred) {
+                    response.append(buffer.data(), bytesTransferred);
+                    if (ec)
+                    {
+                        done = true;
+                        return;
+                    }
+                    readSome();
+                });
+        };
+        asio::async_write(socket, asio::buffer(req),
+                          [&](asio::error_code ec, std::size_t) {
+                              REQUIRE(!ec);
+                              socket.shutdown(
+                                  asio::ip::tcp::socket::shutdown_send, ec);
+                              readSome();
+                          });
+        while (!done)
+        {
+            clock.crank(false);
+        }
+        return response;
+    };
+
+    auto countLines = [](std::string const& response,
+                         std::string const& line) -> size_t {
+        size_t count = 0;
+        for (auto pos = response.find(line); pos != std::string::npos;
+             pos = response.find(line, pos + line.size()))
+        {
+            count++;
+        }
+        return count;
+    };
+    std::string const pending = "{\"status\": \"PENDING\"}\n";
+
+    SECTION("complete body")
+    {
+        auto response = exchange(request(body, body.size()));
+        REQUIRE(response.find("HTTP/1.0 200 OK\r\n") == 0);
+        REQUIRE(countLines(response, pending) == nbTransactions);
+    }
+    SECTION("oversized body")
+    {
+        auto response = exchange(
+            request("", http::server::connection::max_body_size + 1));
+        REQUIRE(response.find("HTTP/1.0 413 Request Entity Too Large\r\n") ==
+                0);
+    }
+    SECTION("truncated body")
+    {
+        // the connection is dropped without a reply, and nothing is
+        // submitted
+        auto response =
+            exchange(request(body.substr(0, body.size() / 2), body.size()));
+        REQUIRE(response.empty());
+
+        response = exchange(request(body, body.size()));
+        REQUIRE(countLines(response, pending) == nbTransactions);
+    }
+}
+
 TEST_CASE("txset", "[herder]")
 {
     Config cfg(getTestConfig());
@@ -421,6 +732,59 @@ TEST_CASE("surge", "[herder]")
     }
 }
 
+TEST_CASE("surge with large pending set", "[herder][bench][hide]")
+{
+    Config cfg(getTestConfig());
+    cfg.DESIRED_MAX_TX_PER_LEDGER = 1000;
+
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+
+    Hash const& networkID = app->getNetworkID();
+    app->start();
+
+    auto& lm = app->getLedgerManager();
+    lm.getCurrentLedgerHeader().maxTxSetSize = cfg.DESIRED_MAX_TX_PER_LEDGER;
+
+    int const nbAccounts = 500;
+    int const nbTransactions = 50000;
+
+    std::vector<SecretKey> accounts;
+    for (int i = 0; i < nbAccounts; i++)
+    {
+        accounts.emplace_back(SecretKey::random());
+    }
+    SecretKey destAccount = getAccount("destAccount");
+
+    TxSetFramePtr txSet = std::make_shared<TxSetFrame>(
+        lm.getLastClosedLedgerHeader().hash);
+    for (int n = 0; n < nbTransactions; n++)
+    {
+        txSet->add(createPaymentTx(networkID, accounts[n % nbAccounts],
+                                   destAccount, n / nbAccounts + 1, n + 10,
+                                   getNoPaymentFee()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    txSet->sortForHash();
+
+    // drop every third transaction in one go, as trimInvalid does
+    std::vector<TransactionFramePtr> dropped;
+    for (size_t i = 0; i < txSet->mTransactions.size(); i += 3)
+    {
+        dropped.push_back(txSet->mTransactions[i]);
+    }
+    txSet->removeTxs(dropped);
+    REQUIRE(txSet->size() == nbTransactions - dropped.size());
+
+    txSet->surgePricingFilter(lm);
+    REQUIRE(txSet->size() == cfg.DESIRED_MAX_TX_PER_LEDGER);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LOG(INFO) << "trimmed and surge priced " << nbTransactions << " txs in "
+              << elapsed.count() << "ms";
+}
+
 TEST_CASE("SCP Driver", "[herder]")
 {
     Config cfg(getTestConfig());
@@ -653,3 +1017,164 @@ TEST_CASE("SCP State", "[herder]")
         }
     }
 }
+
+TEST_CASE("SCP state persistence", "[herder]")
+{
+    Config cfg(getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE));
+
+    auto rowCount = [](Database& db, std::string const& table) -> int
+    {
+        int n = 0;
+        db.getSession() << "SELECT COUNT(*) FROM " << table, soci::into(n);
+        return n;
+    };
+    auto lastLedgerSeq = [](Database& db, std::string const& table,
+                            std::string const& hashColumn,
+                            Hash const& hash) -> int
+    {
+        int seq = -1;
+        std::string hashHex = binToHex(hash);
+        db.getSession() << "SELECT lastledgerseq FROM " << table << " WHERE "
+                        << hashColumn << " = :h",
+            soci::into(seq), soci::use(hashHex);
+        return seq;
+    };
+    auto timerCount = [](Application& app, std::string const& op,
+                         std::string const& table) -> int64_t
+    {
+        return app.getMetrics()
+            .NewTimer({"database", op, table})
+            .count();
+    };
+
+    // what the last persisted state refers to
+    std::set<Hash> txSetHashes;
+    Hash qSetHash;
+    int lastSlot = 0;
+    xdr::xvector<SCPEnvelope> envs;
+    xdr::xvector<TransactionSet> txSets;
+    xdr::xvector<SCPQuorumSet> qSets;
+
+    {
+        VirtualClock clock;
+        Application::pointer app = Application::create(clock, cfg);
+        app->start();
+
+        while (app->getLedgerManager().getLastClosedLedgerNum() < 4)
+        {
+            clock.crank(true);
+        }
+
+        auto& db = app->getDatabase();
+        auto& herder = app->getHerder();
+
+        std::vector<uint8_t> buffer;
+        bn::decode_b64(app->getPersistentState().getState(
+                           PersistentState::kLastSCPData),
+                       buffer);
+        xdr::xdr_from_opaque(buffer, envs, txSets, qSets);
+
+        // sets are stored by hash, not inlined
+        REQUIRE(!envs.empty());
+        REQUIRE(txSets.empty());
+        REQUIRE(qSets.empty());
+
+        lastSlot = static_cast<int>(envs.back().statement.slotIndex);
+        for (auto const& e : envs)
+        {
+            for (auto const& v : Slot::getStatementValues(e.statement))
+            {
+                StellarValue wb;
+                xdr::xdr_from_opaque(v, wb);
+                txSetHashes.insert(wb.txSetHash);
+            }
+            qSetHash =
+                Slot::getCompanionQuorumSetHashFromStatement(e.statement);
+        }
+        REQUIRE(!txSetHashes.empty());
+
+        for (auto const& h : txSetHashes)
+        {
+            REQUIRE(lastLedgerSeq(db, "scptxsets", "txsethash", h) ==
+                    lastSlot);
+            auto txSet = herder.getTxSet(h);
+            REQUIRE(!!txSet);
+            txSets.emplace_back();
+            txSet->toXDR(txSets.back());
+        }
+        auto qSet = herder.getQSet(qSetHash);
+        REQUIRE(!!qSet);
+        qSets.emplace_back(*qSet);
+
+        // every slot was persisted more than once and referred to the same
+        // quorum set: each set got inserted once, later persists only bumped
+        // its lastledgerseq
+        REQUIRE(rowCount(db, "scpquorums") == 1);
+        REQUIRE(timerCount(*app, "insert", "scpquorums") == 1);
+        REQUIRE(timerCount(*app, "update", "scpquorums") > 1);
+        REQUIRE(lastLedgerSeq(db, "scpquorums", "qsethash", qSetHash) ==
+                lastSlot);
+        REQUIRE(timerCount(*app, "insert", "scptxsets") ==
+                rowCount(db, "scptxsets"));
+
+        // tx sets of the older slots are trimmed, the ones the state refers
+        // to are kept
+        REQUIRE(rowCount(db, "scptxsets") >
+                static_cast<int>(txSetHashes.size()));
+        Herder::deleteOldEntries(db, lastSlot - 1);
+        REQUIRE(rowCount(db, "scptxsets") ==
+                static_cast<int>(txSetHashes.size()));
+        for (auto const& h : txSetHashes)
+        {
+            REQUIRE(lastLedgerSeq(db, "scptxsets", "txsethash", h) ==
+                    lastSlot);
+        }
+        REQUIRE(rowCount(db, "scpquorums") == 1);
+    }
+
+    // the restarted node uses another quorum set, so the one the state
+    // refers to can only come from the database
+    Config cfg2(cfg);
+    cfg2.FORCE_SCP = false;
+    cfg2.QUORUM_SET.threshold = 2;
+    cfg2.QUORUM_SET.validators.push_back(
+        SecretKey::random().getPublicKey());
+    REQUIRE(sha256(xdr::xdr_to_opaque(cfg2.QUORUM_SET)) != qSetHash);
+
+    auto checkRestored = [&](Application& app)
+    {
+        auto& herder = app.getHerder();
+        for (auto const& h : txSetHashes)
+        {
+            REQUIRE(!!herder.getTxSet(h));
+        }
+        REQUIRE(!!herder.getQSet(qSetHash));
+    };
+
+    SECTION("restore from the tables")
+    {
+        VirtualClock clock2;
+        Application::pointer app2 = Application::create(clock2, cfg2, false);
+        app2->start();
+
+        checkRestored(*app2);
+    }
+
+    SECTION("restore from a blob with inline sets")
+    {
+        VirtualClock clock2;
+        Application::pointer app2 = Application::create(clock2, cfg2, false);
+
+        // state as written before sets were stored by hash
+        auto& db = app2->getDatabase();
+        db.getSession() << "DELETE FROM scptxsets";
+        db.getSession() << "DELETE FROM scpquorums";
+        app2->getPersistentState().setState(
+            PersistentState::kLastSCPData,
+            bn::encode_b64(xdr::xdr_to_opaque(envs, txSets, qSets)));
+
+        app2->start();
+
+        checkRestored(*app2);
+    }
+}
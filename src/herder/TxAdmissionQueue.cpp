@@ -0,0 +1,195 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/TxAdmissionQueue.h"
+#include "herder/HerderImpl.h"
+#include "main/Application.h"
+#include "medida/counter.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include "overlay/OverlayManager.h"
+#include <algorithm>
+
+namespace stellar
+{
+
+const size_t TxAdmissionQueue::MAX_BATCH_SIZE = 256;
+const size_t TxAdmissionQueue::MAX_QUEUED_PER_PEER = 1000;
+const size_t TxAdmissionQueue::MAX_QUEUED = 10000;
+
+TxAdmissionQueue::TxAdmissionQueue(Application& app, HerderImpl& herder)
+    : mApp(app)
+    , mHerder(herder)
+    , mSize(0)
+    , mBatchTimer(app)
+    , mBatchScheduled(false)
+    , mLatency(
+          app.getMetrics().NewTimer({"herder", "tx-admission", "latency"}))
+    , mQueueDepth(app.getMetrics().NewCounter(
+          {"herder", "tx-admission", "queue-depth"}))
+    , mBatch(app.getMetrics().NewTimer({"herder", "tx-admission", "batch"}))
+    , mDropped(app.getMetrics().NewMeter(
+          {"herder", "tx-admission", "dropped"}, "transaction"))
+{
+}
+
+bool
+TxAdmissionQueue::enqueue(TransactionFramePtr tx, StellarMessage const& msg,
+                          PeerPtr peer)
+{
+    auto const& txID = tx->getFullHash();
+    if (mQueued.find(txID) != mQueued.end())
+    {
+        if (peer)
+        {
+            mApp.getOverlayManager().recvFloodedMsg(msg, peer);
+        }
+        return false;
+    }
+
+    auto& queue = mQueues[peer.get()];
+    if (queue.size() >= MAX_QUEUED_PER_PEER || mSize >= MAX_QUEUED)
+    {
+        if (queue.empty())
+        {
+            mQueues.erase(peer.get());
+        }
+        mDropped.Mark();
+        return false;
+    }
+
+    if (queue.empty())
+    {
+        mRoundRobin.push_back(peer.get());
+    }
+    queue.push_back({tx, msg, peer, mApp.getClock().now()});
+    mQueued.insert(txID);
+    mSize++;
+    mQueueDepth.set_count(mSize);
+
+    scheduleBatch();
+    return true;
+}
+
+bool
+TxAdmissionQueue::isQueued(Hash const& fullHash) const
+{
+    return mQueued.find(fullHash) != mQueued.end();
+}
+
+size_t
+TxAdmissionQueue::size() const
+{
+    return mSize;
+}
+
+void
+TxAdmissionQueue::flush()
+{
+    mBatchTimer.cancel();
+    mBatchScheduled = false;
+    while (mSize > 0)
+    {
+        admitBatch();
+    }
+}
+
+void
+TxAdmissionQueue::scheduleBatch()
+{
+    if (mBatchScheduled)
+    {
+        return;
+    }
+    mBatchScheduled = true;
+    // a timer, unlike a plain post, lets whatever is already waiting on the
+    // main thread run first and is cancelled with the queue
+    mBatchTimer.expires_from_now(std::chrono::milliseconds(0));
+    mBatchTimer.async_wait(
+        [this]() {
+            mBatchScheduled = false;
+            admitBatch();
+            if (mSize > 0)
+            {
+                scheduleBatch();
+            }
+        },
+        &VirtualTimer::onFailureNoop);
+}
+
+std::vector<TxAdmissionQueue::Item>
+TxAdmissionQueue::takeBatch()
+{
+    std::vector<Item> batch;
+    batch.reserve(std::min(mSize, MAX_BATCH_SIZE));
+    while (batch.size() < MAX_BATCH_SIZE && !mRoundRobin.empty())
+    {
+        auto peer = mRoundRobin.front();
+        mRoundRobin.pop_front();
+
+        auto it = mQueues.find(peer);
+        assert(it != mQueues.end());
+        batch.emplace_back(std::move(it->second.front()));
+        it->second.pop_front();
+        if (it->second.empty())
+        {
+            mQueues.erase(it);
+        }
+        else
+        {
+            mRoundRobin.push_back(peer);
+        }
+
+        mQueued.erase(batch.back().mTx->getFullHash());
+        mSize--;
+    }
+    mQueueDepth.set_count(mSize);
+    return batch;
+}
+
+void
+TxAdmissionQueue::admitBatch()
+{
+    auto batch = takeBatch();
+    if (batch.empty())
+    {
+        return;
+    }
+    auto timer = mBatch.TimeScope();
+
+    std::vector<TransactionFramePtr> txs;
+    txs.reserve(batch.size());
+    for (auto const& item : batch)
+    {
+        txs.push_back(item.mTx);
+    }
+    auto statuses = mHerder.recvTransactions(txs);
+
+    auto& overlay = mApp.getOverlayManager();
+    auto now = mApp.getClock().now();
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        auto const& item = batch[i];
+        mLatency.Update(now - item.mQueuedAt);
+        if (statuses[i] != Herder::TX_STATUS_PENDING &&
+            statuses[i] != Herder::TX_STATUS_DUPLICATE)
+        {
+            continue;
+        }
+
+        // record that this peer sent us this transaction
+        auto peer = item.mPeer.lock();
+        if (peer)
+        {
+            overlay.recvFloodedMsg(item.mMsg, peer);
+        }
+        if (statuses[i] == Herder::TX_STATUS_PENDING)
+        {
+            // if it's a new transaction, broadcast it
+            overlay.broadcastMessage(item.mMsg);
+        }
+    }
+}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/Herder.h"
+#include "transactions/TransactionFrame.h"
+#include "util/NonCopyable.h"
+#include "util/Timer.h"
+#include <deque>
+#include <map>
+#include <unordered_set>
+
+namespace medida
+{
+class Counter;
+class Meter;
+class Timer;
+}
+
+namespace stellar
+{
+class Application;
+class HerderImpl;
+
+/**
+ * Admission pipeline for the transactions flooded by peers.
+ *
+ * Instead of validating each transaction as soon as it is read off the wire,
+ * transactions are queued per peer and admitted in batches, one batch per
+ * crank of the main thread, so that a burst of submissions does not hold SCP
+ * messages back:
+ *
+ * - a transaction that is already queued is dropped by full hash, the peer
+ *   that sent it is only recorded with the floodgate;
+ * - signatures of the whole batch are prechecked on the worker threads (see
+ *   SignaturePrechecker);
+ * - the batch is validated by the herder inside of a single read only SQL
+ *   transaction, and the transactions that made it to the pending set are
+ *   flooded.
+ *
+ * Batches are filled round robin across peers. Once a peer has
+ * MAX_QUEUED_PER_PEER transactions waiting, or the queue holds MAX_QUEUED
+ * transactions, further transactions are dropped until it drains.
+ *
+ * Reports "herder.tx-admission.latency" (time from queueing to verdict),
+ * "herder.tx-admission.queue-depth", "herder.tx-admission.batch" and
+ * "herder.tx-admission.dropped".
+ */
+class TxAdmissionQueue : NonMovableOrCopyable
+{
+  public:
+    static const size_t MAX_BATCH_SIZE;
+    static const size_t MAX_QUEUED_PER_PEER;
+    static const size_t MAX_QUEUED;
+
+    TxAdmissionQueue(Application& app, HerderImpl& herder);
+
+    // queues `tx`, received from `peer` (may be null) in `msg`, for
+    // admission; returns false if it was already queued or was dropped
+    bool enqueue(TransactionFramePtr tx, StellarMessage const& msg,
+                 PeerPtr peer);
+
+    bool isQueued(Hash const& fullHash) const;
+    size_t size() const;
+
+    // admits every queued transaction right away
+    void flush();
+
+  private:
+    struct Item
+    {
+        TransactionFramePtr mTx;
+        StellarMessage mMsg;
+        std::weak_ptr<Peer> mPeer;
+        VirtualClock::time_point mQueuedAt;
+    };
+
+    Application& mApp;
+    HerderImpl& mHerder;
+
+    std::map<Peer const*, std::deque<Item>> mQueues;
+    // peers with queued transactions, in the order batches take from them
+    std::deque<Peer const*> mRoundRobin;
+    std::unordered_set<Hash> mQueued;
+    size_t mSize;
+
+    VirtualTimer mBatchTimer;
+    bool mBatchScheduled;
+
+    medida::Timer& mLatency;
+    medida::Counter& mQueueDepth;
+    medida::Timer& mBatch;
+    medida::Meter& mDropped;
+
+    void scheduleBatch();
+    std::vector<Item> takeBatch();
+    void admitBatch();
+};
+}
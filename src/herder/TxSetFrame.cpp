@@ -11,7 +11,9 @@
 #include "main/Application.h"
 #include "main/Config.h"
 #include "database/Database.h"
+#include "transactions/SignaturePrechecker.h"
 #include <algorithm>
+#include <unordered_set>
 
 #include "xdrpp/printer.h"
 
@@ -132,26 +134,26 @@ TxSetFrame::sortForApply()
     return retList;
 }
 
-struct SurgeSorter
+// transaction with the fee ratio of its source account, so that the fee map
+// is looked up once per transaction instead of twice per comparison
+struct SurgeRank
 {
-    map<AccountID, int64>& mAccountFeeMap;
-    SurgeSorter(map<AccountID, int64>& afm) : mAccountFeeMap(afm)
-    {
-    }
-
-    bool operator()(TransactionFramePtr const& tx1,
-                    TransactionFramePtr const& tx2)
-    {
-        if (tx1->getSourceID() == tx2->getSourceID())
-            return tx1->getSalt() < tx2->getSalt();
-        auto fee1 = mAccountFeeMap[tx1->getSourceID()];
-        auto fee2 = mAccountFeeMap[tx2->getSourceID()];
-        if (fee1 == fee2)
-            return tx1->getSourceID() < tx2->getSourceID();
-        return fee1 > fee2;
-    }
+    int64 mAccountFee;
+    TransactionFramePtr mTx;
 };
 
+static bool
+SurgeSorter(SurgeRank const& r1, SurgeRank const& r2)
+{
+    auto const& tx1 = r1.mTx;
+    auto const& tx2 = r2.mTx;
+    if (tx1->getSourceID() == tx2->getSourceID())
+        return tx1->getSalt() < tx2->getSalt();
+    if (r1.mAccountFee == r2.mAccountFee)
+        return tx1->getSourceID() < tx2->getSourceID();
+    return r1.mAccountFee > r2.mAccountFee;
+}
+
 void
 TxSetFrame::surgePricingFilter(LedgerManager const& lm)
 {
@@ -173,15 +175,26 @@ TxSetFrame::surgePricingFilter(LedgerManager const& lm)
                 accountFeeMap[tx->getSourceID()] = r;
         }
 
-        // sort tx by amount of fee they have paid
-        // remove the bottom that aren't paying enough
-        std::vector<TransactionFramePtr> tempList = mTransactions;
-        std::sort(tempList.begin(), tempList.end(), SurgeSorter(accountFeeMap));
+        std::vector<SurgeRank> ranks;
+        ranks.reserve(mTransactions.size());
+        for (auto& tx : mTransactions)
+        {
+            ranks.push_back({accountFeeMap[tx->getSourceID()], tx});
+        }
+
+        // rank tx by amount of fee they have paid
+        // remove the bottom that aren't paying enough; only the split point
+        // matters, so there is no need to sort either side of it
+        std::nth_element(ranks.begin(), ranks.begin() + max, ranks.end(),
+                         SurgeSorter);
 
-        for (auto iter = tempList.begin() + max; iter != tempList.end(); iter++)
+        std::vector<TransactionFramePtr> dropped;
+        dropped.reserve(ranks.size() - max);
+        for (auto iter = ranks.begin() + max; iter != ranks.end(); iter++)
         {
-            removeTx(*iter);
+            dropped.push_back(iter->mTx);
         }
+        removeTxs(dropped);
     }
 }
 
@@ -195,6 +208,8 @@ TxSetFrame::trimInvalid(Application& app,
 
     sortForHash();
 
+    SignaturePrechecker::precheck(app, mTransactions);
+
     map<AccountID, vector<TransactionFramePtr>> accountTxMap;
 
     for (auto tx : mTransactions)
@@ -202,6 +217,7 @@ TxSetFrame::trimInvalid(Application& app,
         accountTxMap[tx->getSourceID()].push_back(tx);
     }
 
+    std::vector<TransactionFramePtr> invalid;
     for (auto& item : accountTxMap)
     {
         std::sort(item.second.begin(), item.second.end(), SaltSorter);
@@ -209,12 +225,14 @@ TxSetFrame::trimInvalid(Application& app,
         {
             if (!tx->checkValid(app))
             {
-                trimmed.push_back(tx);
-                removeTx(tx);
+                invalid.push_back(tx);
                 continue;
             }
         }
     }
+
+    removeTxs(invalid);
+    trimmed.insert(trimmed.end(), invalid.begin(), invalid.end());
 }
 
 // need to make sure every account that is submitting a tx has enough to pay
@@ -264,6 +282,8 @@ TxSetFrame::checkValid(Application& app) const
         lastHash = tx->getFullHash();
     }
 
+    SignaturePrechecker::precheck(app, mTransactions);
+
     for (auto& item : accountTxMap)
     {
         // order by salt
@@ -299,6 +319,30 @@ TxSetFrame::removeTx(TransactionFramePtr tx)
     mHashIsValid = false;
 }
 
+void
+TxSetFrame::removeTxs(std::vector<TransactionFramePtr> const& txs)
+{
+    if (txs.empty())
+    {
+        return;
+    }
+
+    // mark, then compact in a single pass; keeps the order of the rest
+    std::unordered_set<TransactionFrame const*> marked;
+    marked.reserve(txs.size());
+    for (auto const& tx : txs)
+    {
+        marked.insert(tx.get());
+    }
+    auto newEnd = std::remove_if(
+        mTransactions.begin(), mTransactions.end(),
+        [&marked](TransactionFramePtr const& tx) {
+            return marked.find(tx.get()) != marked.end();
+        });
+    mTransactions.erase(newEnd, mTransactions.end());
+    mHashIsValid = false;
+}
+
 Hash
 TxSetFrame::getContentsHash()
 {
@@ -47,6 +47,8 @@ class TxSetFrame
     void surgePricingFilter(LedgerManager const& lm);
 
     void removeTx(TransactionFramePtr tx);
+    // removes all of `txs` in a single pass over the set
+    void removeTxs(std::vector<TransactionFramePtr> const& txs);
 
     void
     add(TransactionFramePtr tx)
@@ -10,6 +10,8 @@
 #include "main/PersistentState.h"
 #include "bucket/BucketManager.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
+#include "crypto/SHA.h"
 #include "transactions/test/TxTests.h"
 #include "process/ProcessManager.h"
 #include <xdrpp/autocheck.h>
@@ -218,6 +220,41 @@ TEST_CASE_METHOD(HistoryTests, "HistoryManager::compress", "[history][compress]"
     REQUIRE(u->getState() == Work::WORK_SUCCESS);
     REQUIRE(fs::exists(fname));
     REQUIRE(!fs::exists(compressed));
+    {
+        std::ifstream in(fname, std::ifstream::binary);
+        std::string roundTrip((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+        REQUIRE(roundTrip == s);
+    }
+
+    // decompressing into a hasher sees exactly the original bytes
+    gzipFile(fname, compressed);
+    auto hasher = SHA256::create();
+    gunzipFile(compressed, fname, hasher.get());
+    REQUIRE(hasher->finish() == sha256(ByteSlice(s)));
+
+    // `gzip -d` refuses input that is not compressed, and so do we
+    REQUIRE_THROWS_AS(gunzipFile(fname, fname + ".out"), std::runtime_error);
+
+    // nor does it accept a truncated file
+    gzipFile(fname, compressed);
+    std::string truncated;
+    {
+        std::ifstream in(compressed, std::ifstream::binary);
+        truncated.assign((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+    }
+    truncated.resize(truncated.size() - 4);
+    {
+        std::ofstream out(compressed,
+                          std::ofstream::binary | std::ofstream::trunc);
+        out.write(truncated.data(), truncated.size());
+    }
+    REQUIRE_THROWS_AS(gunzipFile(compressed, fname), std::runtime_error);
+    auto t = wm.addWork<GunzipFileWork>(compressed);
+    wm.advanceChildren();
+    crankTillDone();
+    REQUIRE(t->getState() == Work::WORK_FAILURE_RAISE);
 }
 
 TEST_CASE_METHOD(HistoryTests, "HistoryArchiveState::get_put", "[history]")
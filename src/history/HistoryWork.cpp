@@ -8,6 +8,7 @@
 #include "crypto/SHA.h"
 #include "herder/LedgerCloseData.h"
 #include "herder/TxSetFrame.h"
+#include "transactions/SignaturePrechecker.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryManager.h"
 #include "history/HistoryWork.h"
@@ -16,10 +17,13 @@
 #include "ledger/LedgerManager.h"
 #include "main/Config.h"
 #include "process/ProcessManager.h"
+#include "util/Gzip.h"
 #include "util/Logging.h"
 #include "util/make_unique.h"
 #include "xdr/Stellar-ledger.h"
 #include "xdrpp/printer.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 
 #include "lib/util/format.h"
 
@@ -178,9 +182,37 @@ checkNoGzipSuffix(std::string const& filename)
     }
 }
 
+// Runs `job` on the worker io_service and passes the outcome to `handler` on
+// the main one; `job` reports failure by throwing.
+static void
+postToWorker(Application& app,
+             std::function<void(asio::error_code const& ec)> handler,
+             std::function<void()> job)
+{
+    app.getWorkerIOService().post([&app, handler, job]()
+                                  {
+                                      asio::error_code ec;
+                                      try
+                                      {
+                                          job();
+                                      }
+                                      catch (std::exception const& e)
+                                      {
+                                          CLOG(WARNING, "History") << e.what();
+                                          ec = std::make_error_code(
+                                              std::errc::io_error);
+                                      }
+                                      app.getClock().getIOService().post(
+                                          [ec, handler]()
+                                          {
+                                              handler(ec);
+                                          });
+                                  });
+}
+
 GzipFileWork::GzipFileWork(Application& app, WorkParent& parent,
                            std::string const& filenameNoGz, bool keepExisting)
-    : RunCommandWork(app, parent, std::string("gzip-file ") + filenameNoGz)
+    : Work(app, parent, std::string("gzip-file ") + filenameNoGz)
     , mFilenameNoGz(filenameNoGz)
     , mKeepExisting(keepExisting)
 {
@@ -195,20 +227,29 @@ GzipFileWork::onReset()
 }
 
 void
-GzipFileWork::getCommand(std::string& cmdLine, std::string& outFile)
+GzipFileWork::onStart()
 {
-    cmdLine = "gzip ";
-    if (mKeepExisting)
-    {
-        cmdLine += "-c ";
-        outFile = mFilenameNoGz + ".gz";
-    }
-    cmdLine += mFilenameNoGz;
+    std::string filenameNoGz = mFilenameNoGz;
+    bool keepExisting = mKeepExisting;
+    postToWorker(mApp, callComplete(), [filenameNoGz, keepExisting]()
+                 {
+                     gzipFile(filenameNoGz, filenameNoGz + ".gz");
+                     if (!keepExisting)
+                     {
+                         std::remove(filenameNoGz.c_str());
+                     }
+                 });
+}
+
+void
+GzipFileWork::onRun()
+{
+    // Do nothing: we spawned the compression in onStart().
 }
 
 GunzipFileWork::GunzipFileWork(Application& app, WorkParent& parent,
                                std::string const& filenameGz, bool keepExisting)
-    : RunCommandWork(app, parent, std::string("gunzip-file ") + filenameGz)
+    : Work(app, parent, std::string("gunzip-file ") + filenameGz)
     , mFilenameGz(filenameGz)
     , mKeepExisting(keepExisting)
 {
@@ -216,22 +257,32 @@ GunzipFileWork::GunzipFileWork(Application& app, WorkParent& parent,
 }
 
 void
-GunzipFileWork::getCommand(std::string& cmdLine, std::string& outFile)
+GunzipFileWork::onReset()
 {
-    cmdLine = "gzip -d ";
-    if (mKeepExisting)
-    {
-        cmdLine += "-c ";
-        outFile = mFilenameGz.substr(0, mFilenameGz.size() - 3);
-    }
-    cmdLine += mFilenameGz;
+    std::string filenameNoGz = mFilenameGz.substr(0, mFilenameGz.size() - 3);
+    std::remove(filenameNoGz.c_str());
 }
 
 void
-GunzipFileWork::onReset()
+GunzipFileWork::onStart()
 {
-    std::string filenameNoGz = mFilenameGz.substr(0, mFilenameGz.size() - 3);
-    std::remove(filenameNoGz.c_str());
+    std::string filenameGz = mFilenameGz;
+    bool keepExisting = mKeepExisting;
+    postToWorker(mApp, callComplete(), [filenameGz, keepExisting]()
+                 {
+                     gunzipFile(filenameGz,
+                                filenameGz.substr(0, filenameGz.size() - 3));
+                     if (!keepExisting)
+                     {
+                         std::remove(filenameGz.c_str());
+                     }
+                 });
+}
+
+void
+GunzipFileWork::onRun()
+{
+    // Do nothing: we spawned the decompression in onStart().
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -254,11 +305,15 @@ void
 VerifyBucketWork::onStart()
 {
     std::string filename = mBucketFile;
+    std::string filenameGz = mBucketFile + ".gz";
+    // a downloaded bucket is decompressed straight into the hasher, replacing
+    // whatever an earlier attempt left behind
+    bool gunzip = fs::exists(filenameGz);
     uint256 hash = mHash;
     Application& app = this->mApp;
     auto handler = callComplete();
     app.getWorkerIOService().post(
-        [&app, filename, handler, hash]()
+        [&app, filename, filenameGz, gunzip, handler, hash]()
         {
             auto hasher = SHA256::create();
             asio::error_code ec;
@@ -266,18 +321,42 @@ VerifyBucketWork::onStart()
             {
                 // ensure that the stream gets its own scope to avoid race with
                 // main thread
-                std::ifstream in(filename, std::ifstream::binary);
-                while (in)
+                if (gunzip)
                 {
-                    in.read(buf, sizeof(buf));
-                    hasher->add(ByteSlice(buf, in.gcount()));
+                    try
+                    {
+                        gunzipFile(filenameGz, filename, hasher.get());
+                    }
+                    catch (std::exception const& e)
+                    {
+                        CLOG(WARNING, "History") << e.what();
+                        ec = std::make_error_code(std::errc::io_error);
+                    }
+                }
+                else
+                {
+                    std::ifstream in(filename, std::ifstream::binary);
+                    while (in)
+                    {
+                        in.read(buf, sizeof(buf));
+                        hasher->add(ByteSlice(buf, in.gcount()));
+                    }
                 }
                 uint256 vHash = hasher->finish();
-                if (vHash == hash)
+                if (ec)
+                {
+                    CLOG(WARNING, "History") << "FAILED decompressing "
+                                             << filenameGz;
+                }
+                else if (vHash == hash)
                 {
                     CLOG(DEBUG, "History") << "Verified hash ("
                                            << hexAbbrev(hash) << ") for "
                                            << filename;
+                    if (gunzip)
+                    {
+                        std::remove(filenameGz.c_str());
+                    }
                 }
                 else
                 {
@@ -826,7 +905,8 @@ ApplyBucketsWork::onStart()
     {
         mSnapBucket = getBucket(i.snap);
         mSnapApplicator =
-            make_unique<BucketApplicator>(mApp.getDatabase(), mSnapBucket);
+            make_unique<BucketApplicator>(mApp.getDatabase(), mSnapBucket,
+                                          &mApp.getMetrics());
         CLOG(DEBUG, "History") << "ApplyBuckets : starting level[" << mLevel
                                << "].snap = " << i.snap;
         mApplying = true;
@@ -835,7 +915,8 @@ ApplyBucketsWork::onStart()
     {
         mCurrBucket = getBucket(i.curr);
         mCurrApplicator =
-            make_unique<BucketApplicator>(mApp.getDatabase(), mCurrBucket);
+            make_unique<BucketApplicator>(mApp.getDatabase(), mCurrBucket,
+                                          &mApp.getMetrics());
         CLOG(DEBUG, "History") << "ApplyBuckets : starting level[" << mLevel
                                << "].curr = " << i.curr;
         mApplying = true;
@@ -899,6 +980,8 @@ ApplyBucketsWork::onSuccess()
 // Apply Ledger Chain
 ///////////////////////////////////////////////////////////////////////////
 
+const size_t ApplyLedgerChainWork::PREPARE_AHEAD = 2;
+
 ApplyLedgerChainWork::ApplyLedgerChainWork(
     Application& app, WorkParent& parent, TmpDir const& downloadDir,
     uint32_t first, uint32_t last, LedgerHeaderHistoryEntry& lastApplied)
@@ -907,7 +990,15 @@ ApplyLedgerChainWork::ApplyLedgerChainWork(
     , mFirstSeq(first)
     , mCurrSeq(first)
     , mLastSeq(last)
+    , mNextPrepareSeq(first)
+    , mNextHeader(0)
     , mLastApplied(lastApplied)
+    , mPrepareTimer(app.getMetrics().NewTimer(
+          {"history", "apply-ledger-chain", "prepare"}))
+    , mWaitTimer(app.getMetrics().NewTimer(
+          {"history", "apply-ledger-chain", "wait"}))
+    , mApplyTimer(app.getMetrics().NewTimer(
+          {"history", "apply-ledger-chain", "apply"}))
 {
 }
 
@@ -934,56 +1025,113 @@ ApplyLedgerChainWork::onReset()
                           << LedgerManager::ledgerAbbrev(
                                  lm.getLastClosedLedgerHeader());
     mCurrSeq = mFirstSeq;
-    mHdrIn.close();
-    mTxIn.close();
+    mNextPrepareSeq = mFirstSeq;
+    // checkpoints still being prepared finish on their own, their results
+    // are simply dropped
+    mPrepared.clear();
+    mCurrent.reset();
+    mNextHeader = 0;
+}
+
+// Runs on a worker thread: nothing reachable from here may touch the
+// database or other main thread state.
+std::shared_ptr<ApplyLedgerChainWork::PreparedCheckpoint>
+ApplyLedgerChainWork::prepareCheckpoint(Application& app,
+                                        std::string const& hdrPath,
+                                        std::string const& txPath,
+                                        medida::Timer& prepareTimer)
+{
+    auto timer = prepareTimer.TimeScope();
+    auto res = std::make_shared<PreparedCheckpoint>();
+
+    XDRInputFileStream hdrIn;
+    hdrIn.open(hdrPath);
+    LedgerHeaderHistoryEntry hHeader;
+    while (hdrIn.readOne(hHeader))
+    {
+        res->mHeaders.push_back(hHeader);
+    }
+
+    XDRInputFileStream txIn;
+    txIn.open(txPath);
+    TransactionHistoryEntry txEntry;
+    std::vector<TransactionFramePtr> txs;
+    while (txIn.readOne(txEntry))
+    {
+        auto txSet =
+            std::make_shared<TxSetFrame>(app.getNetworkID(), txEntry.txSet);
+        // hashes are cached inside of the frames, so the main thread only
+        // has to compare them
+        txSet->getContentsHash();
+        txs.insert(txs.end(), txSet->mTransactions.begin(),
+                   txSet->mTransactions.end());
+        res->mTxSets[txEntry.ledgerSeq] = txSet;
+    }
+
+    SignaturePrechecker::precheck(app, txs);
+    return res;
+}
+
+void
+ApplyLedgerChainWork::prepareAhead()
+{
+    auto const step = mApp.getHistoryManager().getCheckpointFrequency();
+    while (mPrepared.size() < PREPARE_AHEAD && mNextPrepareSeq <= mLastSeq)
+    {
+        FileTransferInfo hi(mDownloadDir, HISTORY_FILE_TYPE_LEDGER,
+                            mNextPrepareSeq);
+        FileTransferInfo ti(mDownloadDir, HISTORY_FILE_TYPE_TRANSACTIONS,
+                            mNextPrepareSeq);
+        CLOG(DEBUG, "History") << "Preparing ledger headers from "
+                               << hi.localPath_nogz()
+                               << " and transactions from "
+                               << ti.localPath_nogz();
+
+        using task_t =
+            std::packaged_task<std::shared_ptr<PreparedCheckpoint>()>;
+        auto task = std::make_shared<task_t>(
+            std::bind(&ApplyLedgerChainWork::prepareCheckpoint,
+                      std::ref(mApp), hi.localPath_nogz(),
+                      ti.localPath_nogz(), std::ref(mPrepareTimer)));
+        mPrepared.push_back(task->get_future().share());
+        mApp.getWorkerIOService().post(std::bind(&task_t::operator(), task));
+
+        mNextPrepareSeq += step;
+    }
 }
 
 void
-ApplyLedgerChainWork::openCurrentInputFiles()
+ApplyLedgerChainWork::openCurrentCheckpoint()
 {
-    mHdrIn.close();
-    mTxIn.close();
+    mNextHeader = 0;
     if (mCurrSeq > mLastSeq)
     {
         return;
     }
-    FileTransferInfo hi(mDownloadDir, HISTORY_FILE_TYPE_LEDGER, mCurrSeq);
-    FileTransferInfo ti(mDownloadDir, HISTORY_FILE_TYPE_TRANSACTIONS, mCurrSeq);
-    CLOG(DEBUG, "History") << "Replaying ledger headers from "
-                           << hi.localPath_nogz();
-    CLOG(DEBUG, "History") << "Replaying transactions from "
-                           << ti.localPath_nogz();
-    mHdrIn.open(hi.localPath_nogz());
-    mTxIn.open(ti.localPath_nogz());
-    mTxHistoryEntry = TransactionHistoryEntry();
+
+    prepareAhead();
+    assert(!mPrepared.empty());
+    auto prepared = mPrepared.front();
+    mPrepared.pop_front();
+    {
+        auto timer = mWaitTimer.TimeScope();
+        // rethrows whatever went wrong while preparing
+        mCurrent = prepared.get();
+    }
+    prepareAhead();
 }
 
 TxSetFramePtr
-ApplyLedgerChainWork::getCurrentTxSet()
+ApplyLedgerChainWork::getCurrentTxSet(uint32_t seq)
 {
-    auto& lm = mApp.getLedgerManager();
-    auto seq = lm.getCurrentLedgerHeader().ledgerSeq;
-
-    do
+    auto it = mCurrent->mTxSets.find(seq);
+    if (it != mCurrent->mTxSets.end())
     {
-        if (mTxHistoryEntry.ledgerSeq < seq)
-        {
-            CLOG(DEBUG, "History") << "Skipping txset for ledger "
-                                   << mTxHistoryEntry.ledgerSeq;
-        }
-        else if (mTxHistoryEntry.ledgerSeq > seq)
-        {
-            break;
-        }
-        else
-        {
-            assert(mTxHistoryEntry.ledgerSeq == seq);
-            CLOG(DEBUG, "History") << "Loaded txset for ledger " << seq;
-            return std::make_shared<TxSetFrame>(mApp.getNetworkID(),
-                                                mTxHistoryEntry.txSet);
-        }
-    } while (mTxIn && mTxIn.readOne(mTxHistoryEntry));
+        CLOG(DEBUG, "History") << "Loaded txset for ledger " << seq;
+        return it->second;
+    }
 
+    auto& lm = mApp.getLedgerManager();
     CLOG(DEBUG, "History") << "Using empty txset for ledger " << seq;
     return std::make_shared<TxSetFrame>(lm.getLastClosedLedgerHeader().hash);
 }
@@ -991,14 +1139,14 @@ ApplyLedgerChainWork::getCurrentTxSet()
 bool
 ApplyLedgerChainWork::applyHistoryOfSingleLedger()
 {
-    LedgerHeaderHistoryEntry hHeader;
-    LedgerHeader& header = hHeader.header;
-
-    if (!mHdrIn || !mHdrIn.readOne(hHeader))
+    if (!mCurrent || mNextHeader >= mCurrent->mHeaders.size())
     {
         return false;
     }
 
+    auto const& hHeader = mCurrent->mHeaders[mNextHeader++];
+    LedgerHeader const& header = hHeader.header;
+
     auto& lm = mApp.getLedgerManager();
 
     LedgerHeader const& previousHeader = lm.getLastClosedLedgerHeader().header;
@@ -1051,7 +1199,7 @@ ApplyLedgerChainWork::applyHistoryOfSingleLedger()
             "replay at current ledger disagreed on LCL hash");
     }
 
-    auto txset = getCurrentTxSet();
+    auto txset = getCurrentTxSet(header.ledgerSeq);
     CLOG(DEBUG, "History") << "Ledger " << header.ledgerSeq << " has "
                            << txset->size() << " transactions";
 
@@ -1066,7 +1214,10 @@ ApplyLedgerChainWork::applyHistoryOfSingleLedger()
     }
 
     LedgerCloseData closeData(header.ledgerSeq, txset, header.scpValue);
-    lm.closeLedger(closeData);
+    {
+        auto timer = mApplyTimer.TimeScope();
+        lm.closeLedger(closeData);
+    }
 
     CLOG(DEBUG, "History") << "LedgerManager LCL:\n"
                            << xdr::xdr_to_string(
@@ -1084,7 +1235,7 @@ ApplyLedgerChainWork::applyHistoryOfSingleLedger()
 void
 ApplyLedgerChainWork::onStart()
 {
-    openCurrentInputFiles();
+    prepareAhead();
 }
 
 void
@@ -1092,10 +1243,14 @@ ApplyLedgerChainWork::onRun()
 {
     try
     {
+        if (!mCurrent)
+        {
+            openCurrentCheckpoint();
+        }
         if (!applyHistoryOfSingleLedger())
         {
             mCurrSeq += mApp.getHistoryManager().getCheckpointFrequency();
-            openCurrentInputFiles();
+            mCurrent.reset();
         }
         scheduleSuccess();
     }
@@ -1288,12 +1443,11 @@ CatchupMinimalWork::onSuccess()
         for (auto const& hash : buckets)
         {
             FileTransferInfo ft(*mDownloadDir, HISTORY_FILE_TYPE_BUCKET, hash);
-            // Each bucket gets its own work-chain of download->gunzip->verify
+            // Each bucket gets its own work-chain of download->gunzip+verify
 
             auto verify = mDownloadBucketsWork->addWork<VerifyBucketWork>(
                 mBuckets, ft.localPath_nogz(), hexToBin256(hash));
-            auto gunzip = verify->addWork<GunzipFileWork>(ft.localPath_gz());
-            gunzip->addWork<GetRemoteFileWork>(ft.remoteName(),
+            verify->addWork<GetRemoteFileWork>(ft.remoteName(),
                                                ft.localPath_gz());
         }
         return WORK_PENDING;
@@ -1570,10 +1724,13 @@ PutSnapshotFilesWork::onSuccess()
     {
         mPutFilesWork = addWork<Work>("put-files");
 
+        // snapshot files are written compressed already, buckets are
+        // compressed next to the uncompressed original
         std::vector<std::shared_ptr<FileTransferInfo>> files = {
             mSnapshot->mLedgerSnapFile, mSnapshot->mTransactionSnapFile,
             mSnapshot->mTransactionResultSnapFile,
             mSnapshot->mSCPHistorySnapFile};
+        size_t nSnapFiles = files.size();
 
         std::vector<std::string> bucketsToSend =
             mSnapshot->mLocalState.differingBuckets(mRemoteState);
@@ -1584,15 +1741,21 @@ PutSnapshotFilesWork::onSuccess()
             assert(b);
             files.push_back(std::make_shared<FileTransferInfo>(*b));
         }
-        for (auto f : files)
+        for (size_t i = 0; i < files.size(); i++)
         {
-            if (f && fs::exists(f->localPath_nogz()))
+            auto const& f = files[i];
+            bool compressed = i < nSnapFiles;
+            if (f && fs::exists(compressed ? f->localPath_gz()
+                                           : f->localPath_nogz()))
             {
                 auto put = mPutFilesWork->addWork<PutRemoteFileWork>(
                     f->localPath_gz(), f->remoteName(), mArchive);
                 auto mkdir =
                     put->addWork<MakeRemoteDirWork>(f->remoteDir(), mArchive);
-                mkdir->addWork<GzipFileWork>(f->localPath_nogz(), true);
+                if (!compressed)
+                {
+                    mkdir->addWork<GzipFileWork>(f->localPath_nogz(), true);
+                }
             }
         }
         return WORK_PENDING;
@@ -1721,11 +1884,10 @@ RepairMissingBucketsWork::onReset()
     for (auto const& hash : bucketsToFetch)
     {
         FileTransferInfo ft(*mDownloadDir, HISTORY_FILE_TYPE_BUCKET, hash);
-        // Each bucket gets its own work-chain of download->gunzip->verify
+        // Each bucket gets its own work-chain of download->gunzip+verify
         auto verify = addWork<VerifyBucketWork>(mBuckets, ft.localPath_nogz(),
                                                 hexToBin256(hash));
-        auto gunzip = verify->addWork<GunzipFileWork>(ft.localPath_gz());
-        gunzip->addWork<GetRemoteFileWork>(ft.remoteName(), ft.localPath_gz());
+        verify->addWork<GetRemoteFileWork>(ft.remoteName(), ft.localPath_gz());
     }
 }
 
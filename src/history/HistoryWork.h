@@ -12,14 +12,22 @@
 #include "bucket/BucketApplicator.h"
 #include "util/TmpDir.h"
 
+#include <deque>
+#include <future>
 #include <memory>
 #include <map>
 #include <string>
+#include <vector>
 
 /*
  * This file contains a variety of Work subclasses for the History subsystem.
  */
 
+namespace medida
+{
+class Timer;
+}
+
 namespace stellar
 {
 
@@ -84,30 +92,37 @@ class MakeRemoteDirWork : public RunCommandWork
                       std::shared_ptr<HistoryArchive const> archive);
 };
 
-class GzipFileWork : public RunCommandWork
+// Compresses and decompresses in-process (see util/Gzip.h), on the worker
+// io_service.
+class GzipFileWork : public Work
 {
     std::string mFilenameNoGz;
     bool mKeepExisting;
-    void getCommand(std::string& cmdLine, std::string& outFile) override;
 
   public:
     GzipFileWork(Application& app, WorkParent& parent,
                  std::string const& filenameNoGz, bool keepExisting = false);
     void onReset() override;
+    void onStart() override;
+    void onRun() override;
 };
 
-class GunzipFileWork : public RunCommandWork
+class GunzipFileWork : public Work
 {
     std::string mFilenameGz;
     bool mKeepExisting;
-    void getCommand(std::string& cmdLine, std::string& outFile) override;
 
   public:
     GunzipFileWork(Application& app, WorkParent& parent,
                    std::string const& filenameGz, bool keepExisting = false);
     void onReset() override;
+    void onStart() override;
+    void onRun() override;
 };
 
+// Hashes bucketFile and adopts it as a bucket if the hash matches. If
+// bucketFile.gz is present, it is decompressed into bucketFile and hashed in
+// the same pass.
 class VerifyBucketWork : public Work
 {
     std::map<std::string, std::shared_ptr<Bucket>>& mBuckets;
@@ -359,17 +374,44 @@ class VerifyLedgerChainWork : public Work
 
 class ApplyLedgerChainWork : public Work
 {
+    // Ledger headers and transaction sets of one checkpoint. They are read,
+    // decoded, hashed and have their signatures prechecked on a worker thread
+    // while earlier checkpoints are being applied.
+    struct PreparedCheckpoint
+    {
+        std::vector<LedgerHeaderHistoryEntry> mHeaders;
+        std::map<uint32_t, TxSetFramePtr> mTxSets;
+    };
+    typedef std::shared_future<std::shared_ptr<PreparedCheckpoint>>
+        PreparedCheckpointFuture;
+
+    // number of checkpoints being prepared ahead of the applied one; bounds
+    // the memory held by decoded transaction sets
+    static const size_t PREPARE_AHEAD;
+
     TmpDir const& mDownloadDir;
     uint32_t mFirstSeq;
     uint32_t mCurrSeq;
     uint32_t mLastSeq;
-    XDRInputFileStream mHdrIn;
-    XDRInputFileStream mTxIn;
-    TransactionHistoryEntry mTxHistoryEntry;
+    uint32_t mNextPrepareSeq;
+    std::deque<PreparedCheckpointFuture> mPrepared;
+    std::shared_ptr<PreparedCheckpoint> mCurrent;
+    size_t mNextHeader;
     LedgerHeaderHistoryEntry& mLastApplied;
 
-    TxSetFramePtr getCurrentTxSet();
-    void openCurrentInputFiles();
+    // per stage timings: preparing a checkpoint on a worker, waiting for it
+    // on the main thread (non-zero when preparing is the bottleneck) and
+    // applying a single ledger
+    medida::Timer& mPrepareTimer;
+    medida::Timer& mWaitTimer;
+    medida::Timer& mApplyTimer;
+
+    static std::shared_ptr<PreparedCheckpoint>
+    prepareCheckpoint(Application& app, std::string const& hdrPath,
+                      std::string const& txPath, medida::Timer& prepareTimer);
+    void prepareAhead();
+    void openCurrentCheckpoint();
+    TxSetFramePtr getCurrentTxSet(uint32_t seq);
     bool applyHistoryOfSingleLedger();
 
   public:
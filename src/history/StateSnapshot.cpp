@@ -80,10 +80,12 @@ StateSnapshot::writeHistoryBlocks() const
     size_t nHeaders;
     {
         XDROutputFileStream ledgerOut, txOut, txResultOut, scpHistory;
-        ledgerOut.open(mLedgerSnapFile->localPath_nogz());
-        txOut.open(mTransactionSnapFile->localPath_nogz());
-        txResultOut.open(mTransactionResultSnapFile->localPath_nogz());
-        scpHistory.open(mSCPHistorySnapFile->localPath_nogz());
+        // compress while streaming, so the files are ready for upload as
+        // soon as they are written
+        ledgerOut.open(mLedgerSnapFile->localPath_gz(), true);
+        txOut.open(mTransactionSnapFile->localPath_gz(), true);
+        txResultOut.open(mTransactionResultSnapFile->localPath_gz(), true);
+        scpHistory.open(mSCPHistorySnapFile->localPath_gz(), true);
 
         // 'mLocalState' describes the LCL, so its currentLedger will usually be
         // 63,
@@ -103,24 +105,38 @@ StateSnapshot::writeHistoryBlocks() const
             mApp.getNetworkID(), mApp.getDatabase(), sess, begin, count, txOut,
             txResultOut);
         CLOG(DEBUG, "History") << "Wrote " << nHeaders << " ledger headers to "
-                               << mLedgerSnapFile->localPath_nogz();
+                               << mLedgerSnapFile->localPath_gz();
         CLOG(DEBUG, "History") << "Wrote " << nTxs << " transactions to "
-                               << mTransactionSnapFile->localPath_nogz()
+                               << mTransactionSnapFile->localPath_gz()
                                << " and "
-                               << mTransactionResultSnapFile->localPath_nogz();
+                               << mTransactionResultSnapFile->localPath_gz();
 
         nbSCPMessages = Herder::copySCPHistoryToStream(
             mApp.getDatabase(), sess, begin, count, scpHistory);
 
         CLOG(DEBUG, "History") << "Wrote " << nbSCPMessages
                                << " SCP messages to "
-                               << mSCPHistorySnapFile->localPath_nogz();
+                               << mSCPHistorySnapFile->localPath_gz();
+
+        // the gzip trailers are only written on close, a file that failed to
+        // close (full disk, ...) must not be published
+        ledgerOut.close();
+        txOut.close();
+        txResultOut.close();
+        scpHistory.close();
+        if (!ledgerOut || !txOut || !txResultOut || !scpHistory)
+        {
+            CLOG(WARNING, "History")
+                << "Failed to write history files for ledgers from " << begin
+                << ", will retry";
+            return false;
+        }
     }
 
     if (nbSCPMessages == 0)
     {
         // don't upload empty files
-        std::remove(mSCPHistorySnapFile->localPath_nogz().c_str());
+        std::remove(mSCPHistorySnapFile->localPath_gz().c_str());
     }
 
     // When writing checkpoint 0x3f (63) we will have written 63 headers because
@@ -137,7 +153,7 @@ StateSnapshot::writeHistoryBlocks() const
     {
         CLOG(WARNING, "History")
             << "Only wrote " << nHeaders << " ledger headers for "
-            << mLedgerSnapFile->localPath_nogz() << ", expecting " << count
+            << mLedgerSnapFile->localPath_gz() << ", expecting " << count
             << ", will retry";
         return false;
     }
@@ -6,6 +6,7 @@
 #include "ledger/AccountTypeLimitsFrame.h"
 
 #include "LedgerDelta.h"
+#include "ledger/LedgerOverlay.h"
 #include "util/basen.h"
 #include "util/types.h"
 #include "lib/util/format.h"
@@ -21,7 +22,6 @@ namespace stellar
 	AccountHelper::storeUpdate(LedgerDelta& delta, Database& db, bool insert, LedgerEntry const& entry)
 	{
 		auto accountFrame = make_shared<AccountFrame>(entry);
-		auto accountEntry = accountFrame->getAccount();
 
 		bool isValid = accountFrame->isValid();
 		assert(isValid);
@@ -31,6 +31,29 @@ namespace stellar
 		LedgerKey const& key = accountFrame->getKey();
 		flushCachedEntry(key, db);
 
+		// while a ledger closes the account is written once, by the overlay
+		if (!db.getLedgerOverlay().defers(&delta, LedgerEntryType::ACCOUNT))
+		{
+			writeAccount(db, insert, accountFrame->mEntry,
+				accountFrame->getUpdateSigners());
+		}
+
+		if (insert)
+		{
+			delta.addEntry(*accountFrame);
+		}
+		else
+		{
+			delta.modEntry(*accountFrame);
+		}
+	}
+
+	void
+	AccountHelper::writeAccount(Database& db, bool insert, LedgerEntry const& entry, bool updateSigners)
+	{
+		auto accountFrame = make_shared<AccountFrame>(entry);
+		auto accountEntry = accountFrame->getAccount();
+
 		std::string actIDStrKey = PubKeyUtils::toStrKey(accountFrame->getID());
         std::string recIdStrKey = PubKeyUtils::toStrKey(accountFrame->getRecoveryID());
 		std::string refIDStrKey = "";
@@ -99,20 +122,11 @@ namespace stellar
 			{
 				throw std::runtime_error("Could not update data in SQL");
 			}
-			if (insert)
-			{
-				delta.addEntry(*accountFrame);
-			}
-			else
-			{
-				delta.modEntry(*accountFrame);
-			}
 		}
 
-		bool updateSigners = accountFrame->getUpdateSigners();
 		if (updateSigners)
 		{
-			applySigners(db, insert, delta, accountFrame->mEntry);
+			applySigners(db, insert, entry);
 		}
 	}
 
@@ -155,7 +169,7 @@ namespace stellar
 	}
 
 	void
-	AccountHelper::applySigners(Database& db, bool insert, LedgerDelta& delta, LedgerEntry const& entry)
+	AccountHelper::applySigners(Database& db, bool insert, LedgerEntry const& entry)
 	{
 		AccountFrame::pointer account = std::make_shared<AccountFrame>(entry);
 		AccountEntry& accountEntry = account->getAccount();
@@ -199,7 +213,7 @@ namespace stellar
 
 			// add new
 			if (added) {
-				signerStoreChange(db, delta, actIDStrKey, it_new, true);
+				signerStoreChange(db, actIDStrKey, it_new, true);
 				changed = true;
 				it_new++;
 				continue;
@@ -208,7 +222,7 @@ namespace stellar
 			// updated
 			if (!(*it_new == *it_old))
 			{
-				signerStoreChange(db, delta, actIDStrKey, it_new, false);
+				signerStoreChange(db, actIDStrKey, it_new, false);
 				changed = true;
 			}
 			it_new++;
@@ -244,7 +258,7 @@ namespace stellar
 		}
 	}
 
-	void AccountHelper::signerStoreChange(Database& db, LedgerDelta& delta, std::string const& accountID, std::vector<Signer>::iterator const& signer, bool insert) {
+	void AccountHelper::signerStoreChange(Database& db, std::string const& accountID, std::vector<Signer>::iterator const& signer, bool insert) {
 		int32_t signerVersion = static_cast<int32_t >(signer->ext.v());
 		std::string newSignerName = signer->name;
 
@@ -283,6 +297,157 @@ namespace stellar
 			throw std::runtime_error("Could not update data in SQL");
 		}
 	}
+	void
+	AccountHelper::storeUpsertMany(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries)
+	{
+		static const std::vector<std::string> columns = {
+			"accountid", "recoveryid", "thresholds", "lastmodified", "account_type", "account_role",
+			"block_reasons", "referrer", "policies", "kyc_level", "version"};
+
+		for (size_t begin = 0; begin < entries.size(); begin += MAX_ENTRIES_PER_UPSERT)
+		{
+			auto const end = min(entries.size(), begin + MAX_ENTRIES_PER_UPSERT);
+			auto const rows = end - begin;
+
+			// bound values have to stay in place until the statement is run
+			std::vector<std::string> accountIDs, recoveryIDs, thresholds, referrers;
+			std::vector<int32_t> accountTypes, policies, versions;
+			std::vector<uint32> kycLevels;
+			std::vector<uint64> roles;
+			std::vector<indicator> roleIndicators;
+			accountIDs.reserve(rows);
+			recoveryIDs.reserve(rows);
+			thresholds.reserve(rows);
+			referrers.reserve(rows);
+			accountTypes.reserve(rows);
+			policies.reserve(rows);
+			versions.reserve(rows);
+			kycLevels.reserve(rows);
+			roles.reserve(rows);
+			roleIndicators.reserve(rows);
+
+			auto prep = db.getPreparedStatement(upsertStatement(db, "accounts", columns, "accountid", rows));
+			auto& st = prep.statement();
+			for (auto i = begin; i < end; i++)
+			{
+				AccountFrame accountFrame(entries[i]);
+				bool isValid = accountFrame.isValid();
+				assert(isValid);
+				flushCachedEntry(accountFrame.getKey(), db);
+
+				auto const& accountEntry = entries[i].data.account();
+				accountIDs.push_back(PubKeyUtils::toStrKey(accountEntry.accountID));
+				recoveryIDs.push_back(PubKeyUtils::toStrKey(accountEntry.recoveryID));
+				thresholds.push_back(bn::encode_b64(accountEntry.thresholds));
+				referrers.push_back(accountEntry.referrer ? PubKeyUtils::toStrKey(*accountEntry.referrer) : "");
+				accountTypes.push_back(static_cast<int32_t>(accountEntry.accountType));
+				policies.push_back(accountFrame.getPolicies());
+				kycLevels.push_back(accountFrame.getKYCLevel());
+				versions.push_back(static_cast<int32_t>(accountEntry.ext.v()));
+				auto role = accountFrame.getAccountRole();
+				roles.push_back(role ? *role : 0);
+				roleIndicators.push_back(role ? indicator::i_ok : indicator::i_null);
+
+				st.exchange(use(accountIDs.back()));
+				st.exchange(use(recoveryIDs.back()));
+				st.exchange(use(thresholds.back()));
+				st.exchange(use(entries[i].lastModifiedLedgerSeq));
+				st.exchange(use(accountTypes.back()));
+				st.exchange(use(roles.back(), roleIndicators.back()));
+				st.exchange(use(accountEntry.blockReasons));
+				st.exchange(use(referrers.back()));
+				st.exchange(use(policies.back()));
+				st.exchange(use(kycLevels.back()));
+				st.exchange(use(versions.back()));
+			}
+			st.define_and_bind();
+			{
+				auto timer = db.getInsertTimer("account");
+				st.execute(true);
+			}
+
+			if (st.get_affected_rows() != static_cast<long long>(rows))
+			{
+				throw std::runtime_error("Could not update data in SQL");
+			}
+
+			replaceSigners(db, &entries[begin], accountIDs);
+		}
+	}
+
+	void
+	AccountHelper::replaceSigners(Database& db, LedgerEntry const* accounts, std::vector<std::string> const& accountIDs)
+	{
+		{
+			auto prep = db.getPreparedStatement("DELETE FROM signers WHERE accountid IN " +
+			                                    inPlaceholders(accountIDs.size()));
+			auto& st = prep.statement();
+			for (auto const& accountID : accountIDs)
+			{
+				st.exchange(use(accountID));
+			}
+			st.define_and_bind();
+			auto timer = db.getDeleteTimer("signer");
+			st.execute(true);
+		}
+
+		struct SignerRow
+		{
+			std::string const* mAccountID;
+			Signer const* mSigner;
+		};
+		std::vector<SignerRow> signers;
+		for (size_t i = 0; i < accountIDs.size(); i++)
+		{
+			for (auto const& signer : accounts[i].data.account().signers)
+			{
+				signers.push_back({&accountIDs[i], &signer});
+			}
+		}
+
+		for (size_t begin = 0; begin < signers.size(); begin += MAX_ENTRIES_PER_UPSERT)
+		{
+			auto const end = min(signers.size(), begin + MAX_ENTRIES_PER_UPSERT);
+			auto const rows = end - begin;
+
+			std::vector<std::string> pubKeys, names;
+			std::vector<int32_t> versions;
+			pubKeys.reserve(rows);
+			names.reserve(rows);
+			versions.reserve(rows);
+
+			auto prep = db.getPreparedStatement(
+				"INSERT INTO signers (accountid, publickey, weight, signer_type,"
+				" identity_id, signer_name, version) VALUES " + valuesPlaceholders(rows, 7));
+			auto& st = prep.statement();
+			for (auto i = begin; i < end; i++)
+			{
+				auto const& signer = *signers[i].mSigner;
+				pubKeys.push_back(PubKeyUtils::toStrKey(signer.pubKey));
+				names.push_back(signer.name);
+				versions.push_back(static_cast<int32_t>(signer.ext.v()));
+
+				st.exchange(use(*signers[i].mAccountID));
+				st.exchange(use(pubKeys.back()));
+				st.exchange(use(signer.weight));
+				st.exchange(use(signer.signerType));
+				st.exchange(use(signer.identity));
+				st.exchange(use(names.back()));
+				st.exchange(use(versions.back()));
+			}
+			st.define_and_bind();
+			{
+				auto timer = db.getInsertTimer("signer");
+				st.execute(true);
+			}
+
+			if (st.get_affected_rows() != static_cast<long long>(rows))
+			{
+				throw std::runtime_error("Could not update data in SQL");
+			}
+		}
+	}
+
 	void
 		AccountHelper::addKYCLevel(Database & db) {
 		db.getSession() << "ALTER TABLE accounts ADD kyc_level INT DEFAULT 0";
@@ -343,6 +508,16 @@ namespace stellar
 	{
 		flushCachedEntry(key, db);
 
+		if (!db.getLedgerOverlay().defers(&delta, LedgerEntryType::ACCOUNT))
+		{
+			deleteAccount(db, key);
+		}
+		delta.deleteEntry(key);
+	}
+
+	void
+	AccountHelper::deleteAccount(Database& db, LedgerKey const& key)
+	{
 		std::string actIDStrKey = PubKeyUtils::toStrKey(key.account().accountID);
 		{
 			auto timer = db.getDeleteTimer("account");
@@ -363,12 +538,17 @@ namespace stellar
 			st.define_and_bind();
 			st.execute(true);
 		}
-		delta.deleteEntry(key);
 	}
 
 	bool
 	AccountHelper::exists(Database& db, LedgerKey const& key)
 	{
+		EntryFrame::pointer pending;
+		if (db.getLedgerOverlay().find(key, pending))
+		{
+			return !!pending;
+		}
+
 		if (cachedEntryExists(key, db) && getCachedEntry(key, db) != nullptr)
 		{
 			return true;
@@ -411,6 +591,12 @@ namespace stellar
 		LedgerKey key;
 		key.type(LedgerEntryType::ACCOUNT);
 		key.account().accountID = accountID;
+		EntryFrame::pointer pending;
+		if (db.getLedgerOverlay().find(key, pending))
+		{
+			return pending ? std::make_shared<AccountFrame>(pending->mEntry) : nullptr;
+		}
+
 		if (cachedEntryExists(key, db))
 		{
 			auto p = getCachedEntry(key, db);
@@ -565,6 +751,15 @@ namespace stellar
 	}
 
 	bool AccountHelper::exists(AccountID const &rawAccountID, Database &db) {
+		LedgerKey key;
+		key.type(LedgerEntryType::ACCOUNT);
+		key.account().accountID = rawAccountID;
+		EntryFrame::pointer pending;
+		if (db.getLedgerOverlay().find(key, pending))
+		{
+			return !!pending;
+		}
+
 		int exists = 0;
 		{
 			auto timer = db.getSelectTimer("account-exists");
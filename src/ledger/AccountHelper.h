@@ -47,6 +47,7 @@ namespace stellar
 		EntryFrame::pointer storeLoad(LedgerKey const& key, Database& db) override;
 		EntryFrame::pointer fromXDR(LedgerEntry const& from) override;
 		uint64_t countObjects(soci::session& sess) override;
+		void storeUpsertMany(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries) override;
 
 		AccountFrame::pointer loadAccount(AccountID const& accountID, Database& db, LedgerDelta* delta = nullptr);
 
@@ -54,6 +55,11 @@ namespace stellar
 
 		AccountFrame::pointer mustLoadAccount(AccountID const& accountID, Database& db);
 
+		// SQL side of storeAdd/storeChange and storeDelete, also used by
+		// LedgerOverlay::flush; signers are written if `updateSigners` is set
+		void writeAccount(Database& db, bool insert, LedgerEntry const& entry, bool updateSigners);
+		void deleteAccount(Database& db, LedgerKey const& key);
+
 		// loads all accounts from database and checks for consistency (slow!)
 		std::unordered_map<AccountID, AccountFrame::pointer> checkDB(Database& db);
 
@@ -65,9 +71,12 @@ namespace stellar
 
 		// work with signers
 		std::vector<Signer> loadSigners(Database& db, std::string const& actIDStrKey);
-		void applySigners(Database& db, bool insert, LedgerDelta& delta, LedgerEntry const& entry);
+		void applySigners(Database& db, bool insert, LedgerEntry const& entry);
 		void deleteSigner(Database& db, std::string const& accountID, AccountID const& pubKey);
-		void signerStoreChange(Database& db, LedgerDelta& delta, std::string const& accountID, std::vector<Signer>::iterator const& signer, bool insert);
+		void signerStoreChange(Database& db, std::string const& accountID, std::vector<Signer>::iterator const& signer, bool insert);
+		// replaces the stored signers of the accounts in `accountIDs` with
+		// the ones of the matching entries, starting at `accounts`
+		void replaceSigners(Database& db, LedgerEntry const* accounts, std::vector<std::string> const& accountIDs);
 	};
 
 
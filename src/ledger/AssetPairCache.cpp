@@ -0,0 +1,42 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/AssetPairCache.h"
+
+namespace stellar
+{
+
+bool
+AssetPairCache::find(AssetCode const& code1, AssetCode const& code2,
+                     PairPtr& result) const
+{
+    auto it = mLookups.find(std::make_pair(std::string(code1), std::string(code2)));
+    if (it == mLookups.end())
+    {
+        return false;
+    }
+
+    result = it->second;
+    return true;
+}
+
+void
+AssetPairCache::put(AssetCode const& code1, AssetCode const& code2,
+                    PairPtr const& pair)
+{
+    mLookups[std::make_pair(std::string(code1), std::string(code2))] = pair;
+}
+
+void
+AssetPairCache::clear()
+{
+    mLookups.clear();
+}
+
+size_t
+AssetPairCache::size() const
+{
+    return mLookups.size();
+}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/AssetPairFrame.h"
+#include "util/NonCopyable.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace stellar
+{
+
+/**
+ * Results of AssetPairHelper::findAssetPairForAssets for the ledger being
+ * closed, keyed by the (code1, code2) of the lookup; lookups that found no
+ * pair are kept too.
+ *
+ * Limits, statistics, sale caps and cross asset fees look the same few pairs
+ * up for every operation, each time probing both orientations in the entry
+ * cache and copying the entry out. A hit here costs one map lookup and hands
+ * out the shared, immutable frame.
+ *
+ * LedgerManager clears the cache whenever a ledger starts closing;
+ * AssetPairHelper clears it on every write to asset_pair and LedgerDelta
+ * when changes to asset pairs are rolled back.
+ */
+class AssetPairCache : NonMovableOrCopyable
+{
+  public:
+    typedef std::shared_ptr<AssetPairFrame const> PairPtr;
+
+    // Returns true if the lookup of code1/code2 is cached, `result` is then
+    // set to the pair found or to nullptr if there is none.
+    bool find(AssetCode const& code1, AssetCode const& code2,
+              PairPtr& result) const;
+
+    void put(AssetCode const& code1, AssetCode const& code2,
+             PairPtr const& pair);
+
+    void clear();
+
+    size_t size() const;
+
+  private:
+    std::map<std::pair<std::string, std::string>, PairPtr> mLookups;
+};
+}
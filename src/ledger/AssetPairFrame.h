@@ -52,15 +52,15 @@ class AssetPairFrame : public EntryFrame
         return mAssetPair;
     }
 
-	AssetCode getBaseAsset() {
+	AssetCode getBaseAsset() const {
 		return mAssetPair.base;
 	}
 
-	AssetCode getQuoteAsset() {
+	AssetCode getQuoteAsset() const {
 		return mAssetPair.quote;
 	}
 
-	int64_t getCurrentPrice()
+	int64_t getCurrentPrice() const
 	{
 		return mAssetPair.currentPrice;
 	}
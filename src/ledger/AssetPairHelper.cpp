@@ -28,6 +28,7 @@ namespace stellar
 	void
 	AssetPairHelper::dropAll(Database& db)
 	{
+		db.getAssetPairCache().clear();
 		db.getSession() << "DROP TABLE IF EXISTS asset_pair;";
 		db.getSession() << "CREATE TABLE asset_pair"
 			"("
@@ -60,6 +61,7 @@ namespace stellar
 
 		auto key = assetPairFrame->getKey();
 		flushCachedEntry(key, db);
+		db.getAssetPairCache().clear();
 		string sql;
 
 		if (insert)
@@ -130,6 +132,7 @@ namespace stellar
 	AssetPairHelper::storeDelete(LedgerDelta& delta, Database& db, LedgerKey const& key)
 	{
 		flushCachedEntry(key, db);
+		db.getAssetPairCache().clear();
 		auto timer = db.getDeleteTimer("AssetPair");
 		auto prep = db.getPreparedStatement("DELETE FROM asset_pair WHERE base=:base AND quote=:quote");
 		auto& st = prep.statement();
@@ -272,13 +275,39 @@ namespace stellar
 AssetPairFrame::pointer AssetPairHelper::tryLoadAssetPairForAssets(
     const AssetCode code1, const AssetCode code2, Database& db, LedgerDelta* delta)
 {
-    auto assetPair = loadAssetPair(code1, code2, db, delta);
-    if (!!assetPair)
+    auto cached = findAssetPairForAssets(code1, code2, db);
+    if (!cached)
     {
-        return assetPair;
+        return nullptr;
     }
 
-    return loadAssetPair(code2, code1, db, delta);
+    auto assetPair = make_shared<AssetPairFrame>(cached->mEntry);
+    if (delta)
+    {
+        delta->recordEntry(*assetPair);
+    }
+    return assetPair;
+}
+
+AssetPairCache::PairPtr AssetPairHelper::findAssetPairForAssets(
+    AssetCode const& code1, AssetCode const& code2, Database& db)
+{
+    auto& cache = db.getAssetPairCache();
+    AssetPairCache::PairPtr result;
+    if (cache.find(code1, code2, result))
+    {
+        return result;
+    }
+
+    auto assetPair = loadAssetPair(code1, code2, db);
+    if (!assetPair)
+    {
+        assetPair = loadAssetPair(code2, code1, db);
+    }
+
+    result = assetPair;
+    cache.put(code1, code2, result);
+    return result;
 }
 
 	void AssetPairHelper::loadAssetPairsByQuote(AssetCode quoteAsset, Database& db, std::vector<AssetPairFrame::pointer>& retAssetPairs)
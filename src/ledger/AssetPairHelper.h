@@ -9,6 +9,7 @@
 #include <functional>
 #include <unordered_map>
 #include "AssetPairFrame.h"
+#include "AssetPairCache.h"
 
 namespace soci
 {
@@ -55,6 +56,10 @@ namespace stellar
                 // tryLoadAssetPairForAssets - tries to load code1/code2 asset pair, if not found loads code2/code1 
                 AssetPairFrame::pointer tryLoadAssetPairForAssets(AssetCode code1, AssetCode code2, Database& db, LedgerDelta * delta = nullptr);
 
+		// findAssetPairForAssets - same lookup as tryLoadAssetPairForAssets, served from
+		// Database::getAssetPairCache for the rest of the ledger; for callers that only read the pair
+		AssetPairCache::PairPtr findAssetPairForAssets(AssetCode const& code1, AssetCode const& code2, Database& db);
+
 		void loadAssetPairsByQuote(AssetCode quoteAsset, Database& db, std::vector<AssetPairFrame::pointer>& retAssetPairs);
 
 	private:
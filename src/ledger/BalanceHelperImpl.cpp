@@ -1,7 +1,11 @@
 #include "BalanceHelperImpl.h"
+#include "ledger/BalanceHelperLegacy.h"
 #include "ledger/LedgerDelta.h"
+#include "ledger/LedgerOverlay.h"
 #include "ledger/StorageHelper.h"
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <xdrpp/marshal.h>
 #include "util/basen.h"
 
@@ -58,27 +62,30 @@ BalanceHelperImpl::storeDelete(LedgerKey const& key)
     flushCachedEntry(key);
 
     Database& db = getDatabase();
-    auto timer = db.getDeleteTimer("delete-balance");
-    auto prep =
-            db.getPreparedStatement("DELETE FROM balance WHERE balance_id=:id");
-    auto& st = prep.statement();
-    auto balanceIDStr = BalanceKeyUtils::toStrKey(key.balance().balanceID);
-    st.exchange(use(balanceIDStr, "id"));
-    st.define_and_bind();
-    st.execute(true);
-    mStorageHelper.getLedgerDelta()->deleteEntry(key);
+    LedgerDelta* delta = mStorageHelper.getLedgerDelta();
+    if (!db.getLedgerOverlay().defers(delta, LedgerEntryType::BALANCE))
+    {
+        BalanceHelperLegacy::Instance()->deleteBalance(db, key);
+    }
+    delta->deleteEntry(key);
 }
 
 bool
 BalanceHelperImpl::exists(LedgerKey const& key)
 {
+    Database& db = getDatabase();
+    EntryFrame::pointer pending;
+    if (db.getLedgerOverlay().find(key, pending))
+    {
+        return !!pending;
+    }
+
     if (cachedEntryExists(key))
     {
         return true;
     }
     int exists = 0;
 
-    Database& db = getDatabase();
     auto timer = db.getSelectTimer("balance-exists");
     auto prep = db.getPreparedStatement("SELECT EXISTS "
                         "(SELECT NULL FROM balance WHERE balance_id=:id)");
@@ -99,13 +106,13 @@ BalanceHelperImpl::storeUpdateHelper(bool insert, LedgerEntry const& entry)
     LedgerDelta* delta = mStorageHelper.getLedgerDelta();
 
     auto balanceFrame = make_shared<BalanceFrame>(entry);
-    auto balanceEntry = balanceFrame->getBalance();
 
     if (delta)
     {
         balanceFrame->touch(*delta);
     }
-    putCachedEntry(getLedgerKey(entry), make_shared<LedgerEntry>(entry));
+    putCachedEntry(getLedgerKey(entry),
+                   make_shared<LedgerEntry>(balanceFrame->mEntry));
 
     bool isValid = balanceFrame->isValid();
     if (!isValid)
@@ -113,47 +120,11 @@ BalanceHelperImpl::storeUpdateHelper(bool insert, LedgerEntry const& entry)
         throw std::runtime_error("Invalid balance");
     }
 
-    std::string accountID = PubKeyUtils::toStrKey(balanceFrame->getAccountID());
-    std::string balanceID =
-            BalanceKeyUtils::toStrKey(balanceFrame->getBalanceID());
-    std::string asset = balanceFrame->getAsset();
-    int32_t version = static_cast<int32_t>(balanceEntry.ext.v());
-
-    string sql;
-
-    if (insert)
+    // while a ledger closes the balance is written once, by the overlay
+    if (!db.getLedgerOverlay().defers(delta, LedgerEntryType::BALANCE))
     {
-        sql = "INSERT INTO balance (balance_id, asset, amount, locked, "
-              "                     account_id, lastmodified, version) "
-              "VALUES (:id, :as, :am, :ld, :aid, :lm, :v)";
-    }
-    else
-    {
-        sql = "UPDATE balance "
-              "SET    asset = :as, amount=:am, locked=:ld, account_id=:aid, "
-              "lastmodified=:lm, version=:v "
-              "WHERE  balance_id = :id";
-    }
-
-    auto prep = db.getPreparedStatement(sql);
-    auto& st = prep.statement();
-
-    st.exchange(use(balanceID, "id"));
-    st.exchange(use(asset, "as"));
-    st.exchange(use(balanceEntry.amount, "am"));
-    st.exchange(use(balanceEntry.locked, "ld"));
-    st.exchange(use(accountID, "aid"));
-    st.exchange(use(balanceFrame->mEntry.lastModifiedLedgerSeq, "lm"));
-    st.exchange(use(version, "v"));
-    st.define_and_bind();
-
-    auto timer = insert ? db.getInsertTimer("insert-balance")
-                        : db.getUpdateTimer("update-balance");
-    st.execute(true);
-
-    if (st.get_affected_rows() != 1)
-    {
-        throw std::runtime_error("could not update SQL");
+        BalanceHelperLegacy::Instance()->writeBalance(db, insert,
+                                                      balanceFrame->mEntry);
     }
 
     if (delta)
@@ -184,6 +155,13 @@ BalanceHelperImpl::storeLoad(LedgerKey const& key)
     return loadBalance(key.balance().balanceID);
 }
 
+std::vector<EntryFrame::pointer>
+BalanceHelperImpl::loadMany(std::vector<LedgerKey> const& keys)
+{
+    // both helpers share the entry cache the batch is loaded into
+    return BalanceHelperLegacy::Instance()->loadMany(keys, getDatabase());
+}
+
 EntryFrame::pointer
 BalanceHelperImpl::fromXDR(LedgerEntry const& from)
 {
@@ -204,14 +182,30 @@ BalanceHelperImpl::loadBalance(BalanceID balanceID)
     LedgerKey key;
     key.type(LedgerEntryType::BALANCE);
     key.balance().balanceID = balanceID;
+
+    Database& db = getDatabase();
+    EntryFrame::pointer pending;
+    if (db.getLedgerOverlay().find(key, pending))
+    {
+        if (!pending)
+        {
+            return nullptr;
+        }
+
+        auto balance = make_shared<BalanceFrame>(pending->mEntry);
+        if (mStorageHelper.getLedgerDelta())
+        {
+            mStorageHelper.getLedgerDelta()->recordEntry(*balance);
+        }
+        return balance;
+    }
+
     if (cachedEntryExists(key))
     {
         auto entry = getCachedEntry(key);
         return entry ? std::make_shared<BalanceFrame>(*entry) : nullptr;
     }
 
-    Database& db = getDatabase();
-
     auto balIDStrKey = BalanceKeyUtils::toStrKey(balanceID);
 
     std::string sql = mBalanceColumnSelector;
@@ -277,7 +271,10 @@ BalanceHelperImpl::loadBalance(AccountID accountID, AssetCode assetCode)
     auto timer = db.getSelectTimer("load-balances");
 
     BalanceFrame::pointer retBalance;
-    loadBalances(prep, [&retBalance](LedgerEntry const &entry)
+    loadBalances(prep, [&](BalanceEntry const& balance)
+    {
+        return balance.asset == assetCode && balance.accountID == accountID;
+    }, [&retBalance](LedgerEntry const &entry)
     {
         retBalance = make_shared<BalanceFrame>(entry);
     });
@@ -315,7 +312,10 @@ BalanceHelperImpl::loadBalances(AccountID accountID, AssetCode assetCode)
     auto timer = db.getSelectTimer("load-balances");
 
     std::vector<BalanceFrame::pointer> retBalances;
-    loadBalances(prep, [&retBalances](LedgerEntry const &entry)
+    loadBalances(prep, [&](BalanceEntry const& balance)
+    {
+        return balance.asset == assetCode && balance.accountID == accountID;
+    }, [&retBalances](LedgerEntry const &entry)
     {
         retBalances.emplace_back(make_shared<BalanceFrame>(entry));
     });
@@ -334,11 +334,9 @@ BalanceHelperImpl::loadBalances(vector<AccountID> accountIDs,
 
     Database& db = getDatabase();
 
-    string sql = "SELECT DISTINCT ON (account_id) balance_id, asset, "
-                 "amount, locked, account_id, lastmodified, version "
-                 "FROM balance "
-                 "WHERE asset = :asset AND account_id IN (" +
-                 obtainStrAccountIDs(accountIDs) + ")";
+    string sql = mBalanceColumnSelector;
+    sql += " WHERE asset = :asset AND account_id IN (" +
+           obtainStrAccountIDs(accountIDs) + ")";
 
     auto prep = db.getPreparedStatement(sql);
     auto &st = prep.statement();
@@ -346,10 +344,20 @@ BalanceHelperImpl::loadBalances(vector<AccountID> accountIDs,
 
     auto timer = db.getSelectTimer("load-balances");
 
+    // one balance per account, like DISTINCT ON (account_id) did
+    set<AccountID> seen;
     vector<BalanceFrame::pointer> result;
-    loadBalances(prep, [&result](LedgerEntry const &entry)
+    loadBalances(prep, [&](BalanceEntry const& balance)
     {
-        result.emplace_back(make_shared<BalanceFrame>(entry));
+        return balance.asset == assetCode &&
+               find(accountIDs.begin(), accountIDs.end(),
+                    balance.accountID) != accountIDs.end();
+    }, [&](LedgerEntry const &entry)
+    {
+        if (seen.insert(entry.data.balance().accountID).second)
+        {
+            result.emplace_back(make_shared<BalanceFrame>(entry));
+        }
     });
 
     return result;
@@ -376,7 +384,11 @@ BalanceHelperImpl::loadAssetHolders(AssetCode assetCode, AccountID owner,
     auto timer = db.getSelectTimer("balance");
 
     std::vector<BalanceFrame::pointer> holders;
-    loadBalances(prep, [&holders](LedgerEntry const &entry)
+    loadBalances(prep, [&](BalanceEntry const& balance)
+    {
+        return balance.asset == assetCode && !(balance.accountID == owner) &&
+               uint64_t(balance.amount) + balance.locked >= minTotalAmount;
+    }, [&holders](LedgerEntry const &entry)
     {
         auto balanceFrame = make_shared<BalanceFrame>(entry);
         if (balanceFrame->getTotal() > 0)
@@ -427,6 +439,23 @@ BalanceHelperImpl::loadBalances(StatementContext& prep,
     }
 }
 
+void
+BalanceHelperImpl::loadBalances(StatementContext& prep,
+                   function<bool(BalanceEntry const&)> const& matches,
+                   function<void(LedgerEntry const&)> balanceProcessor)
+{
+    getDatabase().getLedgerOverlay().merge(LedgerEntryType::BALANCE,
+        [&](LedgerOverlay::EntryProcessor const& processor)
+        {
+            loadBalances(prep, processor);
+        },
+        [&matches](LedgerEntry const& balance)
+        {
+            return matches(balance.data.balance());
+        },
+        balanceProcessor);
+}
+
 Database&
 BalanceHelperImpl::getDatabase()
 {
@@ -41,6 +41,9 @@ private:
     EntryFrame::pointer
     storeLoad(LedgerKey const& key) override;
 
+    std::vector<EntryFrame::pointer>
+    loadMany(std::vector<LedgerKey> const& keys) override;
+
     EntryFrame::pointer
     fromXDR(LedgerEntry const& from) override;
 
@@ -71,6 +74,13 @@ private:
     loadBalances(StatementContext& prep,
             std::function<void(LedgerEntry const&)> balanceProcessor) override;
 
+    // loads through the ledger overlay, `matches` has to mirror the WHERE
+    // clause of `prep`, see LedgerOverlay::merge
+    void
+    loadBalances(StatementContext& prep,
+            std::function<bool(BalanceEntry const&)> const& matches,
+            std::function<void(LedgerEntry const&)> balanceProcessor);
+
     void
     storeUpdateHelper(bool insert, LedgerEntry const& entry);
 
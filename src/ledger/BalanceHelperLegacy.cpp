@@ -3,11 +3,13 @@
 #include "database/Database.h"
 #include "LedgerDelta.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/LedgerOverlay.h"
 #include "util/basen.h"
 #include "util/types.h"
 #include "lib/util/format.h"
 #include "BalanceHelperLegacy.h"
 #include <algorithm>
+#include <set>
 
 using namespace soci;
 using namespace std;
@@ -20,6 +22,31 @@ static const char* balanceColumnSelector =
         "SELECT balance_id, asset, amount, locked, account_id, lastmodified, version "
         "FROM balance";
 
+static LedgerKey
+balanceKey(BalanceID const& balanceID)
+{
+    LedgerKey key;
+    key.type(LedgerEntryType::BALANCE);
+    key.balance().balanceID = balanceID;
+    return key;
+}
+
+// Returns true if the balance has pending changes in the ledger overlay,
+// `balance` is then set to a copy of it or to nullptr if it was deleted.
+static bool
+findPending(Database& db, BalanceID const& balanceID,
+            BalanceFrame::pointer& balance)
+{
+    EntryFrame::pointer pending;
+    if (!db.getLedgerOverlay().find(balanceKey(balanceID), pending))
+    {
+        return false;
+    }
+
+    balance = pending ? make_shared<BalanceFrame>(pending->mEntry) : nullptr;
+    return true;
+}
+
 void
 BalanceHelperLegacy::dropAll(Database& db)
 {
@@ -37,14 +64,21 @@ BalanceHelperLegacy::dropAll(Database& db)
            ");";
 }
 
+void
+BalanceHelperLegacy::addAccountIndex(Database& db)
+{
+    db.getSession() << "CREATE INDEX balance_account_asset ON balance "
+                       "(account_id, asset)";
+}
+
 void
 BalanceHelperLegacy::storeUpdateHelper(LedgerDelta& delta, Database& db,
                                        bool insert, LedgerEntry const& entry)
 {
     auto balanceFrame = make_shared<BalanceFrame>(entry);
-    auto balanceEntry = balanceFrame->getBalance();
 
     balanceFrame->touch(delta);
+    flushCachedEntry(balanceFrame->getKey(), db);
 
     bool isValid = balanceFrame->isValid();
     if (!isValid)
@@ -52,10 +86,32 @@ BalanceHelperLegacy::storeUpdateHelper(LedgerDelta& delta, Database& db,
         throw std::runtime_error("Invalid balance");
     }
 
-    std::string accountID = PubKeyUtils::toStrKey(balanceFrame->getAccountID());
-    std::string balanceID = BalanceKeyUtils::toStrKey(balanceFrame->getBalanceID());
-    std::string asset = balanceFrame->getAsset();
-    int32_t balanceVersion = static_cast<int32_t >(balanceFrame->getBalance().ext.v());
+    // while a ledger closes the balance is written once, by the overlay
+    if (!db.getLedgerOverlay().defers(&delta, LedgerEntryType::BALANCE))
+    {
+        writeBalance(db, insert, balanceFrame->mEntry);
+    }
+
+    if (insert)
+    {
+        delta.addEntry(*balanceFrame);
+    }
+    else
+    {
+        delta.modEntry(*balanceFrame);
+    }
+}
+
+void
+BalanceHelperLegacy::writeBalance(Database& db, bool insert,
+                                  LedgerEntry const& entry)
+{
+    auto const& balanceEntry = entry.data.balance();
+
+    std::string accountID = PubKeyUtils::toStrKey(balanceEntry.accountID);
+    std::string balanceID = BalanceKeyUtils::toStrKey(balanceEntry.balanceID);
+    std::string asset = balanceEntry.asset;
+    int32_t balanceVersion = static_cast<int32_t >(balanceEntry.ext.v());
 
     string sql;
 
@@ -82,7 +138,7 @@ BalanceHelperLegacy::storeUpdateHelper(LedgerDelta& delta, Database& db,
     st.exchange(use(balanceEntry.amount, "am"));
     st.exchange(use(balanceEntry.locked, "ld"));
     st.exchange(use(accountID, "aid"));
-    st.exchange(use(balanceFrame->mEntry.lastModifiedLedgerSeq, "lm"));
+    st.exchange(use(entry.lastModifiedLedgerSeq, "lm"));
     st.exchange(use(balanceVersion, "v"));
     st.define_and_bind();
 
@@ -94,16 +150,6 @@ BalanceHelperLegacy::storeUpdateHelper(LedgerDelta& delta, Database& db,
     {
         throw std::runtime_error("could not update SQL");
     }
-
-    if (insert)
-    {
-        delta.addEntry(*balanceFrame);
-    }
-    else
-    {
-        delta.modEntry(*balanceFrame);
-    }
-
 }
 
 void
@@ -120,9 +166,82 @@ BalanceHelperLegacy::storeChange(LedgerDelta& delta, Database& db,
     storeUpdateHelper(delta, db, false, entry);
 }
 
+void
+BalanceHelperLegacy::storeUpsertMany(LedgerDelta& delta, Database& db,
+                                     std::vector<LedgerEntry> const& entries)
+{
+    static const std::vector<std::string> columns = {
+        "balance_id", "asset", "amount", "locked", "account_id",
+        "lastmodified", "version"};
+
+    for (size_t begin = 0; begin < entries.size();
+         begin += MAX_ENTRIES_PER_UPSERT)
+    {
+        auto const end = min(entries.size(), begin + MAX_ENTRIES_PER_UPSERT);
+        auto const rows = end - begin;
+
+        // bound values have to stay in place until the statement is run
+        std::vector<std::string> balanceIDs, assets, accountIDs;
+        std::vector<int32_t> versions;
+        balanceIDs.reserve(rows);
+        assets.reserve(rows);
+        accountIDs.reserve(rows);
+        versions.reserve(rows);
+
+        auto prep = db.getPreparedStatement(
+            upsertStatement(db, "balance", columns, "balance_id", rows));
+        auto& st = prep.statement();
+        for (auto i = begin; i < end; i++)
+        {
+            auto const& balanceEntry = entries[i].data.balance();
+            if (!BalanceFrame::isValid(balanceEntry))
+            {
+                throw std::runtime_error("Invalid balance");
+            }
+            flushCachedEntry(balanceKey(balanceEntry.balanceID), db);
+
+            balanceIDs.push_back(
+                BalanceKeyUtils::toStrKey(balanceEntry.balanceID));
+            assets.push_back(balanceEntry.asset);
+            accountIDs.push_back(PubKeyUtils::toStrKey(balanceEntry.accountID));
+            versions.push_back(static_cast<int32_t>(balanceEntry.ext.v()));
+
+            st.exchange(use(balanceIDs.back()));
+            st.exchange(use(assets.back()));
+            st.exchange(use(balanceEntry.amount));
+            st.exchange(use(balanceEntry.locked));
+            st.exchange(use(accountIDs.back()));
+            st.exchange(use(entries[i].lastModifiedLedgerSeq));
+            st.exchange(use(versions.back()));
+        }
+        st.define_and_bind();
+        {
+            auto timer = db.getInsertTimer("balance");
+            st.execute(true);
+        }
+
+        if (st.get_affected_rows() != static_cast<long long>(rows))
+        {
+            throw std::runtime_error("could not update SQL");
+        }
+    }
+}
+
 void
 BalanceHelperLegacy::storeDelete(LedgerDelta& delta, Database& db,
                                  LedgerKey const& key)
+{
+    flushCachedEntry(key, db);
+
+    if (!db.getLedgerOverlay().defers(&delta, LedgerEntryType::BALANCE))
+    {
+        deleteBalance(db, key);
+    }
+    delta.deleteEntry(key);
+}
+
+void
+BalanceHelperLegacy::deleteBalance(Database& db, LedgerKey const& key)
 {
     auto timer = db.getDeleteTimer("balance");
     auto prep = db.getPreparedStatement("DELETE FROM balance WHERE balance_id=:id");
@@ -132,25 +251,12 @@ BalanceHelperLegacy::storeDelete(LedgerDelta& delta, Database& db,
     st.exchange(use(balIDStrKey));
     st.define_and_bind();
     st.execute(true);
-    delta.deleteEntry(key);
 }
 
 bool
 BalanceHelperLegacy::exists(Database& db, LedgerKey const& key)
 {
-    int exists = 0;
-    auto timer = db.getSelectTimer("balance-exists");
-    auto prep =
-            db.getPreparedStatement("SELECT EXISTS (SELECT NULL FROM balance WHERE balance_id=:id)");
-    auto& st = prep.statement();
-    auto balanceID = key.balance().balanceID;
-    auto balIDStrKey = BalanceKeyUtils::toStrKey(balanceID);
-    st.exchange(use(balIDStrKey));
-    st.exchange(into(exists));
-    st.define_and_bind();
-    st.execute(true);
-
-    return exists != 0;
+    return exists(db, key.balance().balanceID);
 }
 
 LedgerKey
@@ -193,10 +299,130 @@ BalanceHelperLegacy::loadBalance(AccountID accountID, BalanceID balanceID,
     return accountID == balanceFrame->getAccountID() ? balanceFrame : nullptr;
 }
 
+std::vector<EntryFrame::pointer>
+BalanceHelperLegacy::loadMany(std::vector<LedgerKey> const& keys, Database& db)
+{
+    std::vector<BalanceID> balanceIDs;
+    balanceIDs.reserve(keys.size());
+    for (auto const& key : keys)
+    {
+        balanceIDs.push_back(key.balance().balanceID);
+    }
+
+    auto balances = loadBalancesByID(balanceIDs, db);
+    return std::vector<EntryFrame::pointer>(balances.begin(), balances.end());
+}
+
+std::vector<BalanceFrame::pointer>
+BalanceHelperLegacy::loadBalancesByID(std::vector<BalanceID> const& balanceIDs,
+                                      Database& db)
+{
+    std::vector<BalanceFrame::pointer> result;
+    std::set<BalanceID> requested;
+    std::vector<BalanceID> toLoadIDs;
+    std::vector<std::string> toLoad;
+    for (auto const& balanceID : balanceIDs)
+    {
+        if (!requested.insert(balanceID).second)
+        {
+            continue;
+        }
+
+        BalanceFrame::pointer pending;
+        if (findPending(db, balanceID, pending))
+        {
+            if (pending)
+            {
+                result.push_back(pending);
+            }
+            continue;
+        }
+
+        auto key = balanceKey(balanceID);
+        if (cachedEntryExists(key, db))
+        {
+            auto p = getCachedEntry(key, db);
+            if (p)
+            {
+                result.push_back(make_shared<BalanceFrame>(*p));
+            }
+            continue;
+        }
+        toLoadIDs.push_back(balanceID);
+        toLoad.push_back(BalanceKeyUtils::toStrKey(balanceID));
+    }
+
+    size_t begin = 0;
+    while (begin < toLoad.size())
+    {
+        auto const batchSize = loadManyBatchSize(toLoad.size() - begin);
+        auto const end = min(toLoad.size(), begin + batchSize);
+
+        std::string sql = balanceColumnSelector;
+        sql += " WHERE balance_id IN " + inPlaceholders(batchSize);
+        auto prep = db.getPreparedStatement(sql);
+        auto& st = prep.statement();
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            // the tail of the last batch repeats its last id
+            st.exchange(use(toLoad[min(begin + i, end - 1)]));
+        }
+
+        std::set<BalanceID> found;
+        auto timer = db.getSelectTimer("balance");
+        loadBalances(prep, [&](LedgerEntry const& balance)
+        {
+            auto balanceFrame = make_shared<BalanceFrame>(balance);
+            putCachedEntry(balanceFrame->getKey(),
+                           make_shared<LedgerEntry const>(balance), db);
+            found.insert(balance.data.balance().balanceID);
+            result.push_back(balanceFrame);
+        });
+
+        for (auto i = begin; i < end; i++)
+        {
+            if (found.find(toLoadIDs[i]) == found.end())
+            {
+                putCachedEntry(balanceKey(toLoadIDs[i]), nullptr, db);
+            }
+        }
+        begin = end;
+    }
+
+    return result;
+}
+
 BalanceFrame::pointer
 BalanceHelperLegacy::loadBalance(BalanceID balanceID, Database& db,
                                  LedgerDelta* delta)
 {
+    BalanceFrame::pointer pending;
+    if (findPending(db, balanceID, pending))
+    {
+        if (pending && delta)
+        {
+            delta->recordEntry(*pending);
+        }
+        return pending;
+    }
+
+    auto key = balanceKey(balanceID);
+    if (cachedEntryExists(key, db))
+    {
+        auto p = getCachedEntry(key, db);
+        if (!p)
+        {
+            return nullptr;
+        }
+
+        auto cached = make_shared<BalanceFrame>(*p);
+        if (delta)
+        {
+            delta->recordEntry(*cached);
+        }
+        return cached;
+    }
+
     BalanceFrame::pointer retBalance;
     auto balIDStrKey = BalanceKeyUtils::toStrKey(balanceID);
 
@@ -212,7 +438,14 @@ BalanceHelperLegacy::loadBalance(BalanceID balanceID, Database& db,
         retBalance = make_shared<BalanceFrame>(Balance);
     });
 
-    if (delta && retBalance)
+    if (!retBalance)
+    {
+        putCachedEntry(key, nullptr, db);
+        return nullptr;
+    }
+
+    putCachedEntry(key, make_shared<LedgerEntry const>(retBalance->mEntry), db);
+    if (delta)
     {
         delta->recordEntry(*retBalance);
     }
@@ -230,16 +463,27 @@ BalanceHelperLegacy::loadBalance(AccountID account, AssetCode asset,
 
     actIDStrKey = PubKeyUtils::toStrKey(account);
     std::string sql = balanceColumnSelector;
-    sql += " WHERE account_id = :aid AND asset = :as ORDER BY balance_id DESC LIMIT 1";
+    sql += " WHERE account_id = :aid AND asset = :as";
     auto prep = db.getPreparedStatement(sql);
     auto& st = prep.statement();
     st.exchange(use(actIDStrKey));
     st.exchange(use(assetCode));
 
     auto timer = db.getSelectTimer("balance");
-    loadBalances(prep, [&retBalance](LedgerEntry const& Balance)
+    // the balance with the greatest id is picked, pending balances included
+    std::string retBalanceID;
+    loadBalances(db, prep, [&](BalanceEntry const& balance)
     {
-        retBalance = make_shared<BalanceFrame>(Balance);
+        return balance.accountID == account && balance.asset == assetCode;
+    }, [&](LedgerEntry const& balance)
+    {
+        auto balanceID =
+                BalanceKeyUtils::toStrKey(balance.data.balance().balanceID);
+        if (!retBalance || balanceID > retBalanceID)
+        {
+            retBalance = make_shared<BalanceFrame>(balance);
+            retBalanceID = balanceID;
+        }
     });
 
     if (delta && retBalance)
@@ -291,6 +535,23 @@ BalanceHelperLegacy::loadBalances(StatementContext& prep,
     }
 }
 
+void
+BalanceHelperLegacy::loadBalances(Database& db, StatementContext& prep,
+                            std::function<bool(BalanceEntry const&)> const& matches,
+                            std::function<void(LedgerEntry const&)> balanceProcessor)
+{
+    db.getLedgerOverlay().merge(LedgerEntryType::BALANCE,
+        [&prep](LedgerOverlay::EntryProcessor const& processor)
+        {
+            loadBalances(prep, processor);
+        },
+        [&matches](LedgerEntry const& balance)
+        {
+            return matches(balance.data.balance());
+        },
+        balanceProcessor);
+}
+
 void
 BalanceHelperLegacy::loadBalances(AccountID const& accountID,
                             std::vector<BalanceFrame::pointer>& retBalances,
@@ -306,7 +567,10 @@ BalanceHelperLegacy::loadBalances(AccountID const& accountID,
     st.exchange(use(actIDStrKey));
 
     auto timer = db.getSelectTimer("balance");
-    loadBalances(prep, [&retBalances](LedgerEntry const& of)
+    loadBalances(db, prep, [&accountID](BalanceEntry const& balance)
+    {
+        return balance.accountID == accountID;
+    }, [&retBalances](LedgerEntry const& of)
     {
         retBalances.emplace_back(make_shared<BalanceFrame>(of));
     });
@@ -326,7 +590,10 @@ BalanceHelperLegacy::loadBalances(AccountID const& accountID, Database& db)
     st.exchange(use(actIDStrKey));
 
     auto timer = db.getSelectTimer("balance");
-    loadBalances(prep, [&retBalances](LedgerEntry const& of)
+    loadBalances(db, prep, [&accountID](BalanceEntry const& balance)
+    {
+        return balance.accountID == accountID;
+    }, [&retBalances](LedgerEntry const& of)
     {
         retBalances[of.data.balance().asset] = make_shared<BalanceFrame>(of);
     });
@@ -342,7 +609,10 @@ BalanceHelperLegacy::loadAllBalances(Database& db)
     auto prep = db.getPreparedStatement(sql);
 
     auto timer = db.getSelectTimer("balance");
-    loadBalances(prep, [&retBalances](LedgerEntry const& of)
+    loadBalances(db, prep, [](BalanceEntry const&)
+    {
+        return true;
+    }, [&retBalances](LedgerEntry const& of)
     {
         auto& thisUserBalance = retBalances[of.data.balance().accountID];
         thisUserBalance.emplace_back(make_shared<BalanceFrame>(of));
@@ -353,6 +623,12 @@ BalanceHelperLegacy::loadAllBalances(Database& db)
 bool
 BalanceHelperLegacy::exists(Database& db, BalanceID balanceID)
 {
+    BalanceFrame::pointer pending;
+    if (findPending(db, balanceID, pending))
+    {
+        return !!pending;
+    }
+
     int exists = 0;
     auto timer = db.getSelectTimer("balance-exists");
     auto prep =
@@ -385,7 +661,11 @@ BalanceHelperLegacy::loadAssetHolders(AssetCode assetCode, AccountID ownerID,
     auto timer = db.getSelectTimer("balance");
 
     std::vector<BalanceFrame::pointer> holders;
-    loadBalances(prep, [&holders](LedgerEntry const &of)
+    loadBalances(db, prep, [&](BalanceEntry const& balance)
+    {
+        return balance.asset == assetCode && !(balance.accountID == ownerID) &&
+               uint64_t(balance.amount) + balance.locked >= minTotalAmount;
+    }, [&holders](LedgerEntry const &of)
     {
         auto balanceFrame = make_shared<BalanceFrame>(of);
 
@@ -413,7 +693,10 @@ BalanceHelperLegacy::loadBalances(AccountID account, AssetCode asset,
     auto timer = db.getSelectTimer("balance");
 
     std::vector<BalanceFrame::pointer> result;
-    loadBalances(prep, [&result](LedgerEntry const &of)
+    loadBalances(db, prep, [&](BalanceEntry const& balance)
+    {
+        return balance.asset == asset && balance.accountID == account;
+    }, [&result](LedgerEntry const &of)
     {
         result.emplace_back(make_shared<BalanceFrame>(of));
     });
@@ -442,11 +725,9 @@ BalanceHelperLegacy::loadBalances(std::vector<AccountID> accountIDs,
     if (accountIDs.empty())
         return vector<BalanceFrame::pointer>{};
 
-    string sql = "SELECT DISTINCT ON (account_id) balance_id, asset, "
-                 "amount, locked, account_id, lastmodified, version "
-                 "FROM balance "
-                 "WHERE asset = :asset AND account_id IN (" +
-                 obtainStrAccountIDs(accountIDs) + ")";
+    string sql = balanceColumnSelector;
+    sql += " WHERE asset = :asset AND account_id IN (" +
+           obtainStrAccountIDs(accountIDs) + ")";
 
     auto prep = db.getPreparedStatement(sql);
     auto &st = prep.statement();
@@ -454,10 +735,20 @@ BalanceHelperLegacy::loadBalances(std::vector<AccountID> accountIDs,
 
     auto timer = db.getSelectTimer("balances");
 
+    // one balance per account, like DISTINCT ON (account_id) did
+    std::set<AccountID> seen;
     std::vector<BalanceFrame::pointer> result;
-    loadBalances(prep, [&result](LedgerEntry const &of)
+    loadBalances(db, prep, [&](BalanceEntry const& balance)
     {
-        result.emplace_back(make_shared<BalanceFrame>(of));
+        return balance.asset == assetCode &&
+               std::find(accountIDs.begin(), accountIDs.end(),
+                         balance.accountID) != accountIDs.end();
+    }, [&](LedgerEntry const &of)
+    {
+        if (seen.insert(of.data.balance().accountID).second)
+        {
+            result.emplace_back(make_shared<BalanceFrame>(of));
+        }
     });
 
     return result;
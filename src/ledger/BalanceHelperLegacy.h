@@ -26,6 +26,7 @@ public:
     }
 
     void dropAll(Database& db) override;
+    void addAccountIndex(Database& db);
     void storeAdd(LedgerDelta& delta, Database& db, LedgerEntry const& entry) override;
     void storeChange(LedgerDelta& delta, Database& db, LedgerEntry const& entry) override;
     void storeDelete(LedgerDelta& delta, Database& db, LedgerKey const& key) override;
@@ -34,6 +35,16 @@ public:
     EntryFrame::pointer storeLoad(LedgerKey const& key, Database& db) override;
     EntryFrame::pointer fromXDR(LedgerEntry const& from) override;
     uint64_t countObjects(soci::session& sess) override;
+    std::vector<EntryFrame::pointer> loadMany(std::vector<LedgerKey> const& keys,
+                                              Database& db) override;
+    void storeUpsertMany(LedgerDelta& delta, Database& db,
+                         std::vector<LedgerEntry> const& entries) override;
+
+    // Loads the balances with the given ids using batched queries and keeps
+    // them in the entry cache, where later loadBalance(balanceID) calls find
+    // them. Ids that do not exist are skipped.
+    std::vector<BalanceFrame::pointer> loadBalancesByID(std::vector<BalanceID> const& balanceIDs,
+                                                        Database& db);
 
     void loadBalances(AccountID const& accountID,
                       std::vector<BalanceFrame::pointer>& retBalances,
@@ -92,6 +103,11 @@ public:
 
     bool exists(Database& db, BalanceID balanceID);
 
+    // SQL side of storeAdd/storeChange and storeDelete, also used by
+    // LedgerOverlay::flush
+    void writeBalance(Database& db, bool insert, LedgerEntry const& entry);
+    void deleteBalance(Database& db, LedgerKey const& key);
+
 private:
     BalanceHelperLegacy() { ; }
     ~BalanceHelperLegacy() { ; }
@@ -104,6 +120,12 @@ private:
     static void loadBalances(StatementContext& prep,
                              std::function<void(LedgerEntry const&)> balanceProcessor);
 
+    // loads through the ledger overlay, `matches` has to mirror the WHERE
+    // clause of `prep`, see LedgerOverlay::merge
+    static void loadBalances(Database& db, StatementContext& prep,
+                             std::function<bool(BalanceEntry const&)> const& matches,
+                             std::function<void(LedgerEntry const&)> balanceProcessor);
+
     void storeUpdateHelper(LedgerDelta& delta, Database& db, bool insert, LedgerEntry const& entry);
 };
 }
\ No newline at end of file
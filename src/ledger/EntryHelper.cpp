@@ -1,36 +1,47 @@
-#include <xdrpp/marshal.h>
 #include "ledger/EntryHelper.h"
+#include "database/Database.h"
 
 namespace stellar
 {
 
+std::vector<EntryFrame::pointer>
+EntryHelper::loadMany(std::vector<LedgerKey> const& keys)
+{
+    std::vector<EntryFrame::pointer> result;
+    for (auto const& key : keys)
+    {
+        auto entry = storeLoad(key);
+        if (entry)
+        {
+            result.push_back(entry);
+        }
+    }
+    return result;
+}
+
 void
 EntryHelper::flushCachedEntry(LedgerKey const& key)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    getDatabase().getEntryCache().erase_if_exists(s);
+    getDatabase().getEntryCache().erase_if_exists(key);
 }
 
 bool
 EntryHelper::cachedEntryExists(LedgerKey const& key)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    return getDatabase().getEntryCache().exists(s);
+    return getDatabase().getEntryCache().exists(key);
 }
 
 std::shared_ptr<LedgerEntry const>
 EntryHelper::getCachedEntry(LedgerKey const& key)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    return getDatabase().getEntryCache().get(s);
+    return getDatabase().getEntryCache().get(key);
 }
 
 void
 EntryHelper::putCachedEntry(LedgerKey const& key,
                             std::shared_ptr<LedgerEntry const> p)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    getDatabase().getEntryCache().put(s, p);
+    getDatabase().getEntryCache().put(key, p);
 }
 
 } // namespace stellar
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "ledger/EntryHelperLegacy.h"
 
 namespace stellar
@@ -21,6 +22,10 @@ class EntryHelper
     virtual LedgerKey getLedgerKey(LedgerEntry const& from) = 0;
     virtual EntryFrame::pointer fromXDR(LedgerEntry const& from) = 0;
     virtual EntryFrame::pointer storeLoad(LedgerKey const& ledgerKey) = 0;
+    // Loads the entries of `keys` that exist, in no particular order, see
+    // EntryHelperLegacy::loadMany.
+    virtual std::vector<EntryFrame::pointer>
+    loadMany(std::vector<LedgerKey> const& keys);
     virtual uint64_t countObjects() = 0;
 
     virtual Database& getDatabase() = 0;
@@ -99,30 +99,125 @@ namespace stellar
 		return helper->getLedgerKey(e);
 	}
 
+	const size_t EntryHelperLegacy::MAX_KEYS_PER_LOAD = 512;
+
+	std::vector<EntryFrame::pointer>
+	EntryHelperLegacy::loadMany(std::vector<LedgerKey> const& keys, Database& db)
+	{
+		std::vector<EntryFrame::pointer> result;
+		for (auto const& key : keys)
+		{
+			auto entry = storeLoad(key, db);
+			if (entry)
+			{
+				result.push_back(entry);
+			}
+		}
+		return result;
+	}
+
+	// keeps the widest upsert (offers, 16 columns) under the 999 bound
+	// parameters SQLite allows in one statement
+	const size_t EntryHelperLegacy::MAX_ENTRIES_PER_UPSERT = 32;
+
+	void
+	EntryHelperLegacy::storeUpsertMany(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries)
+	{
+		for (auto const& entry : entries)
+		{
+			if (exists(db, getLedgerKey(entry)))
+			{
+				storeChange(delta, db, entry);
+			}
+			else
+			{
+				storeAdd(delta, db, entry);
+			}
+		}
+	}
+
+	size_t EntryHelperLegacy::loadManyBatchSize(size_t remaining)
+	{
+		size_t size = 1;
+		while (size < remaining && size < MAX_KEYS_PER_LOAD)
+		{
+			size *= 2;
+		}
+		return size;
+	}
+
+	std::string EntryHelperLegacy::inPlaceholders(size_t count)
+	{
+		std::string result = "(";
+		for (size_t i = 0; i < count; i++)
+		{
+			result += (i == 0 ? ":k" : ", :k") + std::to_string(i);
+		}
+		return result + ")";
+	}
+
+	std::string EntryHelperLegacy::valuesPlaceholders(size_t rows, size_t columns)
+	{
+		std::string result;
+		for (size_t i = 0; i < rows; i++)
+		{
+			result += i == 0 ? "(" : ", (";
+			for (size_t j = 0; j < columns; j++)
+			{
+				result += (j == 0 ? ":v" : ", :v") + std::to_string(i) + "_" + std::to_string(j);
+			}
+			result += ")";
+		}
+		return result;
+	}
+
+	std::string EntryHelperLegacy::upsertStatement(Database& db, std::string const& table,
+	                                               std::vector<std::string> const& columns,
+	                                               std::string const& keyColumn, size_t rows)
+	{
+		std::string columnList;
+		for (auto const& column : columns)
+		{
+			columnList += (columnList.empty() ? "" : ", ") + column;
+		}
+		auto values = " (" + columnList + ") VALUES " + valuesPlaceholders(rows, columns.size());
+
+		if (db.isSqlite())
+		{
+			return "INSERT OR REPLACE INTO " + table + values;
+		}
+
+		std::string updates;
+		for (auto const& column : columns)
+		{
+			if (column != keyColumn)
+			{
+				updates += (updates.empty() ? "" : ", ") + column + " = excluded." + column;
+			}
+		}
+		return "INSERT INTO " + table + values + " ON CONFLICT (" + keyColumn + ") DO UPDATE SET " + updates;
+	}
+
 	void EntryHelperLegacy::flushCachedEntry(LedgerKey const &key, Database &db)
 	{
-		auto s = binToHex(xdr::xdr_to_opaque(key));
-		db.getEntryCache().erase_if_exists(s);
+		db.getEntryCache().erase_if_exists(key);
 	}
 
 	bool EntryHelperLegacy::cachedEntryExists(LedgerKey const &key, Database &db)
 	{
-		auto s = binToHex(xdr::xdr_to_opaque(key));
-		return db.getEntryCache().exists(s);
+		return db.getEntryCache().exists(key);
 	}
 
 	std::shared_ptr<LedgerEntry const>
 	EntryHelperLegacy::getCachedEntry(LedgerKey const &key, Database &db)
 	{
-		auto s = binToHex(xdr::xdr_to_opaque(key));
-		return db.getEntryCache().get(s);
+		return db.getEntryCache().get(key);
 	}
 
 	void EntryHelperLegacy::putCachedEntry(LedgerKey const &key,
 	std::shared_ptr<LedgerEntry const> p, Database &db)
 	{
-		auto s = binToHex(xdr::xdr_to_opaque(key));
-		db.getEntryCache().put(s, p);
+		db.getEntryCache().put(key, p);
 	}
 
     void
@@ -186,6 +281,26 @@ namespace stellar
 		}
 	}
 
+	void
+	EntryHelperProvider::storeUpsertEntries(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries)
+	{
+		std::map<LedgerEntryType, std::vector<LedgerEntry>> entriesByType;
+		for (auto const& entry : entries)
+		{
+			entriesByType[entry.data.type()].push_back(entry);
+		}
+
+		for (auto const& typeEntries : entriesByType)
+		{
+			EntryHelperLegacy* helper = getHelper(typeEntries.first);
+			if (!helper)
+			{
+				throw std::runtime_error("There's no legacy helper for this entry.");
+			}
+			helper->storeUpsertMany(delta, db, typeEntries.second);
+		}
+	}
+
 	void
 	EntryHelperProvider::storeDeleteEntry(LedgerDelta& delta, Database& db, LedgerKey const& key)
 	{
@@ -218,6 +333,29 @@ namespace stellar
 		return helper->storeLoad(key, db);
 	}
 
+	std::vector<EntryFrame::pointer>
+	EntryHelperProvider::loadManyEntries(std::vector<LedgerKey> const& keys, Database& db)
+	{
+		std::map<LedgerEntryType, std::vector<LedgerKey>> keysByType;
+		for (auto const& key : keys)
+		{
+			keysByType[key.type()].push_back(key);
+		}
+
+		std::vector<EntryFrame::pointer> result;
+		for (auto const& typeKeys : keysByType)
+		{
+			EntryHelperLegacy* helper = getHelper(typeKeys.first);
+			if (!helper)
+			{
+				throw std::runtime_error("There's no legacy helper for this entry.");
+			}
+			auto entries = helper->loadMany(typeKeys.second, db);
+			result.insert(result.end(), entries.begin(), entries.end());
+		}
+		return result;
+	}
+
 	EntryFrame::pointer
 	EntryHelperProvider::fromXDREntry(LedgerEntry const& from)
 	{
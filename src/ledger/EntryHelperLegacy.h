@@ -35,12 +35,52 @@ namespace stellar
 		virtual EntryFrame::pointer storeLoad(LedgerKey const &ledgerKey, Database &db) = 0;
 		virtual uint64_t countObjects(soci::session& sess) = 0;
 
+		// Loads the entries of `keys` that exist, in no particular order.
+		// The default issues one storeLoad per key; helpers of entries that
+		// are loaded in bulk override it with batched queries of at most
+		// MAX_KEYS_PER_LOAD keys and leave the results in the entry cache.
+		virtual std::vector<EntryFrame::pointer> loadMany(std::vector<LedgerKey> const& keys, Database& db);
+
+		static const size_t MAX_KEYS_PER_LOAD;
+
+		// Stores entries that may or may not be in the database yet, as when
+		// buckets are applied on top of existing state. The default checks
+		// each entry with exists and stores it with storeAdd or storeChange.
+		// Helpers of the bulk of the bucket entries override it with upserts
+		// of at most MAX_ENTRIES_PER_UPSERT rows that skip the check. They
+		// leave `delta` alone, because they don't know which entries were
+		// added and which were changed.
+		virtual void storeUpsertMany(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries);
+
+		static const size_t MAX_ENTRIES_PER_UPSERT;
+
 		void flushCachedEntry(LedgerKey const& key, Database& db);
 		bool cachedEntryExists(LedgerKey const& key, Database& db);
 
 	protected:
 		std::shared_ptr<LedgerEntry const> getCachedEntry(LedgerKey const& key, Database& db);
 		void putCachedEntry(LedgerKey const& key, std::shared_ptr<LedgerEntry const> p, Database& db);
+
+		// Number of placeholders to use for the next `remaining` keys of a
+		// batched load: the next power of two, capped at MAX_KEYS_PER_LOAD,
+		// so that only a few distinct statements get prepared. Unused
+		// placeholders are bound to a repeated key.
+		static size_t loadManyBatchSize(size_t remaining);
+
+		// "(:k0, :k1, ...)" with `count` placeholders
+		static std::string inPlaceholders(size_t count);
+
+		// "(:v0_0, :v0_1, ...), (:v1_0, ...)" for `rows` rows of `columns`
+		// values
+		static std::string valuesPlaceholders(size_t rows, size_t columns);
+
+		// INSERT of `rows` rows into `table` that replaces the rows with the
+		// same `keyColumn`: INSERT OR REPLACE on SQLite, INSERT ... ON
+		// CONFLICT DO UPDATE on PostgreSQL. Values are bound row by row in
+		// the order of `columns`.
+		static std::string upsertStatement(Database& db, std::string const& table,
+		                                   std::vector<std::string> const& columns,
+		                                   std::string const& keyColumn, size_t rows);
 	};
 
 	class EntryHelperProvider {
@@ -61,9 +101,11 @@ namespace stellar
 		static void storeDeleteEntry(LedgerDelta& delta, Database& db, LedgerKey const& key);
 		static bool existsEntry(Database& db, LedgerKey const& key);
 		static EntryFrame::pointer storeLoadEntry(LedgerKey const& key, Database& db);
+		static std::vector<EntryFrame::pointer> loadManyEntries(std::vector<LedgerKey> const& keys, Database& db);
 		static uint64_t countObjectsEntry(soci::session& sess, LedgerEntryType const& type);
 
 		static void storeAddOrChangeEntry(LedgerDelta& delta, Database& db, LedgerEntry const& entry);
+		static void storeUpsertEntries(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries);
 
 		static void checkAgainstDatabase(LedgerEntry const& entry, Database& db);
 
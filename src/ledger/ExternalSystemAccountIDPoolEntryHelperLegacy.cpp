@@ -152,6 +152,18 @@ using xdr::operator<;
         db.getSession() << "ALTER TABLE external_system_account_id_pool ALTER parent SET DATA TYPE NUMERIC(20, 0);";
     }
 
+    void ExternalSystemAccountIDPoolEntryHelperLegacy::addIndexes(Database & db)
+    {
+        // bounds the scan for an available entry to the unexpired, not deleted
+        // entries of one external system
+        db.getSession() << "CREATE INDEX external_pool_available ON external_system_account_id_pool "
+                           "(external_system_type, is_deleted, expires_at)";
+        db.getSession() << "CREATE INDEX external_pool_by_account ON external_system_account_id_pool "
+                           "(external_system_type, account_id)";
+        db.getSession() << "CREATE INDEX external_pool_by_data ON external_system_account_id_pool "
+                           "(external_system_type, data)";
+    }
+
     bool ExternalSystemAccountIDPoolEntryHelperLegacy::exists(Database &db, LedgerKey const &key)
     {
         auto const &poolEntry = key.externalSystemAccountIDPoolEntry();
@@ -32,6 +32,7 @@ class ExternalSystemAccountIDPoolEntryHelperLegacy : public EntryHelperLegacy
     void dropAll(Database& db) override;
     void fixTypes(Database& db);
     void parentToNumeric(Database& db);
+    void addIndexes(Database& db);
     void storeAdd(LedgerDelta& delta, Database& db,
                   LedgerEntry const& entry) override;
     void storeChange(LedgerDelta& delta, Database& db,
@@ -23,6 +23,7 @@ namespace stellar {
     }
 
     void FeeHelper::dropAll(Database &db) {
+        db.getFeeIndex().clear();
         db.getSession() << "DROP TABLE IF EXISTS fee_state;";
         db.getSession() << "CREATE TABLE fee_state"
                 "("
@@ -63,6 +64,7 @@ namespace stellar {
         st.define_and_bind();
         st.execute(true);
         delta.deleteEntry(key);
+        db.getFeeIndex().clear();
     }
 
     bool FeeHelper::exists(Database &db, LedgerKey const &key) {
@@ -192,6 +194,9 @@ namespace stellar {
         {
             delta.modEntry(*feeFrame);
         }
+
+        // fees change rarely, the index is simply rebuilt on next use
+        db.getFeeIndex().clear();
     }
 
     FeeFrame::pointer
@@ -323,40 +328,22 @@ namespace stellar {
                               int64_t amount, Database &db, LedgerDelta *delta) {
         if (!accountFrame)
             throw std::runtime_error("Expected accountFrame not to be nullptr");
-        auto accountType = accountFrame->getAccountType();
-        auto accountID = accountFrame->getID();
-        Hash hash1 = FeeFrame::calcHash(feeType, asset, &accountID, nullptr, subtype);
-        Hash hash2 = FeeFrame::calcHash(feeType, asset, nullptr, &accountType, subtype);
-        Hash hash3 = FeeFrame::calcHash(feeType, asset, nullptr, nullptr, subtype);
-
-        std::string sql = feeColumnSelector;
-        sql += " WHERE hash IN (:h1, :h2, :h3) AND lower_bound <= :am1 AND :am2 <= upper_bound "
-                " ORDER BY hash=:h4 DESC, hash=:h5 DESC, hash=:h6 DESC LIMIT 1";
-        auto prep = db.getPreparedStatement(sql);
-        auto& st = prep.statement();
-        string strHash1 = binToHex(hash1);
-        string strHash2 = binToHex(hash2);
-        string strHash3 = binToHex(hash3);
-
-        st.exchange(use(strHash1));
-        st.exchange(use(strHash2));
-        st.exchange(use(strHash3));
-        st.exchange(use(amount));
-        st.exchange(use(amount));
-        st.exchange(use(strHash1));
-        st.exchange(use(strHash2));
-        st.exchange(use(strHash3));
+        auto& index = db.getFeeIndex();
+        if (!index.isLoaded())
+        {
+            loadFeeIndex(index, db);
+        }
 
-        auto timer = db.getSelectTimer("fee");
-        FeeFrame::pointer result;
-        loadFees(prep, [&result](LedgerEntry const& of)
+        auto fee = index.find(feeType, asset, subtype, accountFrame->getID(),
+                              accountFrame->getAccountType(), amount);
+        if (!fee)
         {
-            result = make_shared<FeeFrame>(of);
-            assert(result->isValid());
-            result->clearCached();
-        });
+            return nullptr;
+        }
 
-        if (delta && result)
+        auto result = make_shared<FeeFrame>(*fee);
+        result->clearCached();
+        if (delta)
         {
             delta->recordEntry(*result);
         }
@@ -364,6 +351,16 @@ namespace stellar {
         return result;
     }
 
+    void FeeHelper::loadFeeIndex(FeeIndex &index, Database &db) {
+        auto prep = db.getPreparedStatement(feeColumnSelector);
+        auto timer = db.getSelectTimer("fee-index");
+        loadFees(prep, [&index](LedgerEntry const& of)
+        {
+            index.add(of);
+        });
+        index.setLoaded();
+    }
+
     bool FeeHelper::isBoundariesOverlap(Hash hash, int64_t lowerBound, int64_t upperBound, Database &db) {
         auto fees = loadFees(hash, db);
         for (FeeFrame::pointer feeFrame : fees)
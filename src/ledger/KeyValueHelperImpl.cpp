@@ -1,4 +1,5 @@
 #include "ledger/KeyValueHelperImpl.h"
+#include "ledger/KeyValueHelperLegacy.h"
 #include "ledger/LedgerDelta.h"
 #include "ledger/StorageHelper.h"
 #include <memory>
@@ -24,6 +25,7 @@ void
 KeyValueHelperImpl::dropAll()
 {
     Database& db = mStorageHelper.getDatabase();
+    db.getKeyValueIndex().clear();
     db.getSession() << "DROP TABLE IF EXISTS key_value_entry;";
     db.getSession() << "CREATE TABLE key_value_entry"
                        "("
@@ -55,6 +57,7 @@ KeyValueHelperImpl::storeDelete(LedgerKey const& key)
     flushCachedEntry(key);
 
     Database& db = mStorageHelper.getDatabase();
+    db.getKeyValueIndex().clear();
     auto timer = db.getDeleteTimer("key_value_entry");
     auto prep =
         db.getPreparedStatement("DELETE FROM key_value_entry WHERE key=:key");
@@ -106,6 +109,7 @@ KeyValueHelperImpl::storeUpdateHelper(LedgerDelta* delta, Database& db,
 
     auto key = keyValueFrame->getKey();
     flushCachedEntry(key);
+    db.getKeyValueIndex().clear();
     std::string sql;
 
     auto valueBytes = xdr::xdr_to_opaque(keyValueEntry.value);
@@ -187,42 +191,9 @@ KeyValueHelperImpl::countObjects()
 KeyValueEntryFrame::pointer
 KeyValueHelperImpl::loadKeyValue(string256 valueKey)
 {
-    LedgerKey key;
-    key.type(LedgerEntryType::KEY_VALUE);
-    key.keyValue().key = valueKey;
-    if (cachedEntryExists(key))
-    {
-        auto p = getCachedEntry(key);
-        return p ? std::make_shared<KeyValueEntryFrame>(*p) : nullptr;
-    }
-
-    std::string sql = selectorKeyValue;
-    sql += " WHERE key = :key";
-    Database& db = getDatabase();
-    auto prep = db.getPreparedStatement(sql);
-    auto& st = prep.statement();
-    st.exchange(use(valueKey, "key"));
-
-    KeyValueEntryFrame::pointer retKeyValue;
-    auto timer = db.getSelectTimer("key_value_entry");
-    loadKeyValues(prep, [&retKeyValue](LedgerEntry const& entry) {
-        retKeyValue = std::make_shared<KeyValueEntryFrame>(entry);
-    });
-
-    if (!retKeyValue)
-    {
-        putCachedEntry(key, nullptr);
-        return nullptr;
-    }
-
-    if (mStorageHelper.getLedgerDelta())
-    {
-        mStorageHelper.getLedgerDelta()->recordEntry(*retKeyValue);
-    }
-
-    auto pEntry = std::make_shared<LedgerEntry>(retKeyValue->mEntry);
-    putCachedEntry(key, pEntry);
-    return retKeyValue;
+    // served from the resident key_value_entry copy, see KeyValueIndex
+    return KeyValueHelperLegacy::Instance()->loadKeyValue(
+        valueKey, getDatabase(), mStorageHelper.getLedgerDelta());
 }
 
 void
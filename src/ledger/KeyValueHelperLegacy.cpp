@@ -18,6 +18,7 @@ static const char* selectorKeyValue =
 void
 KeyValueHelperLegacy::dropAll(Database& db)
 {
+    db.getKeyValueIndex().clear();
     db.getSession() << "DROP TABLE IF EXISTS key_value_entry;";
     db.getSession() << "CREATE TABLE key_value_entry"
                        "("
@@ -48,6 +49,7 @@ KeyValueHelperLegacy::storeDelete(LedgerDelta& delta, Database& db,
                                   LedgerKey const& key)
 {
     flushCachedEntry(key, db);
+    db.getKeyValueIndex().clear();
     auto timer = db.getDeleteTimer("key_value_entry");
     auto prep =
         db.getPreparedStatement("DELETE FROM key_value_entry WHERE key=:key");
@@ -92,6 +94,7 @@ KeyValueHelperLegacy::storeUpdateHelper(LedgerDelta& delta, Database& db,
 
     auto key = keyValueFrame->getKey();
     flushCachedEntry(key, db);
+    db.getKeyValueIndex().clear();
     string sql;
 
     auto valueBytes = xdr::xdr_to_opaque(keyValueEntry.value);
@@ -171,43 +174,36 @@ KeyValueEntryFrame::pointer
 KeyValueHelperLegacy::loadKeyValue(string256 valueKey, Database& db,
                                    LedgerDelta* delta)
 {
-    LedgerKey key;
-    key.type(LedgerEntryType::KEY_VALUE);
-    key.keyValue().key = valueKey;
-    if (cachedEntryExists(key, db))
+    auto& index = db.getKeyValueIndex();
+    if (!index.isLoaded())
     {
-        auto p = getCachedEntry(key, db);
-        return p ? std::make_shared<KeyValueEntryFrame>(*p) : nullptr;
+        loadKeyValueIndex(index, db);
     }
 
-    std::string sql = selectorKeyValue;
-    sql += " WHERE key = :key";
-    auto prep = db.getPreparedStatement(sql);
-    auto& st = prep.statement();
-    st.exchange(use(valueKey, "key"));
-
-    KeyValueEntryFrame::pointer retKeyValue;
-    auto timer = db.getSelectTimer("key_value_entry");
-    loadKeyValues(prep, [&retKeyValue](LedgerEntry const& entry) {
-        retKeyValue = make_shared<KeyValueEntryFrame>(entry);
-    });
-
-    if (!retKeyValue)
+    auto entry = index.find(valueKey);
+    if (!entry)
     {
-        putCachedEntry(key, nullptr, db);
         return nullptr;
     }
 
+    auto retKeyValue = make_shared<KeyValueEntryFrame>(*entry);
     if (delta)
     {
         delta->recordEntry(*retKeyValue);
     }
-
-    auto pEntry = std::make_shared<LedgerEntry>(retKeyValue->mEntry);
-    putCachedEntry(key, pEntry, db);
     return retKeyValue;
 }
 
+void
+KeyValueHelperLegacy::loadKeyValueIndex(KeyValueIndex& index, Database& db)
+{
+    auto prep = db.getPreparedStatement(selectorKeyValue);
+    auto timer = db.getSelectTimer("key-value-index");
+    loadKeyValues(prep,
+                  [&index](LedgerEntry const& entry) { index.add(entry); });
+    index.setLoaded();
+}
+
 void
 KeyValueHelperLegacy::loadKeyValues(
     StatementContext& prep,
@@ -56,6 +56,8 @@ namespace stellar
 
     private:
 
+        void loadKeyValueIndex(KeyValueIndex &index, Database &db);
+
         void storeUpdateHelper(LedgerDelta &delta, Database &db, bool insert, LedgerEntry const &entry);
     };
 
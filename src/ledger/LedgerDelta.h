@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
 #include "ledger/EntryFrame.h"
 
@@ -15,6 +16,10 @@ class LedgerDelta
   public:
     typedef std::map<LedgerKey, EntryFrame::pointer, LedgerEntryIdCmp>
         KeyEntryMap;
+    // read only view of the previous state of the entries touched by a delta;
+    // it stays valid, and unchanged, once the delta is committed or destroyed
+    typedef std::shared_ptr<KeyEntryMap const> StateSnapshot;
+
     virtual LedgerHeader& getHeader() = 0;
     virtual LedgerHeader const& getHeader() const = 0;
     virtual LedgerHeaderFrame& getHeaderFrame() = 0;
@@ -46,7 +51,7 @@ class LedgerDelta
     // performs sanity checks against the local state
     virtual void checkAgainstDatabase(Application& app) const = 0;
 
-    virtual KeyEntryMap getState() const = 0;
+    virtual StateSnapshot getState() const = 0;
 
     virtual bool isStateActive() const = 0;
 
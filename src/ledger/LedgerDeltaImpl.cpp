@@ -4,8 +4,11 @@
 
 #include "ledger/LedgerDeltaImpl.h"
 #include "LedgerDeltaImpl.h"
+#include "database/Database.h"
+#include "ledger/AssetPairCache.h"
 #include "ledger/EntryHelperLegacy.h"
 #include "ledger/KeyValueEntryFrame.h"
+#include "ledger/LedgerOverlay.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "medida/meter.h"
@@ -22,9 +25,11 @@ LedgerDeltaImpl::LedgerDeltaImpl(LedgerDelta& outerDelta)
     , mHeader(&outerDelta.getHeader())
     , mCurrentHeader(outerDelta.getHeader())
     , mPreviousHeaderValue(outerDelta.getHeader())
+    , mPrevious(std::make_shared<KeyEntryMap>())
     , mDb(outerDelta.getDatabase())
     , mUpdateLastModified(outerDelta.updateLastModified())
 {
+    mDb.getLedgerOverlay().nest(*this, outerDelta);
 }
 
 LedgerDeltaImpl::LedgerDeltaImpl(LedgerDeltaImpl& outerDelta)
@@ -32,9 +37,11 @@ LedgerDeltaImpl::LedgerDeltaImpl(LedgerDeltaImpl& outerDelta)
     , mHeader(&outerDelta.getHeader())
     , mCurrentHeader(outerDelta.getHeader())
     , mPreviousHeaderValue(outerDelta.getHeader())
+    , mPrevious(std::make_shared<KeyEntryMap>())
     , mDb(outerDelta.getDatabase())
     , mUpdateLastModified(outerDelta.updateLastModified())
 {
+    mDb.getLedgerOverlay().nest(*this, outerDelta);
 }
 
 LedgerDeltaImpl::LedgerDeltaImpl(LedgerHeader& header, Database& db,
@@ -43,6 +50,7 @@ LedgerDeltaImpl::LedgerDeltaImpl(LedgerHeader& header, Database& db,
     , mHeader(&header)
     , mCurrentHeader(header)
     , mPreviousHeaderValue(header)
+    , mPrevious(std::make_shared<KeyEntryMap>())
     , mDb(db)
     , mUpdateLastModified(updateLastModified)
 {
@@ -87,32 +95,57 @@ LedgerDeltaImpl::checkState()
 void
 LedgerDeltaImpl::addEntry(EntryFrame const& entry)
 {
-    addEntry(entry.copy());
+    auto e = entry.copy();
+    insertNew(e);
+
+    // add to detailed changes
+    mAllChanges.emplace_back(LedgerEntryChangeType::CREATED);
+    mAllChanges.back().created() = e->mEntry;
 }
 
 void
 LedgerDeltaImpl::deleteEntry(EntryFrame const& entry)
 {
-    deleteEntry(entry.copy());
+    deleteEntry(entry.getKey());
+}
+
+void
+LedgerDeltaImpl::deleteEntry(LedgerKey const& k)
+{
+    insertDelete(k);
+
+    // add key to detailed changes
+    mAllChanges.emplace_back(LedgerEntryChangeType::REMOVED);
+    mAllChanges.back().removed() = k;
 }
 
 void
 LedgerDeltaImpl::modEntry(EntryFrame const& entry)
 {
-    modEntry(entry.copy());
+    auto e = entry.copy();
+    insertMod(e);
+
+    // add to detailed changes
+    mAllChanges.emplace_back(LedgerEntryChangeType::UPDATED);
+    mAllChanges.back().updated() = e->mEntry;
 }
 
 void
 LedgerDeltaImpl::recordEntry(EntryFrame const& entry)
 {
-    recordEntry(entry.copy());
+    checkState();
+    // only the first recorded value is kept, don't copy the others
+    if (mPrevious->find(entry.getKey()) == mPrevious->end())
+    {
+        recordEntry(entry.copy());
+    }
 }
 
 void
-LedgerDeltaImpl::addEntry(EntryFrame::pointer entry)
+LedgerDeltaImpl::insertNew(EntryFrame::pointer entry)
 {
     checkState();
-    auto k = entry->getKey();
+    auto const& k = entry->getKey();
     auto del_it = mDelete.find(k);
     if (del_it != mDelete.end())
     {
@@ -126,21 +159,10 @@ LedgerDeltaImpl::addEntry(EntryFrame::pointer entry)
         assert(mMod.find(k) == mMod.end()); // mod + new is invalid
         mNew[k] = entry;
     }
-
-    // add to detailed changes
-    mAllChanges.emplace_back(LedgerEntryChangeType::CREATED);
-    mAllChanges.back().created() = entry->mEntry;
 }
 
 void
-LedgerDeltaImpl::deleteEntry(EntryFrame::pointer entry)
-{
-    auto k = entry->getKey();
-    deleteEntry(k);
-}
-
-void
-LedgerDeltaImpl::deleteEntry(LedgerKey const& k)
+LedgerDeltaImpl::insertDelete(LedgerKey const& k)
 {
     checkState();
     auto new_it = mNew.find(k);
@@ -158,17 +180,13 @@ LedgerDeltaImpl::deleteEntry(LedgerKey const& k)
 
         mMod.erase(k);
     }
-
-    // add key to detailed changes
-    mAllChanges.emplace_back(LedgerEntryChangeType::REMOVED);
-    mAllChanges.back().removed() = k;
 }
 
 void
-LedgerDeltaImpl::modEntry(EntryFrame::pointer entry)
+LedgerDeltaImpl::insertMod(EntryFrame::pointer entry)
 {
     checkState();
-    auto k = entry->getKey();
+    auto const& k = entry->getKey();
     auto mod_it = mMod.find(k);
     if (mod_it != mMod.end())
     {
@@ -189,18 +207,24 @@ LedgerDeltaImpl::modEntry(EntryFrame::pointer entry)
             mMod[k] = entry;
         }
     }
-
-    // add to detailed changes
-    mAllChanges.emplace_back(LedgerEntryChangeType::UPDATED);
-    mAllChanges.back().updated() = entry->mEntry;
 }
 
 void
 LedgerDeltaImpl::recordEntry(EntryFrame::pointer entry)
 {
     checkState();
-    // keeps the old one around
-    mPrevious.insert(std::make_pair(entry->getKey(), entry));
+    auto const& k = entry->getKey();
+    if (mPrevious->find(k) != mPrevious->end())
+    {
+        // keeps the old one around
+        return;
+    }
+    if (!mPrevious.unique())
+    {
+        // a snapshot returned by getState() must not see later changes
+        mPrevious = std::make_shared<KeyEntryMap>(*mPrevious);
+    }
+    mPrevious->insert(std::make_pair(k, entry));
 }
 
 void
@@ -209,28 +233,56 @@ LedgerDeltaImpl::mergeEntries(LedgerDelta& other)
     checkState();
 
     // propagates mPrevious for deleted & modified entries
+    auto const& previous = other.getPreviousFrames();
     for (auto& d : other.getDeletionFramesSet())
     {
-        deleteEntry(d);
-        auto it = other.getPreviousFrames().find(d);
-        if (it != other.getPreviousFrames().end())
+        insertDelete(d);
+        auto it = previous.find(d);
+        if (it != previous.end())
         {
-            recordEntry(*it->second);
+            recordEntry(it->second);
         }
     }
     for (auto& n : other.getCreationFrames())
     {
-        addEntry(n.second);
+        insertNew(n.second);
     }
     for (auto& m : other.getModificationFrames())
     {
-        modEntry(m.second);
-        auto it = other.getPreviousFrames().find(m.first);
-        if (it != other.getPreviousFrames().end())
+        insertMod(m.second);
+        auto it = previous.find(m.first);
+        if (it != previous.end())
         {
-            recordEntry(*it->second);
+            recordEntry(it->second);
         }
     }
+
+    addMergedChanges(other);
+}
+
+void
+LedgerDeltaImpl::addMergedChanges(LedgerDelta const& other)
+{
+    auto const& deleted = other.getDeletionFramesSet();
+    auto const& created = other.getCreationFrames();
+    auto const& modified = other.getModificationFrames();
+    mAllChanges.reserve(mAllChanges.size() + deleted.size() + created.size() +
+                        modified.size());
+    for (auto& d : deleted)
+    {
+        mAllChanges.emplace_back(LedgerEntryChangeType::REMOVED);
+        mAllChanges.back().removed() = d;
+    }
+    for (auto& n : created)
+    {
+        mAllChanges.emplace_back(LedgerEntryChangeType::CREATED);
+        mAllChanges.back().created() = n.second->mEntry;
+    }
+    for (auto& m : modified)
+    {
+        mAllChanges.emplace_back(LedgerEntryChangeType::UPDATED);
+        mAllChanges.back().updated() = m.second->mEntry;
+    }
 }
 
 void
@@ -249,6 +301,8 @@ LedgerDeltaImpl::commit()
         mOuterDelta->mergeEntries(*this);
         mOuterDelta = nullptr;
     }
+    // the outer delta holds the changes from now on
+    mDb.getLedgerOverlay().remove(*this);
     *mHeader = mCurrentHeader.getHeader();
     mHeader = nullptr;
 }
@@ -258,21 +312,48 @@ LedgerDeltaImpl::rollback()
 {
     checkState();
     mHeader = nullptr;
-
+    mDb.getLedgerOverlay().remove(*this);
+
+    // entries are dropped from the cache directly, there is no need to
+    // look up a helper for every key
+    auto& cache = mDb.getEntryCache();
+    bool feesChanged = false;
+    bool assetPairsChanged = false;
+    bool keyValuesChanged = false;
+    auto drop = [&](LedgerKey const& key) {
+        cache.erase_if_exists(key);
+        feesChanged = feesChanged || key.type() == LedgerEntryType::FEE;
+        assetPairsChanged = assetPairsChanged ||
+                            key.type() == LedgerEntryType::ASSET_PAIR;
+        keyValuesChanged = keyValuesChanged ||
+                           key.type() == LedgerEntryType::KEY_VALUE;
+    };
     for (auto& d : mDelete)
     {
-        auto helper = EntryHelperProvider::getHelper(d.type());
-        helper->flushCachedEntry(d, mDb);
+        drop(d);
     }
     for (auto& n : mNew)
     {
-        auto helper = EntryHelperProvider::getHelper(n.first.type());
-        helper->flushCachedEntry(n.first, mDb);
+        drop(n.first);
     }
     for (auto& m : mMod)
     {
-        auto helper = EntryHelperProvider::getHelper(m.first.type());
-        helper->flushCachedEntry(m.first, mDb);
+        drop(m.first);
+    }
+
+    // the resident indexes may have been loaded with the changes being
+    // rolled back
+    if (feesChanged)
+    {
+        mDb.getFeeIndex().clear();
+    }
+    if (assetPairsChanged)
+    {
+        mDb.getAssetPairCache().clear();
+    }
+    if (keyValuesChanged)
+    {
+        mDb.getKeyValueIndex().clear();
     }
 }
 
@@ -280,8 +361,8 @@ void
 LedgerDeltaImpl::addCurrentMeta(LedgerEntryChanges& changes,
                                 LedgerKey const& key) const
 {
-    auto it = mPrevious.find(key);
-    if (it != mPrevious.end())
+    auto it = mPrevious->find(key);
+    if (it != mPrevious->end())
     {
         // if the old value is from a previous ledger we emit it
         auto const& e = it->second->mEntry;
@@ -443,7 +524,7 @@ LedgerDeltaImpl::getDatabase()
 const LedgerDeltaImpl::KeyEntryMap&
 LedgerDeltaImpl::getPreviousFrames() const
 {
-    return mPrevious;
+    return *mPrevious;
 }
 const std::set<LedgerKey, LedgerEntryIdCmp>&
 LedgerDeltaImpl::getDeletionFramesSet() const
@@ -34,21 +34,30 @@ class LedgerDeltaImpl : public LedgerDelta
     // all created/changed ledger entries:
     LedgerEntryChanges mAllChanges;
 
-    KeyEntryMap mPrevious;
+    // shared with the snapshots handed out by getState(), copied on write
+    std::shared_ptr<KeyEntryMap> mPrevious;
 
-    Database& mDb; // Used strictly for rollback of db entry cache.
+    Database& mDb; // Used for rollback of db entry cache and to register
+                   // nested deltas with the ledger overlay.
 
     bool mUpdateLastModified;
 
     void checkState();
-    void addEntry(EntryFrame::pointer entry);
-    void deleteEntry(EntryFrame::pointer entry);
-    void modEntry(EntryFrame::pointer entry);
+
+    // register the change without copying the frame and without adding it
+    // to mAllChanges
+    void insertNew(EntryFrame::pointer entry);
+    void insertDelete(LedgerKey const& key);
+    void insertMod(EntryFrame::pointer entry);
     void recordEntry(EntryFrame::pointer entry);
 
-    // merge "other" into current ledgerDelta
+    // merge "other" into current ledgerDelta; frames of "other" are shared,
+    // not copied, as a committed delta never changes them again
     void mergeEntries(LedgerDelta& other) override;
 
+    // appends the changes merged from a nested delta to mAllChanges
+    void addMergedChanges(LedgerDelta const& other);
+
     // helper method that adds a meta entry to "changes"
     // with the previous value of an entry if needed
     void addCurrentMeta(LedgerEntryChanges& changes,
@@ -103,7 +112,7 @@ class LedgerDeltaImpl : public LedgerDelta
     // performs sanity checks against the local state
     void checkAgainstDatabase(Application& app) const override;
 
-    KeyEntryMap
+    StateSnapshot
     getState() const override
     {
         return mPrevious;
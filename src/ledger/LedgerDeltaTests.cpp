@@ -342,3 +342,55 @@ TEST_CASE("Ledger delta", "[ledger][ledgerdelta]")
         }
     }
 }
+
+TEST_CASE("Ledger delta nested commit", "[ledger][ledgerdelta]")
+{
+    Config cfg(getTestConfig());
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+    LedgerHeader& curHeader = app->getLedgerManager().getCurrentLedgerHeader();
+
+    LedgerDeltaImpl deltaImpl(curHeader, app->getDatabase());
+    LedgerDelta& delta = deltaImpl;
+
+    std::vector<AccountFrame::pointer> accounts;
+    for (auto const& a : LedgerTestUtils::generateValidAccountEntries(2))
+    {
+        LedgerEntry le;
+        le.data.type(LedgerEntryType::ACCOUNT);
+        le.data.account() = a;
+        le.lastModifiedLedgerSeq = 1;
+        accounts.emplace_back(std::make_shared<AccountFrame>(le));
+    }
+    auto const& key = accounts[0]->getKey();
+
+    LedgerDeltaImpl opDeltaImpl(delta);
+    LedgerDelta& opDelta = opDeltaImpl;
+    opDelta.recordEntry(*accounts[0]);
+    AccountFrame updated(accounts[0]->mEntry);
+    updated.mEntry.lastModifiedLedgerSeq = delta.getHeader().ledgerSeq;
+    opDelta.modEntry(updated);
+
+    auto state = opDelta.getState();
+    opDelta.commit();
+
+    SECTION("frames are shared with the outer delta")
+    {
+        REQUIRE(delta.getModificationFrames().at(key) ==
+                opDelta.getModificationFrames().at(key));
+        REQUIRE(delta.getPreviousFrames().at(key) == state->at(key));
+        // previous state and update
+        REQUIRE(delta.getChanges().size() == 2);
+        REQUIRE(delta.getAllChanges().size() == 1);
+    }
+    SECTION("snapshot is not changed by later records")
+    {
+        auto outerState = delta.getState();
+        delta.recordEntry(*accounts[1]);
+        REQUIRE(outerState->size() == 1);
+        REQUIRE(delta.getPreviousFrames().size() == 2);
+        REQUIRE(state->size() == 1);
+        REQUIRE(state->at(key)->getLastModified() == 1);
+    }
+}
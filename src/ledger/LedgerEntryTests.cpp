@@ -8,6 +8,12 @@
 #include "main/test.h"
 #include "AccountFrame.h"
 #include "AccountHelper.h"
+#include "AssetPairHelper.h"
+#include "BalanceHelperLegacy.h"
+#include "KeyValueHelperLegacy.h"
+#include "database/EntryCache.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include "LedgerDeltaImpl.h"
 #include "xdrpp/autocheck.h"
 #include "ledger/LedgerTestUtils.h"
@@ -105,4 +111,163 @@ TEST_CASE("Ledger Entry tests", "[ledgerentry]")
         app->getLedgerManager().checkDbState();
     }
 }
+
+TEST_CASE("Balance batch load", "[ledgerentry][balance]")
+{
+    Config cfg(getTestConfig(0));
+
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+    Database& db = app->getDatabase();
+
+    auto balanceHelper = BalanceHelperLegacy::Instance();
+    auto& selects = app->getMetrics().NewTimer({"database", "select", "balance"});
+
+    LedgerHeader lh;
+    LedgerDeltaImpl delta(lh, db, false);
+
+    // more than fit into a single query
+    size_t const nBalances = EntryHelperLegacy::MAX_KEYS_PER_LOAD + 100;
+    auto owner = SecretKey::random().getPublicKey();
+    std::vector<BalanceID> balanceIDs;
+    for (size_t i = 0; i < nBalances; i++)
+    {
+        balanceIDs.push_back(BalanceKeyUtils::forAccount(owner, i + 1));
+        auto balance = BalanceFrame::createNew(balanceIDs.back(), owner, "USD");
+        balance->mEntry.data.balance().amount = i;
+        EntryHelperProvider::storeAddEntry(delta, db, balance->mEntry);
+    }
+    db.getEntryCache().clear();
+
+    auto missing = BalanceKeyUtils::forAccount(owner, nBalances + 1);
+    auto requested = balanceIDs;
+    requested.push_back(missing);
+    requested.push_back(balanceIDs.front());
+
+    auto before = selects.count();
+    auto loaded = balanceHelper->loadBalancesByID(requested, db);
+    REQUIRE(loaded.size() == nBalances);
+    REQUIRE(selects.count() - before == 2);
+
+    // everything, including the missing balance, is served from the cache
+    before = selects.count();
+    for (size_t i = 0; i < nBalances; i++)
+    {
+        auto balance = balanceHelper->loadBalance(balanceIDs[i], db);
+        REQUIRE(balance);
+        REQUIRE(balance->getAmount() == i);
+    }
+    REQUIRE(!balanceHelper->loadBalance(missing, db));
+    REQUIRE(selects.count() == before);
+
+    // changes are not hidden by the cache
+    auto changed = balanceHelper->mustLoadBalance(balanceIDs.front(), db);
+    changed->mEntry.data.balance().amount = 42;
+    EntryHelperProvider::storeChangeEntry(delta, db, changed->mEntry);
+    REQUIRE(balanceHelper->mustLoadBalance(balanceIDs.front(), db)->getAmount() == 42);
+
+    std::vector<LedgerKey> keys;
+    for (auto const& balanceID : {balanceIDs.front(), missing})
+    {
+        LedgerKey key;
+        key.type(LedgerEntryType::BALANCE);
+        key.balance().balanceID = balanceID;
+        keys.push_back(key);
+    }
+    REQUIRE(EntryHelperProvider::loadManyEntries(keys, db).size() == 1);
+}
+
+TEST_CASE("Asset pair lookup cache", "[ledgerentry][assetpair]")
+{
+    Config cfg(getTestConfig(0));
+
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+    Database& db = app->getDatabase();
+
+    auto assetPairHelper = AssetPairHelper::Instance();
+    auto& selects = app->getMetrics().NewTimer({"database", "select", "assetPair"});
+
+    LedgerHeader lh;
+    LedgerDeltaImpl delta(lh, db, false);
+
+    auto pair = AssetPairFrame::create("BTC", "USD", 100 * ONE, 100 * ONE, 0, 0, 0);
+    EntryHelperProvider::storeAddEntry(delta, db, pair->mEntry);
+    REQUIRE(db.getAssetPairCache().size() == 0);
+
+    // reversed lookup finds the pair and is served from the cache afterwards
+    auto found = assetPairHelper->findAssetPairForAssets("USD", "BTC", db);
+    REQUIRE(found);
+    REQUIRE(found->getBaseAsset() == "BTC");
+    auto before = selects.count();
+    REQUIRE(assetPairHelper->findAssetPairForAssets("USD", "BTC", db) == found);
+    REQUIRE(assetPairHelper->tryLoadAssetPairForAssets("USD", "BTC", db)->getCurrentPrice() == 100 * ONE);
+    REQUIRE(!assetPairHelper->findAssetPairForAssets("USD", "EUR", db));
+    REQUIRE(!assetPairHelper->findAssetPairForAssets("USD", "EUR", db));
+    REQUIRE(selects.count() == before + 2);
+
+    // writes to asset_pair invalidate the lookups
+    pair->setCurrentPrice(200 * ONE);
+    EntryHelperProvider::storeChangeEntry(delta, db, pair->mEntry);
+    REQUIRE(db.getAssetPairCache().size() == 0);
+    REQUIRE(assetPairHelper->findAssetPairForAssets("USD", "BTC", db)->getCurrentPrice() == 200 * ONE);
+
+    uint64_t converted = 0;
+    REQUIRE(found->convertAmount("USD", ONE, ROUND_UP, converted));
+    REQUIRE(converted == 100 * ONE);
+}
+
+TEST_CASE("Key value index", "[ledgerentry][keyvalue]")
+{
+    Config cfg(getTestConfig(0));
+
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+    Database& db = app->getDatabase();
+
+    auto keyValueHelper = KeyValueHelperLegacy::Instance();
+    auto& loads =
+        app->getMetrics().NewTimer({"database", "select", "key-value-index"});
+
+    LedgerHeader lh;
+    LedgerDeltaImpl deltaImpl(lh, db, false);
+    LedgerDelta& delta = deltaImpl;
+
+    string256 const key = "max_invoices_count";
+    LedgerEntry entry;
+    entry.data.type(LedgerEntryType::KEY_VALUE);
+    entry.data.keyValue().key = key;
+    entry.data.keyValue().value.type(KeyValueEntryType::UINT32);
+    entry.data.keyValue().value.ui32Value() = 10;
+    EntryHelperProvider::storeAddEntry(delta, db, entry);
+    REQUIRE(!db.getKeyValueIndex().isLoaded());
+
+    auto value = [&]() {
+        return keyValueHelper->loadKeyValue(key, db)
+            ->getKeyValue()
+            .value.ui32Value();
+    };
+
+    // the table is loaded once, lookups are resident afterwards
+    auto before = loads.count();
+    REQUIRE(value() == 10);
+    REQUIRE(!keyValueHelper->loadKeyValue("unknown", db));
+    REQUIRE(value() == 10);
+    REQUIRE(loads.count() == before + 1);
+
+    // writes to key_value_entry drop the index
+    entry.data.keyValue().value.ui32Value() = 20;
+    EntryHelperProvider::storeChangeEntry(delta, db, entry);
+    REQUIRE(!db.getKeyValueIndex().isLoaded());
+    REQUIRE(value() == 20);
+    REQUIRE(loads.count() == before + 2);
+
+    // so does rolling back a delta with key value changes
+    REQUIRE(db.getKeyValueIndex().isLoaded());
+    delta.rollback();
+    REQUIRE(!db.getKeyValueIndex().isLoaded());
+}
 }
@@ -9,10 +9,13 @@
 #include "herder/LedgerCloseData.h"
 #include "ledger/LedgerDeltaImpl.h"
 #include "ledger/LedgerManagerImpl.h"
+#include "ledger/LedgerOverlay.h"
+#include "ledger/AssetPairCache.h"
 #include "ledger/AssetPairFrame.h"
 #include "ledger/AccountHelper.h"
 
 #include "overlay/OverlayManager.h"
+#include "transactions/TxHistoryWriter.h"
 #include "util/make_unique.h"
 #include "util/format.h"
 
@@ -712,24 +715,41 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
 
     auto ledgerTime = mLedgerClose.TimeScope();
 
+    // asset pair lookups are only reused within a ledger
+    getDatabase().getAssetPairCache().clear();
+
     auto const& sv = ledgerData.mValue;
     mCurrentLedger->getHeader().scpValue = sv;
 
     LedgerDeltaImpl ledgerDeltaImpl(mCurrentLedger->getHeader(), getDatabase());
     LedgerDelta& ledgerDelta = ledgerDeltaImpl;
 
+    // accounts and balances are written once, when the ledger is applied
+    LedgerOverlayScope overlayScope(getDatabase().getLedgerOverlay(),
+                                    ledgerDelta);
+
     // the transaction set that was agreed upon by consensus
     // was sorted by hash; we reorder it so that transactions are
     // sorted such that sequence numbers are respected
     vector<TransactionFramePtr> txs = ledgerData.mTxSet->sortForApply();
 
+    // history rows of all transactions are written in bulk once they are
+    // applied
+    TxHistoryWriter historyWriter(
+        getDatabase(),
+        mApp.getConfig().ARTIFICIALLY_WRITE_TX_HISTORY_ROW_BY_ROW_FOR_TESTING
+            ? 1
+            : TxHistoryWriter::MAX_ROWS_PER_INSERT);
+
     // first, charge fees
-    processFeesSeqNums(txs, ledgerDelta);
+    processFeesSeqNums(txs, ledgerDelta, historyWriter);
 
     TransactionResultSet txResultSet;
     txResultSet.results.reserve(txs.size());
 
-    applyTransactions(txs, ledgerDelta, txResultSet);
+    applyTransactions(txs, ledgerDelta, txResultSet, historyWriter);
+
+    historyWriter.flush();
 
     ledgerDelta.getHeader().txSetResultHash =
         sha256(xdr::xdr_to_opaque(txResultSet));
@@ -773,6 +793,8 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
         }
     }
 
+    getDatabase().getLedgerOverlay().flush(getDatabase());
+
     ledgerDelta.checkAgainstDatabase(mApp);
 
     ledgerDelta.commit();
@@ -803,6 +825,13 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     mApp.getDatabase().clearPreparedStatementCache();
     txscope.commit();
 
+    // replay protection only sees transactions once their txtiming rows are
+    // committed; anything that expired before this ledger is rejected as
+    // too late by TransactionFrame::commonValid anyway
+    historyWriter.indexTimings();
+    getDatabase().getTxTimingIndex().expire(
+        getLastClosedLedgerHeader().header.scpValue.closeTime);
+
     // step 3
     hm.publishQueuedHistory();
     hm.logAndUpdateStatus(true);
@@ -847,7 +876,8 @@ LedgerManagerImpl::advanceLedgerPointers()
 
 void
 LedgerManagerImpl::processFeesSeqNums(std::vector<TransactionFramePtr>& txs,
-                                      LedgerDelta& delta)
+                                      LedgerDelta& delta,
+                                      TxHistoryWriter& historyWriter)
 {
     CLOG(DEBUG, "Ledger") << "processing fees and sequence numbers";
     int index = 0;
@@ -858,9 +888,11 @@ LedgerManagerImpl::processFeesSeqNums(std::vector<TransactionFramePtr>& txs,
         {
             LedgerDeltaImpl thisTxDeltaImpl(delta);
             LedgerDelta& thisTxDelta = thisTxDeltaImpl;
-            tx->storeTransactionFee(*this, thisTxDelta.getChanges(), ++index);
+            tx->storeTransactionFee(*this, historyWriter,
+                                    thisTxDelta.getChanges(), ++index);
             tx->processSeqNum();
-            tx->storeTransactionTiming(*this, tx->getTimeBounds().maxTime);
+            tx->storeTransactionTiming(historyWriter,
+                                       tx->getTimeBounds().maxTime);
             thisTxDelta.commit();
         }
         sqlTx.commit();
@@ -888,7 +920,8 @@ void handle_eptr(std::exception_ptr eptr) // passing by value is ok
 void
 LedgerManagerImpl::applyTransactions(std::vector<TransactionFramePtr>& txs,
                                      LedgerDelta& ledgerDelta,
-                                     TransactionResultSet& txResultSet)
+                                     TransactionResultSet& txResultSet,
+                                     TxHistoryWriter& historyWriter)
 {
     CLOG(DEBUG, "Tx") << "applyTransactions: ledger = "
                       << mCurrentLedger->getHeader().ledgerSeq;
@@ -905,7 +938,7 @@ LedgerManagerImpl::applyTransactions(std::vector<TransactionFramePtr>& txs,
                 << " tx#" << index << " = " << hexAbbrev(tx->getFullHash())
                 << " txsalt=" << tx->getSalt() << " (@ "
                 << mApp.getConfig().toShortString(tx->getSourceID()) << ")";
-            vector<LedgerDelta::KeyEntryMap> stateBeforeOp;
+            vector<LedgerDelta::StateSnapshot> stateBeforeOp;
             if (tx->apply(delta, tm, mApp, stateBeforeOp))
             {
                 delta.commit();
@@ -928,7 +961,7 @@ LedgerManagerImpl::applyTransactions(std::vector<TransactionFramePtr>& txs,
             handle_eptr(eptr);
             tx->getResult().result.code(TransactionResultCode::txINTERNAL_ERROR);
         }
-        tx->storeTransaction(*this, tm, ++index, txResultSet);
+        tx->storeTransaction(*this, historyWriter, tm, ++index, txResultSet);
     }
 }
 
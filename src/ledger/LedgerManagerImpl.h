@@ -29,6 +29,7 @@ namespace stellar
 class Application;
 class Database;
 class LedgerDelta;
+class TxHistoryWriter;
 
 class LedgerManagerImpl : public LedgerManager
 {
@@ -54,10 +55,12 @@ class LedgerManagerImpl : public LedgerManager
                          LedgerHeaderHistoryEntry const& lastClosed);
 
     void processFeesSeqNums(std::vector<TransactionFramePtr>& txs,
-                            LedgerDelta& delta);
+                            LedgerDelta& delta,
+                            TxHistoryWriter& historyWriter);
     void applyTransactions(std::vector<TransactionFramePtr>& txs,
                            LedgerDelta& ledgerDelta,
-                           TransactionResultSet& txResultSet);
+                           TransactionResultSet& txResultSet,
+                           TxHistoryWriter& historyWriter);
 
     void closeLedgerHelper(LedgerDelta const& delta);
     void advanceLedgerPointers();
@@ -0,0 +1,229 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerOverlay.h"
+#include "database/Database.h"
+#include "ledger/AccountHelper.h"
+#include "ledger/BalanceHelperLegacy.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace stellar
+{
+
+void
+LedgerOverlay::begin(LedgerDelta const& ledgerDelta)
+{
+    mDeltas.assign(1, &ledgerDelta);
+}
+
+void
+LedgerOverlay::flush(Database& db)
+{
+    if (mDeltas.empty())
+    {
+        throw std::runtime_error("ledger overlay is not active");
+    }
+
+    auto const& ledgerDelta = *mDeltas.front();
+    end();
+
+    auto& cache = db.getEntryCache();
+    for (auto const& key : ledgerDelta.getDeletionFramesSet())
+    {
+        switch (key.type())
+        {
+        case LedgerEntryType::ACCOUNT:
+            AccountHelper::Instance()->deleteAccount(db, key);
+            break;
+        case LedgerEntryType::BALANCE:
+            BalanceHelperLegacy::Instance()->deleteBalance(db, key);
+            break;
+        default:
+            continue;
+        }
+        cache.erase_if_exists(key);
+    }
+
+    auto write = [&](LedgerDelta::KeyEntryMap const& entries, bool insert) {
+        for (auto const& e : entries)
+        {
+            switch (e.first.type())
+            {
+            case LedgerEntryType::ACCOUNT:
+                // the signers of the delta's copy are always compared with
+                // the stored ones
+                AccountHelper::Instance()->writeAccount(db, insert,
+                                                        e.second->mEntry, true);
+                break;
+            case LedgerEntryType::BALANCE:
+                BalanceHelperLegacy::Instance()->writeBalance(
+                    db, insert, e.second->mEntry);
+                break;
+            default:
+                continue;
+            }
+            cache.erase_if_exists(e.first);
+        }
+    };
+    write(ledgerDelta.getCreationFrames(), true);
+    write(ledgerDelta.getModificationFrames(), false);
+}
+
+void
+LedgerOverlay::end()
+{
+    mDeltas.clear();
+}
+
+bool
+LedgerOverlay::isActive() const
+{
+    return !mDeltas.empty();
+}
+
+void
+LedgerOverlay::nest(LedgerDelta const& delta, LedgerDelta const& outerDelta)
+{
+    if (std::find(mDeltas.begin(), mDeltas.end(), &outerDelta) !=
+        mDeltas.end())
+    {
+        mDeltas.push_back(&delta);
+    }
+}
+
+void
+LedgerOverlay::remove(LedgerDelta const& delta)
+{
+    // nested deltas are almost always closed innermost first
+    auto it = std::find(mDeltas.rbegin(), mDeltas.rend(), &delta);
+    if (it != mDeltas.rend())
+    {
+        mDeltas.erase(std::next(it).base());
+    }
+}
+
+bool
+LedgerOverlay::defers(LedgerDelta const* delta, LedgerEntryType type) const
+{
+    return delta && isWriteBehind(type) &&
+           std::find(mDeltas.begin(), mDeltas.end(), delta) != mDeltas.end();
+}
+
+bool
+LedgerOverlay::find(LedgerKey const& key, EntryFrame::pointer& entry) const
+{
+    if (!isWriteBehind(key.type()))
+    {
+        return false;
+    }
+
+    for (auto it = mDeltas.rbegin(); it != mDeltas.rend(); ++it)
+    {
+        auto const& delta = **it;
+        if (delta.getDeletionFramesSet().count(key) != 0)
+        {
+            entry = nullptr;
+            return true;
+        }
+
+        auto const& created = delta.getCreationFrames();
+        auto c = created.find(key);
+        if (c != created.end())
+        {
+            entry = c->second;
+            return true;
+        }
+
+        auto const& modified = delta.getModificationFrames();
+        auto m = modified.find(key);
+        if (m != modified.end())
+        {
+            entry = m->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+LedgerOverlay::merge(LedgerEntryType type,
+                     std::function<void(EntryProcessor const&)> const& load,
+                     std::function<bool(LedgerEntry const&)> const& matches,
+                     EntryProcessor const& processor) const
+{
+    if (mDeltas.empty() || !isWriteBehind(type))
+    {
+        load(processor);
+        return;
+    }
+
+    auto entries = pending(type);
+    load([&](LedgerEntry const& row) {
+        if (entries.find(LedgerEntryKey(row)) == entries.end())
+        {
+            processor(row);
+        }
+    });
+    for (auto const& e : entries)
+    {
+        if (e.second && matches(e.second->mEntry))
+        {
+            processor(e.second->mEntry);
+        }
+    }
+}
+
+bool
+LedgerOverlay::isWriteBehind(LedgerEntryType type)
+{
+    return type == LedgerEntryType::ACCOUNT ||
+           type == LedgerEntryType::BALANCE;
+}
+
+LedgerDelta::KeyEntryMap
+LedgerOverlay::pending(LedgerEntryType type) const
+{
+    LedgerDelta::KeyEntryMap entries;
+    // inner deltas override the state of the outer ones
+    for (auto delta : mDeltas)
+    {
+        for (auto const& key : delta->getDeletionFramesSet())
+        {
+            if (key.type() == type)
+            {
+                entries[key] = nullptr;
+            }
+        }
+        for (auto const& e : delta->getCreationFrames())
+        {
+            if (e.first.type() == type)
+            {
+                entries[e.first] = e.second;
+            }
+        }
+        for (auto const& e : delta->getModificationFrames())
+        {
+            if (e.first.type() == type)
+            {
+                entries[e.first] = e.second;
+            }
+        }
+    }
+    return entries;
+}
+
+LedgerOverlayScope::LedgerOverlayScope(LedgerOverlay& overlay,
+                                       LedgerDelta const& ledgerDelta)
+    : mOverlay(overlay)
+{
+    mOverlay.begin(ledgerDelta);
+}
+
+LedgerOverlayScope::~LedgerOverlayScope()
+{
+    mOverlay.end();
+}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerDelta.h"
+#include "util/NonCopyable.h"
+#include <functional>
+#include <vector>
+
+namespace stellar
+{
+class Database;
+
+/**
+ * Write-behind state of the ledger being closed for accounts and balances.
+ *
+ * Payments, fees and sales touch the same few balances and accounts many
+ * times per ledger and every touch used to be an UPDATE. While a ledger
+ * closes, the helpers of those types only record their writes in the
+ * LedgerDelta, reads look up the pending state of the active deltas before
+ * going to the database, and flush() writes every changed entry once.
+ *
+ * LedgerManager activates the overlay with the delta of the ledger being
+ * closed; nested deltas register themselves while they are open, so changes
+ * of a transaction that fails are dropped along with its delta.
+ */
+class LedgerOverlay : NonMovableOrCopyable
+{
+  public:
+    typedef std::function<void(LedgerEntry const&)> EntryProcessor;
+
+    // Defers writes recorded in `ledgerDelta` and the deltas nested in it.
+    void begin(LedgerDelta const& ledgerDelta);
+
+    // Writes the changes of the ledger delta to the database, one statement
+    // per entry, and deactivates the overlay.
+    void flush(Database& db);
+
+    // Deactivates the overlay, pending changes are dropped.
+    void end();
+
+    bool isActive() const;
+
+    // Registers `delta` if `outerDelta` is active, forgets it on
+    // remove(delta).
+    void nest(LedgerDelta const& delta, LedgerDelta const& outerDelta);
+    void remove(LedgerDelta const& delta);
+
+    // Returns true if the write of an entry of `type` recorded in `delta`
+    // has to be left to flush().
+    bool defers(LedgerDelta const* delta, LedgerEntryType type) const;
+
+    // Returns true if `key` has pending changes, `entry` is then set to the
+    // pending entry or to nullptr if it was deleted.
+    bool find(LedgerKey const& key, EntryFrame::pointer& entry) const;
+
+    // Runs a range query over entries of `type` as the ledger being closed
+    // sees it: `load` hands the rows it reads to the processor it is given,
+    // which skips the entries with pending changes, then the pending entries
+    // for which `matches` (the WHERE clause of the query) holds are
+    // processed.
+    void merge(LedgerEntryType type,
+               std::function<void(EntryProcessor const&)> const& load,
+               std::function<bool(LedgerEntry const&)> const& matches,
+               EntryProcessor const& processor) const;
+
+  private:
+    static bool isWriteBehind(LedgerEntryType type);
+
+    // pending entries of `type`, deleted ones map to nullptr
+    LedgerDelta::KeyEntryMap pending(LedgerEntryType type) const;
+
+    // active deltas, outermost first
+    std::vector<LedgerDelta const*> mDeltas;
+};
+
+// Keeps the overlay active with `ledgerDelta` for its lifetime; changes that
+// were not flushed by then are dropped.
+class LedgerOverlayScope : NonMovableOrCopyable
+{
+    LedgerOverlay& mOverlay;
+
+  public:
+    LedgerOverlayScope(LedgerOverlay& overlay, LedgerDelta const& ledgerDelta);
+    ~LedgerOverlayScope();
+};
+}
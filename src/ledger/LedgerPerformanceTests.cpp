@@ -7,12 +7,23 @@
 #include "main/test.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerHeaderFrame.h"
+#include "ledger/LedgerDeltaImpl.h"
+#include "ledger/LedgerTestUtils.h"
+#include "ledger/AccountFrame.h"
 #include "transactions/test/TxTests.h"
 #include "database/Database.h"
 #include "simulation/Simulation.h"
 #include "bucket/BucketManager.h"
 #include "util/Math.h"
 #include "test/test_marshaler.h"
+#include "transactions/TransactionFrame.h"
+#include "transactions/TxHistoryWriter.h"
+#include "database/XDRBlob.h"
+#include "herder/LedgerCloseData.h"
+#include "herder/TxSetFrame.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include <chrono>
 
 using namespace stellar;
 using namespace std;
@@ -210,3 +221,292 @@ TEST_CASE("ledger performance test", "[performance][hide]")
         LOG(INFO) << "done";
     }
 }
+
+namespace
+{
+// Writes `nLedgers` ledgers worth of history rows (`nTxs` transactions each)
+// through a TxHistoryWriter.
+void
+writeTxHistory(Database& db, uint32_t firstLedger, int nLedgers, int nTxs)
+{
+    std::string const payload(512, 'A');
+    for (int l = 0; l < nLedgers; l++)
+    {
+        soci::transaction sqlTx(db.getSession());
+        TxHistoryWriter writer(db);
+        auto ledgerSeq = firstLedger + l;
+        for (int i = 1; i <= nTxs; i++)
+        {
+            auto txHash = sha256(std::to_string(ledgerSeq) + ":" +
+                                 std::to_string(i));
+            auto txID = binToHex(txHash);
+            writer.addTransactionFee(txID, ledgerSeq, i, payload);
+            writer.addTransactionTiming(txHash, ledgerSeq);
+            writer.addTransaction(txID, ledgerSeq, i, payload, payload,
+                                  payload);
+        }
+        writer.flush();
+        sqlTx.commit();
+        writer.indexTimings();
+    }
+}
+}
+
+TEST_CASE("tx history writer", "[ledger][txhistory]")
+{
+    Config const& cfg = getTestConfig(0, Config::TESTDB_IN_MEMORY_SQLITE);
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+    auto& db = app->getDatabase();
+
+    int const nTxs =
+        static_cast<int>(TxHistoryWriter::MAX_ROWS_PER_INSERT * 2 + 3);
+    writeTxHistory(db, 100, 1, nTxs);
+
+    auto countRows = [&db](std::string const& table) {
+        int count = 0;
+        db.getSession() << "SELECT COUNT(*) FROM " << table,
+            soci::into(count);
+        return count;
+    };
+    REQUIRE(countRows("txhistory") == nTxs);
+    REQUIRE(countRows("txfeehistory") == nTxs);
+    REQUIRE(countRows("txtiming") == nTxs);
+    auto firstTx = sha256(std::to_string(100) + ":" + std::to_string(1));
+    REQUIRE(TransactionFrame::timingExists(db, firstTx));
+    REQUIRE(db.getTxTimingIndex().size() == static_cast<size_t>(nTxs));
+
+    SECTION("index follows committed rows")
+    {
+        writeTxHistory(db, 101, 1, 1);
+        REQUIRE(TransactionFrame::timingExists(
+            db, sha256(std::to_string(101) + ":" + std::to_string(1))));
+        REQUIRE(db.getTxTimingIndex().size() ==
+                static_cast<size_t>(nTxs + 1));
+    }
+    SECTION("expired rows are dropped from table and index")
+    {
+        // valid_before of the rows is their ledger sequence
+        TransactionFrame::deleteOldEntries(db, 0, 101);
+        REQUIRE(countRows("txtiming") == 0);
+        REQUIRE(!TransactionFrame::timingExists(db, firstTx));
+        REQUIRE(db.getTxTimingIndex().size() == 0);
+    }
+    SECTION("index is rebuilt from the table")
+    {
+        db.getTxTimingIndex().clear();
+        REQUIRE(TransactionFrame::timingExists(db, firstTx));
+        REQUIRE(db.getTxTimingIndex().size() == static_cast<size_t>(nTxs));
+    }
+}
+
+TEST_CASE("tx history write performance", "[performance][txhistory][hide]")
+{
+    int const nLedgers = 10;
+    int const nTxs = 1000;
+
+    for (bool rowByRow : {true, false})
+    {
+        Config cfg = getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE);
+        cfg.ARTIFICIALLY_WRITE_TX_HISTORY_ROW_BY_ROW_FOR_TESTING = rowByRow;
+        VirtualClock clock;
+        Application::pointer app = Application::create(clock, cfg);
+        app->start();
+        auto& lm = app->getLedgerManager();
+
+        auto root = txtest::getRoot();
+        Salt rootSeq = 1;
+        auto closeTime = txtest::getTestDate(1, 7, 2017);
+        std::chrono::milliseconds closing(0);
+        for (int l = 0; l < nLedgers; l++)
+        {
+            auto txSet =
+                make_shared<TxSetFrame>(lm.getLastClosedLedgerHeader().hash);
+            for (int i = 0; i < nTxs; i++)
+            {
+                txSet->add(txtest::createCreateAccountTx(
+                    app->getNetworkID(), root, SecretKey::random(), rootSeq++,
+                    AccountType::GENERAL));
+            }
+            txSet->sortForHash();
+            StellarValue sv(txSet->getContentsHash(), closeTime + l,
+                            emptyUpgradeSteps,
+                            StellarValue::_ext_t(LedgerVersion::EMPTY_VERSION));
+            LedgerCloseData ledgerData(lm.getLedgerNum(), txSet, sv);
+
+            auto start = std::chrono::steady_clock::now();
+            lm.closeLedger(ledgerData);
+            closing += std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+        }
+
+        int rows = 0;
+        app->getDatabase().getSession() << "SELECT COUNT(*) FROM txhistory",
+            soci::into(rows);
+        REQUIRE(rows == nLedgers * nTxs);
+
+        LOG(INFO) << nLedgers << " ledgers x " << nTxs << " txs closed in "
+                  << closing.count() << "ms with tx history written "
+                  << (rowByRow ? "row by row" : "in batches");
+    }
+}
+
+namespace
+{
+// Account frame counting how many times it is copied, i.e. how many frames
+// the deltas it goes through allocate.
+class CountingAccountFrame : public AccountFrame
+{
+  public:
+    static size_t copies;
+
+    explicit CountingAccountFrame(LedgerEntry const& from) : AccountFrame(from)
+    {
+    }
+
+    EntryFrame::pointer
+    copy() const override
+    {
+        copies++;
+        return std::make_shared<CountingAccountFrame>(mEntry);
+    }
+};
+
+size_t CountingAccountFrame::copies = 0;
+}
+
+TEST_CASE("ledger delta commit performance",
+          "[performance][ledgerdelta][hide]")
+{
+    Config const& cfg = getTestConfig();
+    VirtualClock clock;
+    Application::pointer app = Application::create(clock, cfg);
+    app->start();
+
+    int const nLedgers = 10;
+    int const nTxs = 1000;
+    int const nOps = 5;
+    int const nEntriesPerOp = 4;
+
+    std::vector<std::shared_ptr<CountingAccountFrame>> accounts;
+    for (auto const& a : LedgerTestUtils::generateValidAccountEntries(5000))
+    {
+        LedgerEntry le;
+        le.data.type(LedgerEntryType::ACCOUNT);
+        le.data.account() = a;
+        le.lastModifiedLedgerSeq = 1;
+        accounts.emplace_back(std::make_shared<CountingAccountFrame>(le));
+    }
+
+    // op -> tx -> ledger nesting of TransactionFrameImpl::applyTx and
+    // LedgerManagerImpl::applyTransactions
+    CountingAccountFrame::copies = 0;
+    auto header = app->getLedgerManager().getCurrentLedgerHeader();
+    size_t next = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int l = 0; l < nLedgers; l++)
+    {
+        LedgerDeltaImpl ledgerDeltaImpl(header, app->getDatabase());
+        LedgerDelta& ledgerDelta = ledgerDeltaImpl;
+        for (int t = 0; t < nTxs; t++)
+        {
+            LedgerDeltaImpl txDeltaImpl(ledgerDelta);
+            LedgerDelta& txDelta = txDeltaImpl;
+            std::vector<LedgerDelta::StateSnapshot> stateBeforeOp;
+            for (int o = 0; o < nOps; o++)
+            {
+                LedgerDeltaImpl opDeltaImpl(txDelta);
+                LedgerDelta& opDelta = opDeltaImpl;
+                for (int e = 0; e < nEntriesPerOp; e++)
+                {
+                    auto& account = *accounts[next++ % accounts.size()];
+                    opDelta.recordEntry(account);
+                    opDelta.modEntry(account);
+                }
+                stateBeforeOp.push_back(opDelta.getState());
+                opDelta.commit();
+            }
+            txDelta.commit();
+        }
+        ledgerDelta.commit();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    LOG(INFO) << nLedgers << " ledgers x " << nTxs << " txs x " << nOps
+              << " ops x " << nEntriesPerOp << " entries: "
+              << CountingAccountFrame::copies / nLedgers
+              << " frames allocated per ledger close, " << elapsed.count()
+              << "ms";
+}
+
+#ifdef USE_POSTGRES
+TEST_CASE("xdr blob load performance", "[performance][txhistory][hide]")
+{
+    int const nLedgers = 50;
+    int const nTxs = 200;
+    int const nBodies = 100000;
+
+    for (bool binary : {false, true})
+    {
+        Config cfg = getTestConfig(0, Config::TESTDB_POSTGRESQL);
+        cfg.BINARY_XDR_BLOBS = binary;
+        VirtualClock clock;
+        Application::pointer app = Application::create(clock, cfg);
+        app->start();
+        auto& db = app->getDatabase();
+        REQUIRE(db.hasBinaryXDRBlobs() == binary);
+
+        // history publication reads results and fee changes per ledger
+        TransactionResultPair resultPair;
+        auto result = XDRBlob::encodeObject(db, resultPair);
+        auto changes = XDRBlob::encodeObject(db, LedgerEntryChanges());
+        for (int l = 0; l < nLedgers; l++)
+        {
+            soci::transaction sqlTx(db.getSession());
+            TxHistoryWriter writer(db);
+            uint32_t ledgerSeq = 1000 + l;
+            for (int i = 1; i <= nTxs; i++)
+            {
+                auto txID = binToHex(sha256(std::to_string(ledgerSeq) + ":" +
+                                            std::to_string(i)));
+                writer.addTransaction(txID, ledgerSeq, i, result, result,
+                                      result);
+                writer.addTransactionFee(txID, ledgerSeq, i, changes);
+            }
+            writer.flush();
+            sqlTx.commit();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int l = 0; l < nLedgers; l++)
+        {
+            REQUIRE(TransactionFrame::getTransactionHistoryResults(db, 1000 + l)
+                        .results.size() == static_cast<size_t>(nTxs));
+            REQUIRE(TransactionFrame::getTransactionFeeMeta(db, 1000 + l)
+                        .size() == static_cast<size_t>(nTxs));
+        }
+        auto history = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        // decoding of a reviewable request sized body
+        xdr::opaque_vec<> body(2048, 0x5a);
+        auto encodedBody = XDRBlob::encodeObject(db, body);
+        std::vector<uint8_t> buffer;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nBodies; i++)
+        {
+            XDRBlob::decodeObject(db, encodedBody, buffer, body);
+        }
+        auto bodies = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        LOG(INFO) << (binary ? "binary" : "base64") << " XDR blobs: "
+                  << nLedgers << " ledgers x " << nTxs
+                  << " txs of history loaded in " << history.count()
+                  << "ms, " << nBodies << " request bodies decoded in "
+                  << bodies.count() << "ms";
+    }
+}
+#endif
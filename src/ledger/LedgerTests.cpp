@@ -11,9 +11,13 @@
 #include "ledger/EntryHelperLegacy.h"
 #include "ledger/AccountFrame.h"
 #include "ledger/AccountHelper.h"
+#include "ledger/BalanceHelperLegacy.h"
+#include "ledger/LedgerOverlay.h"
 #include <xdrpp/autocheck.h>
 #include "LedgerTestUtils.h"
 #include "test/test_marshaler.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 
 using namespace stellar;
 
@@ -138,3 +142,141 @@ TEST_CASE("DB cache interaction with transactions", "[ledger][dbcache]")
 
     CHECK(accountType0 == acc->getAccount().accountType);
 }
+
+TEST_CASE("ledger overlay defers account and balance writes", "[ledger][overlay]")
+{
+    Config::TestDbMode mode = Config::TESTDB_ON_DISK_SQLITE;
+#ifdef USE_POSTGRES
+    if (!force_sqlite)
+        mode = Config::TESTDB_POSTGRESQL;
+#endif
+
+    VirtualClock clock;
+    Application::pointer app =
+        Application::create(clock, getTestConfig(0, mode));
+    app->start();
+
+    auto& db = app->getDatabase();
+    auto& session = db.getSession();
+    auto& header = app->getLedgerManager().getCurrentLedgerHeader();
+    auto& updates = app->getMetrics().NewTimer({"database", "update", "balance"});
+    auto balanceHelper = BalanceHelperLegacy::Instance();
+    auto accountHelper = AccountHelper::Instance();
+
+    LedgerEntry balance;
+    do
+    {
+        balance = EntryHelperProvider::fromXDREntry(
+                      LedgerTestUtils::generateValidLedgerEntry(3))->mEntry;
+    } while (balance.data.type() != LedgerEntryType::BALANCE);
+    auto const& balanceEntry = balance.data.balance();
+
+    LedgerEntry account;
+    account.data.type(LedgerEntryType::ACCOUNT);
+    account.data.account() = LedgerTestUtils::generateValidAccountEntry(3);
+    {
+        // roles are references to account_roles
+        AccountFrame frame(account);
+        frame.setAccountRole(nullptr);
+        account = frame.mEntry;
+    }
+    auto const& accountID = account.data.account().accountID;
+
+    {
+        LedgerDeltaImpl deltaImpl(header, db);
+        LedgerDelta& delta = deltaImpl;
+        EntryHelperProvider::storeAddEntry(delta, db, balance);
+        delta.commit();
+    }
+
+    auto storedAmount = [&]() -> uint64_t
+    {
+        uint64_t amount = 0;
+        auto balanceID = BalanceKeyUtils::toStrKey(balanceEntry.balanceID);
+        session << "SELECT amount FROM balance WHERE balance_id = :id",
+            soci::into(amount), soci::use(balanceID);
+        return amount;
+    };
+    auto const stored = storedAmount();
+    auto const updatesBefore = updates.count();
+
+    LedgerDeltaImpl ledgerDeltaImpl(header, db);
+    LedgerDelta& ledgerDelta = ledgerDeltaImpl;
+    LedgerOverlayScope overlayScope(db.getLedgerOverlay(), ledgerDelta);
+
+    // every transaction touches the balance, every third one fails
+    uint64_t expected = balanceEntry.amount;
+    for (uint64_t i = 0; i < 12; i++)
+    {
+        LedgerDeltaImpl txDeltaImpl(ledgerDelta);
+        LedgerDelta& txDelta = txDeltaImpl;
+        auto frame =
+            balanceHelper->mustLoadBalance(balanceEntry.balanceID, db, &txDelta);
+        REQUIRE(frame->getAmount() == expected);
+
+        LedgerEntry changed = frame->mEntry;
+        changed.data.balance().amount = i;
+        EntryHelperProvider::storeChangeEntry(txDelta, db, changed);
+        REQUIRE(balanceHelper->loadBalance(balanceEntry.balanceID, db)
+                    ->getAmount() == i);
+
+        if (i % 3 != 2)
+        {
+            txDelta.commit();
+            expected = i;
+        }
+    }
+
+    {
+        LedgerDeltaImpl txDeltaImpl(ledgerDelta);
+        LedgerDelta& txDelta = txDeltaImpl;
+        EntryHelperProvider::storeAddEntry(txDelta, db, account);
+        txDelta.commit();
+    }
+
+    // nothing is written yet, but reads see the pending state
+    REQUIRE(updates.count() == updatesBefore);
+    REQUIRE(storedAmount() == stored);
+    auto balances = balanceHelper->loadBalances(balanceEntry.accountID,
+                                                balanceEntry.asset, db);
+    REQUIRE(balances.size() == 1);
+    REQUIRE(balances[0]->getAmount() == expected);
+    REQUIRE(accountHelper->exists(accountID, db));
+    uint64_t accounts = 0;
+    auto accountIDStr = PubKeyUtils::toStrKey(accountID);
+    session << "SELECT COUNT(*) FROM accounts WHERE accountid = :id",
+        soci::into(accounts), soci::use(accountIDStr);
+    REQUIRE(accounts == 0);
+
+    SECTION("changes are written once")
+    {
+        db.getLedgerOverlay().flush(db);
+
+        REQUIRE(updates.count() == updatesBefore + 1);
+        REQUIRE(storedAmount() == expected);
+        auto loaded = accountHelper->loadAccount(accountID, db);
+        REQUIRE(!!loaded);
+        REQUIRE(loaded->getAccount().signers.size() ==
+                account.data.account().signers.size());
+    }
+
+    SECTION("deleted balances are only deleted")
+    {
+        {
+            LedgerDeltaImpl txDeltaImpl(ledgerDelta);
+            LedgerDelta& txDelta = txDeltaImpl;
+            EntryHelperProvider::storeDeleteEntry(
+                txDelta, db, LedgerEntryKey(balance));
+            txDelta.commit();
+        }
+        REQUIRE(!balanceHelper->loadBalance(balanceEntry.balanceID, db));
+        REQUIRE(balanceHelper->loadBalances(balanceEntry.accountID,
+                                            balanceEntry.asset, db).empty());
+        REQUIRE(storedAmount() == stored);
+
+        db.getLedgerOverlay().flush(db);
+
+        REQUIRE(updates.count() == updatesBefore);
+        REQUIRE(!balanceHelper->exists(db, balanceEntry.balanceID));
+    }
+}
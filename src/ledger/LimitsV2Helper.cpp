@@ -39,6 +39,14 @@ namespace  stellar
                    ");";
     }
 
+    void LimitsV2Helper::addIndexes(Database &db)
+    {
+        // the unique constraint leads with account_type, which most lookups
+        // leave open
+        db.getSession() << "CREATE INDEX limits_v2_by_stats_op_asset_account "
+                           "ON limits_v2 (stats_op_type, asset_code, account_id)";
+    }
+
     void
     LimitsV2Helper::storeUpdateHelper(LedgerDelta &delta, Database &db, bool insert, LedgerEntry const &entry)
     {
@@ -30,6 +30,7 @@ public:
     LimitsV2Helper& operator=(LimitsV2Helper const&) = delete;
 
     void dropAll(Database& db) override;
+    void addIndexes(Database& db);
     void storeAdd(LedgerDelta& delta, Database& db, LedgerEntry const& entry) override;
     void storeChange(LedgerDelta& delta, Database& db, LedgerEntry const& entry) override;
     void storeDelete(LedgerDelta& delta, Database& db, LedgerKey const& key) override;
@@ -98,6 +98,77 @@ namespace stellar {
         return count;
     }
 
+    void OfferHelper::storeUpsertMany(LedgerDelta &delta, Database &db, std::vector<LedgerEntry> const &entries) {
+        static const std::vector<std::string> columns = {
+                "owner_id", "offer_id", "order_book_id", "base_asset_code", "quote_asset_code", "base_amount",
+                "quote_amount", "price", "fee", "percent_fee", "is_buy", "base_balance_id", "quote_balance_id",
+                "created_at", "lastmodified", "version"};
+
+        for (size_t begin = 0; begin < entries.size(); begin += MAX_ENTRIES_PER_UPSERT)
+        {
+            auto const end = min(entries.size(), begin + MAX_ENTRIES_PER_UPSERT);
+            auto const rows = end - begin;
+
+            // bound values have to stay in place until the statement is run
+            std::vector<std::string> ownerIDs, baseBalances, quoteBalances;
+            std::vector<int> isBuys;
+            std::vector<int32_t> versions;
+            ownerIDs.reserve(rows);
+            baseBalances.reserve(rows);
+            quoteBalances.reserve(rows);
+            isBuys.reserve(rows);
+            versions.reserve(rows);
+
+            auto prep = db.getPreparedStatement(upsertStatement(db, "offer", columns, "offer_id", rows));
+            auto& st = prep.statement();
+            for (auto i = begin; i < end; i++)
+            {
+                auto const& offerEntry = entries[i].data.offer();
+                if (!OfferFrame::isValid(offerEntry))
+                {
+                    CLOG(ERROR, Logging::ENTRY_LOGGER)
+                            << "Unexpected state - offer is invalid: "
+                            << xdr::xdr_to_string(offerEntry);
+                    throw std::runtime_error("Unexpected state - offer is invalid");
+                }
+                flushCachedEntry(getLedgerKey(entries[i]), db);
+
+                ownerIDs.push_back(PubKeyUtils::toStrKey(offerEntry.ownerID));
+                baseBalances.push_back(BalanceKeyUtils::toStrKey(offerEntry.baseBalance));
+                quoteBalances.push_back(BalanceKeyUtils::toStrKey(offerEntry.quoteBalance));
+                isBuys.push_back(offerEntry.isBuy ? 1 : 0);
+                versions.push_back(static_cast<int32_t >(offerEntry.ext.v()));
+
+                st.exchange(use(ownerIDs.back()));
+                st.exchange(use(offerEntry.offerID));
+                st.exchange(use(offerEntry.orderBookID));
+                st.exchange(use(offerEntry.base));
+                st.exchange(use(offerEntry.quote));
+                st.exchange(use(offerEntry.baseAmount));
+                st.exchange(use(offerEntry.quoteAmount));
+                st.exchange(use(offerEntry.price));
+                st.exchange(use(offerEntry.fee));
+                st.exchange(use(offerEntry.percentFee));
+                st.exchange(use(isBuys.back()));
+                st.exchange(use(baseBalances.back()));
+                st.exchange(use(quoteBalances.back()));
+                st.exchange(use(offerEntry.createdAt));
+                st.exchange(use(entries[i].lastModifiedLedgerSeq));
+                st.exchange(use(versions.back()));
+            }
+            st.define_and_bind();
+            {
+                auto timer = db.getInsertTimer("offer");
+                st.execute(true);
+            }
+
+            if (st.get_affected_rows() != static_cast<long long>(rows))
+            {
+                throw runtime_error("could not update SQL");
+            }
+        }
+    }
+
     void OfferHelper::storeUpdateHelper(LedgerDelta &delta, Database &db, bool insert, LedgerEntry const &entry) {
 
         auto offerFrame = make_shared<OfferFrame>(entry);
@@ -381,4 +452,98 @@ std::unordered_map<AccountID, std::vector<OfferFrame::pointer>> OfferHelper::loa
             retOffers.emplace_back(make_shared<OfferFrame>(of));
         });
     }
-}
\ No newline at end of file
+
+    void OfferHelper::loadBestOffersAfter(size_t numOffers, OfferEntry const* after,
+                                          AssetCode const &base, AssetCode const &quote,
+                                          uint64_t orderBookID, bool isBuy,
+                                          std::vector<OfferFrame::pointer> &retOffers,
+                                          Database &db) {
+        if (!after)
+        {
+            loadBestOffers(numOffers, 0, base, quote, orderBookID, isBuy, retOffers, db);
+            return;
+        }
+
+        std::string sql = offerColumnSelector;
+        sql += " WHERE base_asset_code=:s AND quote_asset_code = :b AND order_book_id = :order_book_id AND is_buy=:ib";
+        sql += isBuy ? " AND (price < :p1" : " AND (price > :p1";
+        sql += " OR (price = :p2 AND offer_id > :oid))";
+
+        sql += " ORDER BY price ";
+        sql += isBuy ? "DESC" : "ASC";
+
+        sql += ", offer_id ASC LIMIT :n";
+
+        auto prep = db.getPreparedStatement(sql);
+        auto& st = prep.statement();
+
+        int isBuyRaw = isBuy ? 1 : 0;
+
+        st.exchange(use(base));
+        st.exchange(use(quote));
+        st.exchange(use(orderBookID));
+        st.exchange(use(isBuyRaw));
+        st.exchange(use(after->price));
+        st.exchange(use(after->price));
+        st.exchange(use(after->offerID));
+        st.exchange(use(numOffers));
+
+        auto timer = db.getSelectTimer("offer");
+        loadOffers(prep, [&retOffers](LedgerEntry const& of) {
+            retOffers.emplace_back(make_shared<OfferFrame>(of));
+        });
+    }
+
+    const size_t OfferHelper::OFFERS_PAGE_SIZE = 256;
+
+    void OfferHelper::forEachOfferPage(AssetCode const& base, AssetCode const& quote, uint64_t orderBookID,
+                                       int64_t const* quoteAmountUpperBound,
+                                       std::function<void(std::vector<OfferFrame::pointer> const&)> pageProcessor,
+                                       Database& db) {
+        std::string sql = offerColumnSelector;
+        sql += " WHERE base_asset_code=:s AND quote_asset_code = :b AND order_book_id = :order_book_id"
+               " AND offer_id > :oid";
+        if (quoteAmountUpperBound)
+        {
+            sql += " AND quote_amount < :quote_amount";
+        }
+        sql += " ORDER BY offer_id ASC LIMIT :n";
+
+        std::string baseAssetCode = base;
+        std::string quoteAssetCode = quote;
+        int64_t quoteAmountBound = quoteAmountUpperBound ? *quoteAmountUpperBound : 0;
+        uint64_t lastOfferID = 0;
+        size_t pageSize = OFFERS_PAGE_SIZE;
+        std::vector<OfferFrame::pointer> page;
+        do
+        {
+            page.clear();
+            {
+                auto prep = db.getPreparedStatement(sql);
+                auto& st = prep.statement();
+                st.exchange(use(baseAssetCode));
+                st.exchange(use(quoteAssetCode));
+                st.exchange(use(orderBookID));
+                st.exchange(use(lastOfferID));
+                if (quoteAmountUpperBound)
+                {
+                    st.exchange(use(quoteAmountBound));
+                }
+                st.exchange(use(pageSize));
+
+                auto timer = db.getSelectTimer("offer");
+                loadOffers(prep, [&page](LedgerEntry const& of) {
+                    page.emplace_back(make_shared<OfferFrame>(of));
+                });
+            }
+
+            if (page.empty())
+            {
+                return;
+            }
+
+            lastOfferID = page.back()->getOfferID();
+            pageProcessor(page);
+        } while (page.size() == pageSize);
+    }
+}
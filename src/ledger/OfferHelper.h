@@ -39,6 +39,7 @@ namespace stellar
         EntryFrame::pointer storeLoad(LedgerKey const& key, Database& db) override;
         EntryFrame::pointer fromXDR(LedgerEntry const& from) override;
         uint64_t countObjects(soci::session& sess) override;
+        void storeUpsertMany(LedgerDelta& delta, Database& db, std::vector<LedgerEntry> const& entries) override;
 
         OfferFrame::pointer loadOffer(AccountID const& accountID, uint64_t offerID,
                           Database& db, LedgerDelta* delta = nullptr);
@@ -54,11 +55,33 @@ namespace stellar
 
         std::unordered_map<AccountID, std::vector<OfferFrame::pointer>> loadAllOffers(Database& db);
 
+        static const size_t OFFERS_PAGE_SIZE;
+
+        // Streams the offers of an order book in offer id order, handing them
+        // to `pageProcessor` OFFERS_PAGE_SIZE at a time; with
+        // `quoteAmountUpperBound` set only offers with a smaller quote amount
+        // are visited. Each page starts after the last offer id of the
+        // previous one, so the processor may change or delete the offers it
+        // is given.
+        void forEachOfferPage(AssetCode const& base, AssetCode const& quote, uint64_t orderBookID,
+                              int64_t const* quoteAmountUpperBound,
+                              std::function<void(std::vector<OfferFrame::pointer> const&)> pageProcessor,
+                              Database& db);
+
         void loadBestOffers(size_t numOffers, size_t offset,
                             AssetCode const& base, AssetCode const& quote, uint64_t orderBookID,
                             bool isBuy,
                             std::vector<OfferFrame::pointer>& retOffers,
                             Database& db);
+
+        // same ordering as loadBestOffers, but starts right after `after`
+        // (or from the best offer if it's null), so that walking the book
+        // does not rescan already visited offers
+        void loadBestOffersAfter(size_t numOffers, OfferEntry const* after,
+                                 AssetCode const& base, AssetCode const& quote,
+                                 uint64_t orderBookID, bool isBuy,
+                                 std::vector<OfferFrame::pointer>& retOffers,
+                                 Database& db);
     private:
         OfferHelper() { ; }
         ~OfferHelper() { ; }
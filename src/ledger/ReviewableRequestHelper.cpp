@@ -3,6 +3,7 @@
 #include "xdrpp/printer.h"
 #include "LedgerDelta.h"
 #include "util/basen.h"
+#include "database/XDRBlob.h"
 #include "ReferenceFrame.h"
 
 using namespace soci;
@@ -121,15 +122,13 @@ namespace stellar {
         string sql;
 
         std::string hash = binToHex(reviewableRequestFrame->getHash());
-        auto bodyBytes = xdr::xdr_to_opaque(reviewableRequestFrame->getRequestEntry().body);
-        std::string strBody = bn::encode_b64(bodyBytes);
+        std::string strBody = XDRBlob::encodeObject(db, reviewableRequestFrame->getRequestEntry().body);
         std::string rejectReason = reviewableRequestFrame->getRejectReason();
         auto version = static_cast<int32_t>(reviewableRequestFrame->getRequestEntry().ext.v());
 
         uint32_t allTasks = reviewableRequestFrame->getAllTasks();
         uint32_t pendingTasks = reviewableRequestFrame->getPendingTasks();
-        auto externalDetailsBytes = xdr::xdr_to_opaque(reviewableRequestFrame->getExternalDetails());
-        auto strExternalDetails = bn::encode_b64(externalDetailsBytes);
+        auto strExternalDetails = XDRBlob::encodeObject(db, reviewableRequestFrame->getExternalDetails());
 
         if (insert)
         {
@@ -183,12 +182,13 @@ namespace stellar {
         }
     }
 
-    void ReviewableRequestHelper::loadRequests(StatementContext &prep,
+    void ReviewableRequestHelper::loadRequests(Database &db, StatementContext &prep,
                                                std::function<void(LedgerEntry const &)> requestsProcessor) {
         LedgerEntry le;
         le.data.type(LedgerEntryType::REVIEWABLE_REQUEST);
         ReviewableRequestEntry& oe = le.data.reviewableRequest();
         std::string hash, body, rejectReason, externalDetails;
+        std::vector<uint8_t> decoded;
         int version;
         uint32_t allTasks, pendingTasks;
 
@@ -213,12 +213,7 @@ namespace stellar {
         {
             oe.hash = hexToBin256(hash);
 
-            // unmarshal body
-            std::vector<uint8_t> decoded;
-            bn::decode_b64(body, decoded);
-            xdr::xdr_get unmarshaler(&decoded.front(), &decoded.back() + 1);
-            xdr::xdr_argpack_archive(unmarshaler, oe.body);
-            unmarshaler.done();
+            XDRBlob::decodeObject(db, body, decoded, oe.body);
 
             oe.rejectReason = rejectReason;
             oe.ext.v(static_cast<LedgerVersion>(version));
@@ -231,12 +226,8 @@ namespace stellar {
                 oe.ext.tasksExt().allTasks = allTasks;
                 oe.ext.tasksExt().pendingTasks = pendingTasks;
 
-                // unmarshal external details
-                std::vector<uint8_t> decodedDetails;
-                bn::decode_b64(externalDetails, decodedDetails);
-                xdr::xdr_get detailsUnmarshaler(&decodedDetails.front(), &decodedDetails.back() + 1);
-                xdr::xdr_argpack_archive(detailsUnmarshaler, oe.ext.tasksExt().externalDetails);
-                detailsUnmarshaler.done();
+                XDRBlob::decodeObject(db, externalDetails, decoded,
+                                      oe.ext.tasksExt().externalDetails);
             }
 
             ReviewableRequestFrame::ensureValid(oe);
@@ -293,7 +284,7 @@ namespace stellar {
 
         ReviewableRequestFrame::pointer retReviewableRequest;
         auto timer = db.getSelectTimer("reviewable_request");
-        loadRequests(prep, [&retReviewableRequest](LedgerEntry const& entry)
+        loadRequests(db, prep, [&retReviewableRequest](LedgerEntry const& entry)
         {
             retReviewableRequest = make_shared<ReviewableRequestFrame>(entry);
         });
@@ -341,7 +332,7 @@ loadRequests(AccountID const& rawRequestor, ReviewableRequestType requestType,
 
     vector<ReviewableRequestFrame::pointer> result;
     auto timer = db.getSelectTimer("reviewable_request");
-    loadRequests(prep, [&result,requestType](LedgerEntry const& entry)
+    loadRequests(db, prep, [&result,requestType](LedgerEntry const& entry)
     {
         auto request = make_shared<ReviewableRequestFrame>(entry);
         if (request->getRequestType() != requestType)
@@ -377,7 +368,7 @@ ReviewableRequestHelper::loadRequests(std::vector<uint64_t> requestIDs, Database
 
     vector<ReviewableRequestFrame::pointer> result;
     auto timer = db.getSelectTimer("reviewable_request");
-    loadRequests(prep, [&result](LedgerEntry const& entry)
+    loadRequests(db, prep, [&result](LedgerEntry const& entry)
     {
         result.emplace_back(make_shared<ReviewableRequestFrame>(entry));
     });
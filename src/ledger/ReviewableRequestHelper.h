@@ -43,7 +43,7 @@ namespace stellar
         EntryFrame::pointer fromXDR(LedgerEntry const& from) override;
         uint64_t countObjects(soci::session& sess) override;
 
-        void loadRequests(StatementContext & prep, std::function<void(LedgerEntry const&)> requestsProcessor);
+        void loadRequests(Database& db, StatementContext & prep, std::function<void(LedgerEntry const&)> requestsProcessor);
 
         ReviewableRequestFrame::pointer loadRequest(uint64 requestID, Database& db, LedgerDelta* delta = nullptr);
         ReviewableRequestFrame::pointer loadRequest(uint64 requestID, AccountID requestor, Database& db,
@@ -1,5 +1,6 @@
 #include "SaleAnteHelper.h"
 #include "LedgerDelta.h"
+#include "BalanceHelperLegacy.h"
 #include "xdrpp/printer.h"
 
 using namespace soci;
@@ -247,4 +248,14 @@ namespace stellar {
 
         return retSaleAntes;
     }
+
+    void SaleAnteHelper::loadParticipantBalances(std::vector<SaleAnteFrame::pointer> const &saleAntes, size_t begin,
+                                                 Database &db) {
+        auto const end = min(saleAntes.size(), begin + MAX_KEYS_PER_LOAD);
+        vector<BalanceID> balanceIDs;
+        for (auto i = begin; i < end; i++) {
+            balanceIDs.push_back(saleAntes[i]->getParticipantBalanceID());
+        }
+        BalanceHelperLegacy::Instance()->loadBalancesByID(balanceIDs, db);
+    }
 }
\ No newline at end of file
@@ -54,5 +54,10 @@ namespace stellar {
         std::vector<SaleAnteFrame::pointer> loadSaleAntesForSale(uint64_t saleID, Database &db);
 
         std::unordered_map<BalanceID, SaleAnteFrame::pointer> loadSaleAntes(uint64_t saleID, Database &db);
+
+        // Batch loads the participant balances of the MAX_KEYS_PER_LOAD antes
+        // starting at `begin` into the entry cache.
+        void loadParticipantBalances(std::vector<SaleAnteFrame::pointer> const &saleAntes, size_t begin,
+                                     Database &db);
     };
 }
\ No newline at end of file
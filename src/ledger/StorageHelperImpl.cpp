@@ -9,10 +9,12 @@
 namespace stellar
 {
 
-StorageHelperImpl::StorageHelperImpl(Database& db, LedgerDelta* ledgerDelta)
+StorageHelperImpl::StorageHelperImpl(Database& db, LedgerDelta* ledgerDelta,
+                                     bool withSqlTransaction)
     : mDatabase(db)
     , mLedgerDelta(ledgerDelta)
-    , mTransaction(new soci::transaction(db.getSession()))
+    , mTransaction(withSqlTransaction ? new soci::transaction(db.getSession())
+                                      : nullptr)
 {
 }
 
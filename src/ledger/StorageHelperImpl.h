@@ -23,7 +23,13 @@ class ExternalSystemAccountIDPoolEntryHelper;
 class StorageHelperImpl : public StorageHelper
 {
   public:
-    StorageHelperImpl(Database& db, LedgerDelta* ledgerDelta);
+    // When withSqlTransaction is false no savepoint is opened for this
+    // helper: its SQL writes are only undone if the caller rolls back an
+    // enclosing soci::transaction. This saves a SAVEPOINT/RELEASE round trip
+    // for every operation applied inside a transaction that already guards
+    // the SQL state.
+    StorageHelperImpl(Database& db, LedgerDelta* ledgerDelta,
+                      bool withSqlTransaction = true);
     virtual ~StorageHelperImpl();
 
   private:
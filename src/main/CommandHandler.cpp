@@ -3,7 +3,9 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "crypto/Hex.h"
+#include "database/IndexAdvisor.h"
 #include "herder/Herder.h"
+#include "herder/TxAdmissionQueue.h"
 #include "ledger/LedgerManager.h"
 #include "lib/http/server.hpp"
 #include "lib/json/json.h"
@@ -32,6 +34,7 @@ using namespace stellar::txtest;
 
 using std::placeholders::_1;
 using std::placeholders::_2;
+using std::placeholders::_3;
 
 namespace stellar
 {
@@ -79,6 +82,8 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
                       std::bind(&CommandHandler::dropcursor, this, _1, _2));
     mServer->addRoute("droppeer",
                       std::bind(&CommandHandler::dropPeer, this, _1, _2));
+    mServer->addRoute("explaindb",
+                      std::bind(&CommandHandler::explaindb, this, _1, _2));
     mServer->addRoute("generateload",
                       std::bind(&CommandHandler::generateLoad, this, _1, _2));
     mServer->addRoute("info", std::bind(&CommandHandler::info, this, _1, _2));
@@ -102,6 +107,8 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
     mServer->addRoute("testtx",
                       std::bind(&CommandHandler::testTx, this, _1, _2));
     mServer->addRoute("tx", std::bind(&CommandHandler::tx, this, _1, _2));
+    mServer->addPostRoute("txs",
+                          std::bind(&CommandHandler::txs, this, _1, _2, _3));
     mServer->addRoute("unban",
                       std::bind(&CommandHandler::unban, this, _1, _2));
 }
@@ -255,6 +262,10 @@ CommandHandler::fileNotFound(std::string const& params, std::string& retStr)
         "</p><p><h1> "
         "/droppeer?node=NODE_ID[&ban=D]</h1>"
         "drops peer identified by PEER_ID, when D is 1 the peer is also banned"
+        "</p><p><h1> /explaindb</h1>"
+        "returns, in JSON format, the query plan of every prepared statement "
+        "issued so far, next to its select timers; full table scans are "
+        "listed first."
         "</p><p><h1> "
         "/generateload[?accounts=N&txs=M&txrate=(R|auto)]</h1>"
         "artificially generate load for testing; must be used with "
@@ -291,6 +302,16 @@ CommandHandler::fileNotFound(std::string const& params, std::string& retStr)
         "returns a JSON object<br>"
         "wasReceived: boolean, true if transaction was queued properly<br>"
         "result: base64 encoded, XDR serialized 'TransactionResult'<br>"
+        "</p><p><h1> POST /txs</h1>"
+        "submit a batch of transactions to the network.<br>"
+        "the body is a stream of XDR serialized 'TransactionEnvelope', each "
+        "preceded by its length as 4 bytes big endian (the format of XDR "
+        "files)<br>"
+        "returns one JSON object per transaction and line, in the order of "
+        "the body, same as /tx; a malformed body ends the reply with an "
+        "'exception' line<br>"
+        "at most 256 transactions are accepted per request, a larger batch "
+        "is refused as a whole with a single 'exception' line<br>"
         "</p><p><h1> /dropcursor?id=XYZ</h1> deletes the tracking cursor with "
         "identified by `id`. See `setcursor` for more information"
         "</p><p><h1> /setcursor?id=ID&cursor=N</h1> sets or creates a cursor "
@@ -571,6 +592,13 @@ CommandHandler::checkdb(std::string const& params, std::string& retStr)
     retStr = "CheckDB started.";
 }
 
+void
+CommandHandler::explaindb(std::string const& params, std::string& retStr)
+{
+    IndexAdvisor advisor(mApp.getDatabase(), mApp.getMetrics());
+    retStr = advisor.report().toStyledString();
+}
+
 void
 CommandHandler::checkpoint(std::string const& params, std::string& retStr)
 {
@@ -839,6 +867,148 @@ CommandHandler::ll(std::string const& params, std::string& retStr)
 static const char* TX_STATUS_STRING[Herder::TX_STATUS_COUNT] = {
     "PENDING", "DUPLICATE", "ERROR"};
 
+namespace
+{
+void
+writeTxStatus(std::ostream& output, TransactionFrame& transaction,
+              Herder::TransactionSubmitStatus status)
+{
+    output << "{"
+           << "\"status\": "
+           << "\"" << TX_STATUS_STRING[status] << "\"";
+    if (status == Herder::TX_STATUS_ERROR)
+    {
+        std::string resultBase64;
+        auto resultBin = xdr::xdr_to_opaque(transaction.getResult());
+        resultBase64.reserve(bn::encoded_size64(resultBin.size()) + 1);
+        resultBase64 = bn::encode_b64(resultBin);
+
+        output << " , \"error\": \"" << resultBase64 << "\"";
+    }
+    output << "}";
+}
+
+void
+broadcastTransaction(Application& app, TransactionEnvelope const& envelope)
+{
+    StellarMessage msg;
+    msg.type(MessageType::TRANSACTION);
+    msg.transaction() = envelope;
+    app.getOverlayManager().broadcastMessage(msg);
+}
+
+// a POST /txs request, decoded on a worker thread and submitted on the main
+// thread; it is admitted by the herder in one go, so it is limited to what
+// the admission queue admits per crank
+struct TxBatch
+{
+    std::string mBody;
+    std::vector<TransactionFramePtr> mTxs;
+    // why the body could not be decoded past mTxs, if it could not
+    std::string mError;
+    http::server::server::replyHandler mReply;
+};
+
+void
+decodeTxBatch(Hash const& networkID, TxBatch& batch)
+{
+    auto const& body = batch.mBody;
+    size_t pos = 0;
+    try
+    {
+        while (pos < body.size())
+        {
+            if (batch.mTxs.size() == TxAdmissionQueue::MAX_BATCH_SIZE)
+            {
+                // nothing is submitted from a batch that is too large
+                batch.mTxs.clear();
+                throw std::runtime_error(
+                    fmt::format("too many transactions, at most {:d} per "
+                                "request",
+                                TxAdmissionQueue::MAX_BATCH_SIZE));
+            }
+
+            if (body.size() - pos < 4)
+            {
+                throw std::runtime_error("truncated length");
+            }
+
+            // 4 bytes of size, big-endian, with the XDR 'continuation' bit
+            // cleared (high bit of high byte), as in XDR files
+            uint32_t sz = 0;
+            sz |= static_cast<uint8_t>(body[pos] & '\x7f');
+            sz <<= 8;
+            sz |= static_cast<uint8_t>(body[pos + 1]);
+            sz <<= 8;
+            sz |= static_cast<uint8_t>(body[pos + 2]);
+            sz <<= 8;
+            sz |= static_cast<uint8_t>(body[pos + 3]);
+            pos += 4;
+
+            if (sz > body.size() - pos)
+            {
+                throw std::runtime_error("truncated transaction envelope");
+            }
+
+            TransactionEnvelope envelope;
+            xdr::xdr_get g(body.data() + pos, body.data() + pos + sz);
+            xdr::xdr_argpack_archive(g, envelope);
+            // throws on bytes left over at the end of the record
+            g.done();
+            pos += sz;
+
+            auto transaction =
+                TransactionFrame::makeTransactionFromWire(networkID, envelope);
+            // the frame caches its hashes, get them out of the way here
+            transaction->getFullHash();
+            transaction->getContentsHash();
+            batch.mTxs.emplace_back(transaction);
+        }
+    }
+    catch (std::exception& e)
+    {
+        batch.mError = e.what();
+    }
+}
+
+void
+submitTxBatch(Application& app, std::shared_ptr<TxBatch> batch)
+{
+    std::ostringstream output;
+    try
+    {
+        std::vector<Herder::TransactionSubmitStatus> statuses;
+        if (!batch->mTxs.empty())
+        {
+            statuses = app.getHerder().recvTransactions(batch->mTxs);
+        }
+        for (size_t i = 0; i < batch->mTxs.size(); i++)
+        {
+            auto& transaction = *batch->mTxs[i];
+            if (statuses[i] == Herder::TX_STATUS_PENDING)
+            {
+                broadcastTransaction(app, transaction.getEnvelope());
+            }
+            writeTxStatus(output, transaction, statuses[i]);
+            output << "\n";
+        }
+        if (!batch->mError.empty())
+        {
+            output << "{\"exception\": \"" << batch->mError << "\"}\n";
+        }
+    }
+    catch (std::exception& e)
+    {
+        output << "{\"exception\": \"" << e.what() << "\"}\n";
+    }
+    catch (...)
+    {
+        output << "{\"exception\": \"generic\"}\n";
+    }
+    batch->mReply(output.str());
+}
+}
+
 void
 CommandHandler::tx(std::string const& params, std::string& retStr)
 {
@@ -867,27 +1037,10 @@ CommandHandler::tx(std::string const& params, std::string& retStr)
 
                 if (status == Herder::TX_STATUS_PENDING)
                 {
-                    StellarMessage msg;
-                    msg.type(MessageType::TRANSACTION);
-                    msg.transaction() = envelope;
-                    mApp.getOverlayManager().broadcastMessage(msg);
+                    broadcastTransaction(mApp, envelope);
                 }
 
-                output << "{"
-                       << "\"status\": "
-                       << "\"" << TX_STATUS_STRING[status] << "\"";
-                if (status == Herder::TX_STATUS_ERROR)
-                {
-                    std::string resultBase64;
-                    auto resultBin =
-                        xdr::xdr_to_opaque(transaction->getResult());
-                    resultBase64.reserve(bn::encoded_size64(resultBin.size()) +
-                                         1);
-                    resultBase64 = bn::encode_b64(resultBin);
-
-                    output << " , \"error\": \"" << resultBase64 << "\"";
-                }
-                output << "}";
+                writeTxStatus(output, *transaction, status);
             }
         }
         catch (std::exception& e)
@@ -908,6 +1061,27 @@ CommandHandler::tx(std::string const& params, std::string& retStr)
     retStr = output.str();
 }
 
+void
+CommandHandler::txs(std::string const& params, std::string const& body,
+                    http::server::server::replyHandler reply)
+{
+    auto batch = std::make_shared<TxBatch>();
+    batch->mBody = body;
+    batch->mReply = reply;
+
+    // decoding and hashing the envelopes does not need the main thread, only
+    // admitting them does
+    auto& app = mApp;
+    auto networkID = mApp.getNetworkID();
+    mApp.getWorkerIOService().post([&app, networkID, batch]() mutable {
+        decodeTxBatch(networkID, *batch);
+        // the batch is moved along so that the reply, which holds on to the
+        // connection, is released on the main thread
+        app.getClock().getIOService().post(
+            std::bind(submitTxBatch, std::ref(app), std::move(batch)));
+    });
+}
+
 void
 CommandHandler::dropcursor(std::string const& params, std::string& retStr)
 {
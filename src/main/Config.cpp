@@ -46,6 +46,7 @@ operationalID(PubKeyUtils::fromStrKey("GABAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
     ARTIFICIALLY_ACCELERATE_TIME_FOR_TESTING = false;
     ARTIFICIALLY_SET_CLOSE_TIME_FOR_TESTING = 0;
     ARTIFICIALLY_PESSIMIZE_MERGES_FOR_TESTING = false;
+    ARTIFICIALLY_WRITE_TX_HISTORY_ROW_BY_ROW_FOR_TESTING = false;
     ALLOW_LOCALHOST_FOR_TESTING = false;
     FAILURE_SAFETY = -1;
     UNSAFE_QUORUM = false;
@@ -72,6 +73,8 @@ operationalID(PubKeyUtils::fromStrKey("GABAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
     NODE_IS_VALIDATOR = false;
 
     DATABASE = "sqlite3://:memory:";
+    ENTRY_CACHE_SIZE = 4096;
+    BINARY_XDR_BLOBS = false;
     NTP_SERVER = "pool.ntp.org";
     INVARIANT_CHECK_CACHE_CONSISTENT_WITH_DATABASE = true;
 
@@ -558,6 +561,43 @@ Config::load(std::string const& filename)
                 }
                 DATABASE = item.second->as<std::string>()->value();
             }
+            else if (item.first == "ENTRY_CACHE_SIZE")
+            {
+                if (!item.second->as<int64_t>() ||
+                    item.second->as<int64_t>()->value() < 0)
+                {
+                    throw std::invalid_argument("invalid ENTRY_CACHE_SIZE");
+                }
+                ENTRY_CACHE_SIZE = (size_t)item.second->as<int64_t>()->value();
+            }
+            else if (item.first == "ENTRY_CACHE_SIZE_PER_TYPE")
+            {
+                auto sizes = item.second->as_group();
+                if (!sizes)
+                {
+                    throw std::invalid_argument(
+                        "ENTRY_CACHE_SIZE_PER_TYPE must be a table");
+                }
+                for (auto const& size : *sizes)
+                {
+                    auto value = size.second->as<int64_t>();
+                    if (!value || value->value() < 0)
+                    {
+                        throw std::invalid_argument(
+                            "invalid ENTRY_CACHE_SIZE_PER_TYPE." + size.first);
+                    }
+                    ENTRY_CACHE_SIZE_PER_TYPE[parseLedgerEntryType(
+                        size.first)] = (size_t)value->value();
+                }
+            }
+            else if (item.first == "BINARY_XDR_BLOBS")
+            {
+                if (!item.second->as<bool>())
+                {
+                    throw std::invalid_argument("invalid BINARY_XDR_BLOBS");
+                }
+                BINARY_XDR_BLOBS = item.second->as<bool>()->value();
+            }
             else if (item.first == "PARANOID_MODE")
             {
                 if (!item.second->as<bool>())
@@ -695,6 +735,21 @@ Config::load(std::string const& filename)
     }
 }
 
+LedgerEntryType
+Config::parseLedgerEntryType(std::string const& name)
+{
+    for (auto type : xdr::xdr_traits<LedgerEntryType>::enum_values())
+    {
+        auto entryType = static_cast<LedgerEntryType>(type);
+        if (name ==
+            xdr::xdr_traits<LedgerEntryType>::enum_name(entryType))
+        {
+            return entryType;
+        }
+    }
+    throw std::invalid_argument("unknown ledger entry type: " + name);
+}
+
 AssetCode Config::getAssetCode(std::shared_ptr<cpptoml::toml_base> rawValue, const char* errorMessage)
 {
 	if (!rawValue->as<std::string>())
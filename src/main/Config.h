@@ -27,6 +27,8 @@ class Config : public std::enable_shared_from_this<Config>
     void parseNodeID(std::string configStr, PublicKey& retKey, SecretKey& sKey,
                      bool isSeed);
 
+    static LedgerEntryType parseLedgerEntryType(std::string const& name);
+
 	static AssetCode getAssetCode(std::shared_ptr<cpptoml::toml_base> rawValue, const char* errorMessage);
 
   public:
@@ -100,6 +102,12 @@ class Config : public std::enable_shared_from_this<Config>
     // and should be false in all normal cases.
     bool ARTIFICIALLY_PESSIMIZE_MERGES_FOR_TESTING;
 
+    // A config parameter that makes ledger close write its transaction
+    // history one row per INSERT, as it did before rows were batched; this
+    // option exists only to benchmark the batching, and should be false in
+    // all normal cases.
+    bool ARTIFICIALLY_WRITE_TX_HISTORY_ROW_BY_ROW_FOR_TESTING;
+
     // A config to allow connections to localhost
     // this should only be enabled when testing as it's a security issue
     bool ALLOW_LOCALHOST_FOR_TESTING;
@@ -201,6 +209,18 @@ class Config : public std::enable_shared_from_this<Config>
     // Database config
     std::string DATABASE;
 
+    // Default number of entries of each LedgerEntryType kept in the
+    // database entry cache (4096). The bound applies to every type on its
+    // own, so with N types in use up to N times as many entries are cached.
+    size_t ENTRY_CACHE_SIZE;
+    // Per-type overrides of ENTRY_CACHE_SIZE, set in the config file as
+    // [ENTRY_CACHE_SIZE_PER_TYPE] table, i.e. BALANCE=100000
+    std::map<LedgerEntryType, size_t> ENTRY_CACHE_SIZE_PER_TYPE;
+
+    // Store XDR blobs (tx history, reviewable requests) in BYTEA columns
+    // instead of base64 TEXT; postgresql only, see XDRBlob.
+    bool BINARY_XDR_BLOBS;
+
     std::vector<std::string> COMMANDS;
     std::vector<std::string> REPORT_METRICS;
 
@@ -84,7 +84,10 @@ Floodgate::broadcast(StellarMessage const& msg, bool force)
     {
         return;
     }
-    Hash index = sha256(xdr::xdr_to_opaque(msg));
+    // serialize once: the same bytes are hashed and sent to every peer
+    auto body =
+        std::make_shared<xdr::opaque_vec<> const>(xdr::xdr_to_opaque(msg));
+    Hash index = sha256(*body);
     CLOG(TRACE, "Overlay") << "broadcast " << hexAbbrev(index);
 
     auto result = mFloodMap.find(index);
@@ -106,7 +109,7 @@ Floodgate::broadcast(StellarMessage const& msg, bool force)
         if (peersTold.find(peer) == peersTold.end() && peer->isAuthenticated())
         {
             mSendFromBroadcast.Mark();
-            peer->sendMessage(msg);
+            peer->sendMessage(msg, body);
             peersTold.insert(peer);
         }
     }
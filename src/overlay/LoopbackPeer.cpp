@@ -39,7 +39,7 @@ LoopbackPeer::getAuthCert()
 }
 
 void
-LoopbackPeer::sendMessage(xdr::msg_ptr&& msg)
+LoopbackPeer::sendMessage(AuthenticatedMessageParts&& msg)
 {
     // Damage authentication material.
     if (mDamageAuth)
@@ -49,7 +49,7 @@ LoopbackPeer::sendMessage(xdr::msg_ptr&& msg)
     }
 
     // CLOG(TRACE, "Overlay") << "LoopbackPeer queueing message";
-    mOutQueue.emplace_back(std::move(msg));
+    mOutQueue.emplace_back(msg.toMsg());
     // Possibly flush some queued messages if queue's full.
     while (mOutQueue.size() > mMaxQueueDepth && !mCorked)
     {
@@ -52,7 +52,7 @@ class LoopbackPeer : public Peer
 
     Stats mStats;
 
-    void sendMessage(xdr::msg_ptr&& xdrBytes);
+    void sendMessage(AuthenticatedMessageParts&& msg) override;
     AuthCert getAuthCert();
 
     void processInQueue();
@@ -38,7 +38,7 @@ class PeerStub : public Peer
         return "127.0.0.1";
     }
     virtual void
-    sendMessage(xdr::msg_ptr&& xdrBytes) override
+    sendMessage(AuthenticatedMessageParts&& msg) override
     {
         sent++;
     }
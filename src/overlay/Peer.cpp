@@ -440,8 +440,31 @@ msgSummary(StellarMessage const& msg)
     return "UNKNOWN";
 }
 
+const size_t AuthenticatedMessageParts::HEADER_SIZE;
+
+xdr::msg_ptr
+AuthenticatedMessageParts::toMsg() const
+{
+    // the record mark at the front of mHeader is written by alloc
+    auto const markSize = 4;
+    auto res = xdr::message_t::alloc(HEADER_SIZE - markSize + mBody->size() +
+                                     mMac.mac.size());
+    auto out = res->data();
+    out = std::copy(mHeader.begin() + markSize, mHeader.end(), out);
+    out = std::copy(mBody->begin(), mBody->end(), out);
+    std::copy(mMac.mac.begin(), mMac.mac.end(), out);
+    return res;
+}
+
 void
 Peer::sendMessage(StellarMessage const& msg)
+{
+    sendMessage(msg, std::make_shared<xdr::opaque_vec<> const>(
+                         xdr::xdr_to_opaque(msg)));
+}
+
+void
+Peer::sendMessage(StellarMessage const& msg, StellarMessageBytes const& body)
 {
     if (Logging::logTrace("Overlay"))
         CLOG(TRACE, "Overlay") << "("
@@ -493,17 +516,34 @@ Peer::sendMessage(StellarMessage const& msg)
         break;
     };
 
-    AuthenticatedMessage amsg;
-    amsg.v0().message = msg;
+    // Lay out AuthenticatedMessage::v0 around the shared body by hand, so
+    // that the message itself is neither copied nor serialized again for
+    // every peer.
+    AuthenticatedMessageParts amsg;
+    amsg.mBody = body;
+    uint64 sequence = 0;
     if (msg.type() != MessageType::HELLO && msg.type() != MessageType::ERROR_MSG)
     {
-        amsg.v0().sequence = mSendMacSeq;
-        amsg.v0().mac =
-            hmacSha256(mSendMacKey, xdr::xdr_to_opaque(mSendMacSeq, msg));
+        sequence = mSendMacSeq;
+        amsg.mMac =
+            hmacSha256(mSendMacKey, xdr::xdr_to_opaque(mSendMacSeq), *body);
         ++mSendMacSeq;
     }
-    xdr::msg_ptr xdrBytes(xdr::xdr_to_msg(amsg));
-    this->sendMessage(std::move(xdrBytes));
+
+    uint32_t const version = 0;
+    auto const prefix = xdr::xdr_to_opaque(version, sequence);
+    uint32_t const size = static_cast<uint32_t>(
+        prefix.size() + body->size() + amsg.mMac.mac.size());
+    // record mark: last fragment flag and message length, big endian
+    uint32_t const mark = size | 0x80000000;
+    amsg.mHeader[0] = static_cast<uint8_t>(mark >> 24);
+    amsg.mHeader[1] = static_cast<uint8_t>(mark >> 16);
+    amsg.mHeader[2] = static_cast<uint8_t>(mark >> 8);
+    amsg.mHeader[3] = static_cast<uint8_t>(mark);
+    assert(prefix.size() + 4 == AuthenticatedMessageParts::HEADER_SIZE);
+    std::copy(prefix.begin(), prefix.end(), amsg.mHeader.begin() + 4);
+
+    this->sendMessage(std::move(amsg));
 }
 
 void
@@ -746,22 +786,10 @@ Peer::recvTransaction(StellarMessage const& msg)
         mApp.getNetworkID(), msg.transaction());
     if (transaction)
     {
-        // add it to our current set
-        // and make sure it is valid
-        auto recvRes = mApp.getHerder().recvTransaction(transaction);
-
-        if (recvRes == Herder::TX_STATUS_PENDING ||
-            recvRes == Herder::TX_STATUS_DUPLICATE)
-        {
-            // record that this peer sent us this transaction
-            mApp.getOverlayManager().recvFloodedMsg(msg, shared_from_this());
-
-            if (recvRes == Herder::TX_STATUS_PENDING)
-            {
-                // if it's a new transaction, broadcast it
-                mApp.getOverlayManager().broadcastMessage(msg);
-            }
-        }
+        // the herder validates it, and floods it if it is new, once it is
+        // admitted from its queue
+        mApp.getHerder().recvFloodedTransaction(transaction, msg,
+                                                shared_from_this());
     }
 }
 
@@ -10,6 +10,7 @@
 #include "util/Timer.h"
 #include "database/Database.h"
 #include "util/NonCopyable.h"
+#include <array>
 
 namespace medida
 {
@@ -22,6 +23,25 @@ namespace stellar
 
 typedef std::shared_ptr<SCPQuorumSet> SCPQuorumSetPtr;
 
+// XDR encoding of a StellarMessage. A broadcast message is serialized once
+// and the same bytes are shared by every peer it is sent to.
+typedef std::shared_ptr<xdr::opaque_vec<> const> StellarMessageBytes;
+
+// Wire form of an AuthenticatedMessage, split around its StellarMessage:
+// only the header (record mark, version and sequence) and the mac are
+// specific to a peer.
+struct AuthenticatedMessageParts
+{
+    static const size_t HEADER_SIZE = 16;
+
+    std::array<uint8_t, HEADER_SIZE> mHeader;
+    StellarMessageBytes mBody;
+    HmacSha256Mac mMac;
+
+    // copies the parts into a single xdr message
+    xdr::msg_ptr toMsg() const;
+};
+
 class Application;
 class LoopbackPeer;
 
@@ -162,14 +182,13 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void sendDontHave(MessageType type, uint256 const& itemID);
     void sendPeers();
 
-    // NB: This is a move-argument because the write-buffer has to travel
+    // NB: This is a move-argument because the write-buffers have to travel
     // with the write-request through the async IO system, and we might have
-    // several queued at once. We have carefully arranged this to not copy
-    // data more than the once necessary into this buffer, but it can't be
-    // put in a reused/non-owned buffer without having to buffer/queue
-    // messages somewhere else. The async write request will point _into_
-    // this owned buffer. This is really the best we can do.
-    virtual void sendMessage(xdr::msg_ptr&& xdrBytes) = 0;
+    // several queued at once. The message body is shared with the other
+    // peers the same message is sent to, only the header and mac are owned
+    // by this request. The async write request will point _into_ these
+    // buffers.
+    virtual void sendMessage(AuthenticatedMessageParts&& msg) = 0;
     virtual void
     connected()
     {
@@ -199,6 +218,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void sendGetScpState(uint32 ledgerSeq);
 
     void sendMessage(StellarMessage const& msg);
+    // same as above for a message already serialized into `body`
+    void sendMessage(StellarMessage const& msg,
+                     StellarMessageBytes const& body);
 
     PeerRole
     getRole() const
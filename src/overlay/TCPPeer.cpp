@@ -125,14 +125,14 @@ TCPPeer::getIP()
 }
 
 void
-TCPPeer::sendMessage(xdr::msg_ptr&& xdrBytes)
+TCPPeer::sendMessage(AuthenticatedMessageParts&& msg)
 {
     if (Logging::logTrace("Overlay"))
         CLOG(TRACE, "Overlay") << "TCPPeer:sendMessage to " << toString();
     assertThreadIsMain();
 
-    // places the buffer to write into the write queue
-    auto buf = std::make_shared<xdr::msg_ptr>(std::move(xdrBytes));
+    // places the buffers to write into the write queue
+    auto buf = std::make_shared<AuthenticatedMessageParts>(std::move(msg));
 
     auto self = static_pointer_cast<TCPPeer>(shared_from_this());
 
@@ -179,8 +179,13 @@ TCPPeer::messageSender()
     // write operation
     auto buf = mWriteQueue.front();
 
-    asio::async_write(*(mSocket.get()),
-                      asio::buffer((*buf)->raw_data(), (*buf)->raw_size()),
+    // gather the header, the (shared) body and the mac in a single write
+    std::array<asio::const_buffer, 3> buffers = {
+        {asio::buffer(buf->mHeader),
+         asio::buffer(buf->mBody->data(), buf->mBody->size()),
+         asio::buffer(buf->mMac.mac.data(), buf->mMac.mac.size())}};
+
+    asio::async_write(*(mSocket.get()), buffers,
                       [self](asio::error_code const& ec, std::size_t length)
                       {
                           self->writeHandler(ec, length);
@@ -287,7 +287,7 @@ namespace stellar {
             return SUCCESS;
 
         AssetCode baseAsset = balance->getAsset();
-        auto statsAssetPair = AssetPairHelper::Instance()->tryLoadAssetPairForAssets(baseAsset,
+        auto statsAssetPair = AssetPairHelper::Instance()->findAssetPairForAssets(baseAsset,
                                                                                      statsAssetFrame->getCode(), mDb);
         if (!statsAssetPair)
             return SUCCESS;
@@ -118,8 +118,14 @@ bool CheckSaleStateOpFrame::handleCancel(SaleFrame::pointer sale, LedgerManager&
 void CheckSaleStateOpFrame::chargeSaleAntes(uint64_t saleID, AccountID const &commissionID,
                                             LedgerDelta &delta, Database &db)
 {
-    auto saleAntes = SaleAnteHelper::Instance()->loadSaleAntesForSale(saleID, db);
-    for (auto &saleAnte : saleAntes) {
+    auto saleAnteHelper = SaleAnteHelper::Instance();
+    auto saleAntes = saleAnteHelper->loadSaleAntesForSale(saleID, db);
+    for (size_t i = 0; i < saleAntes.size(); i++) {
+        if (i % EntryHelperLegacy::MAX_KEYS_PER_LOAD == 0) {
+            saleAnteHelper->loadParticipantBalances(saleAntes, i, db);
+        }
+
+        auto &saleAnte = saleAntes[i];
         auto participantBalanceFrame = BalanceHelperLegacy::Instance()->mustLoadBalance(saleAnte->getParticipantBalanceID(),
                                                                                   db, &delta);
         auto commissionBalance = AccountManager::loadOrCreateBalanceFrameForAsset(commissionID,
@@ -433,13 +439,17 @@ bool CheckSaleStateOpFrame::cleanSale(SaleFrame::pointer sale, Application& app,
             continue;
         }
 
-        auto offersToCancel = OfferHelper::Instance()->loadOffers(sale->getBaseAsset(), quoteAsset.quoteAsset, sale->getID(), minAllowedQuoteAmount, db);
-        for (const auto offerToCancel : offersToCancel)
+        OfferHelper::Instance()->forEachOfferPage(sale->getBaseAsset(), quoteAsset.quoteAsset, sale->getID(),
+                                                  &minAllowedQuoteAmount,
+                                                  [&](vector<OfferFrame::pointer> const& offersToCancel)
         {
-            DeleteSaleParticipationOpFrame::deleteSaleParticipation(app, delta, ledgerManager, offerToCancel, mParentTx);
-            wasUpdated = true;
-        }
-
+            OfferManager::loadOfferBalances(offersToCancel, db);
+            for (const auto offerToCancel : offersToCancel)
+            {
+                DeleteSaleParticipationOpFrame::deleteSaleParticipation(app, delta, ledgerManager, offerToCancel, mParentTx);
+                wasUpdated = true;
+            }
+        }, db);
 
     }
 
@@ -461,20 +471,23 @@ void CheckSaleStateOpFrame::updateOfferPrices(SaleFrame::pointer sale,
     for (auto& quoteAsset : saleEntry.quoteAssets)
     {
         quoteAsset.price = getPriceInQuoteAsset(priceInDefaultQuoteAsset, sale, quoteAsset.quoteAsset, db);
-        const auto offersToUpdate = OfferHelper::Instance()->loadOffersWithFilters(sale->getBaseAsset(), quoteAsset.quoteAsset, &saleEntry.saleID, nullptr, db);
-        for (auto& offerToUpdate : offersToUpdate)
+        OfferHelper::Instance()->forEachOfferPage(sale->getBaseAsset(), quoteAsset.quoteAsset, saleEntry.saleID,
+                                                  nullptr, [&](vector<OfferFrame::pointer> const& offersToUpdate)
         {
-            auto& offerEntry = offerToUpdate->getOffer();
-            offerEntry.price = quoteAsset.price;
-
-            if (!bigDivide(offerEntry.baseAmount, offerEntry.quoteAmount, ONE, offerEntry.price, ROUND_DOWN))
+            for (auto& offerToUpdate : offersToUpdate)
             {
-                CLOG(ERROR, Logging::OPERATION_LOGGER) << "Failed to update price for offer: offerID: " << offerEntry.offerID;
-                throw runtime_error("Failed to update price for offer on check state");
-            }
+                auto& offerEntry = offerToUpdate->getOffer();
+                offerEntry.price = quoteAsset.price;
 
-                        OfferHelper::Instance()->storeChange(delta, db, offerToUpdate->mEntry);
-        }
+                if (!bigDivide(offerEntry.baseAmount, offerEntry.quoteAmount, ONE, offerEntry.price, ROUND_DOWN))
+                {
+                    CLOG(ERROR, Logging::OPERATION_LOGGER) << "Failed to update price for offer: offerID: " << offerEntry.offerID;
+                    throw runtime_error("Failed to update price for offer on check state");
+                }
+
+                OfferHelper::Instance()->storeChange(delta, db, offerToUpdate->mEntry);
+            }
+        }, db);
     }
 
     SaleHelper::Instance()->storeChange(delta, db, sale->mEntry);
@@ -515,7 +528,7 @@ int64_t CheckSaleStateOpFrame::getPriceInQuoteAsset(
         return salePriceInDefaultQuote;
     }
 
-    auto assetPair = AssetPairHelper::Instance()->tryLoadAssetPairForAssets(sale->getDefaultQuoteAsset(), quoteAsset, db);
+    auto assetPair = AssetPairHelper::Instance()->findAssetPairForAssets(sale->getDefaultQuoteAsset(), quoteAsset, db);
     if (!assetPair)
     {
         CLOG(ERROR, Logging::OPERATION_LOGGER) << "Failed to load asset pair for quote asset and default quote asset. SaleID: " 
@@ -220,7 +220,7 @@ bool
 OperationFrame::doApply(Application& app, LedgerDelta& delta,
 	LedgerManager& ledgerManager)
 {
-    StorageHelperImpl storageHelper(app.getDatabase(), &delta);
+    StorageHelperImpl storageHelper(app.getDatabase(), &delta, false);
     static_cast<StorageHelper&>(storageHelper).release();
     return doApply(app, storageHelper, ledgerManager);
 }
@@ -0,0 +1,139 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "transactions/SignaturePrechecker.h"
+#include "crypto/SecretKey.h"
+#include "main/Application.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace stellar
+{
+using xdr::operator==;
+
+const size_t SignaturePrechecker::MIN_PARALLEL_SIGNATURES;
+const size_t SignaturePrechecker::CHUNK_SIZE;
+
+namespace
+{
+struct SignatureCheck
+{
+    PublicKey mKey;
+    Signature mSignature;
+    Hash mContentsHash;
+};
+
+struct PrecheckState
+{
+    std::vector<SignatureCheck> mChecks;
+    std::atomic<size_t> mNext{0};
+    std::atomic<size_t> mDone{0};
+    std::mutex mMutex;
+    std::condition_variable mAllDone;
+};
+
+void
+addCandidate(std::vector<PublicKey>& candidates, PublicKey const& key)
+{
+    for (auto const& candidate : candidates)
+    {
+        if (candidate == key)
+        {
+            return;
+        }
+    }
+    candidates.push_back(key);
+}
+
+// takes chunks of checks until there are none left; runs both on workers
+// and on the calling thread
+void
+runChecks(std::shared_ptr<PrecheckState> state, size_t chunkSize)
+{
+    auto const total = state->mChecks.size();
+    for (;;)
+    {
+        auto begin = state->mNext.fetch_add(chunkSize);
+        if (begin >= total)
+        {
+            return;
+        }
+        auto end = std::min(begin + chunkSize, total);
+        for (auto i = begin; i < end; i++)
+        {
+            auto const& check = state->mChecks[i];
+            PubKeyUtils::verifySig(check.mKey, check.mSignature,
+                                   check.mContentsHash);
+        }
+        if (state->mDone.fetch_add(end - begin) + (end - begin) == total)
+        {
+            std::lock_guard<std::mutex> guard(state->mMutex);
+            state->mAllDone.notify_all();
+        }
+    }
+}
+}
+
+void
+SignaturePrechecker::precheck(Application& app,
+                              std::vector<TransactionFramePtr> const& txs)
+{
+    auto state = std::make_shared<PrecheckState>();
+
+    // hashes are cached lazily inside of frames, so everything touching the
+    // frames stays on this thread
+    std::vector<PublicKey> candidates;
+    for (auto const& tx : txs)
+    {
+        auto const& envelope = tx->getEnvelope();
+        candidates.clear();
+        addCandidate(candidates, envelope.tx.sourceAccount);
+        for (auto const& op : envelope.tx.operations)
+        {
+            if (op.sourceAccount)
+            {
+                addCandidate(candidates, *op.sourceAccount);
+            }
+        }
+        addCandidate(candidates, app.getMasterID());
+
+        for (auto const& sig : envelope.signatures)
+        {
+            for (auto const& key : candidates)
+            {
+                if (PubKeyUtils::hasHint(key, sig.hint))
+                {
+                    state->mChecks.push_back(
+                        {key, sig.signature, tx->getContentsHash()});
+                }
+            }
+        }
+    }
+
+    if (state->mChecks.size() < MIN_PARALLEL_SIGNATURES)
+    {
+        // checkValid will verify them serially, as before
+        return;
+    }
+
+    auto const workers = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < workers; i++)
+    {
+        app.getWorkerIOService().post(
+            [state]() { runChecks(state, CHUNK_SIZE); });
+    }
+    runChecks(state, CHUNK_SIZE);
+
+    // workers that have not started yet will find nothing left to take, so
+    // only the chunks already in flight are waited for
+    std::unique_lock<std::mutex> lock(state->mMutex);
+    state->mAllDone.wait(lock, [&state]() {
+        return state->mDone.load() == state->mChecks.size();
+    });
+}
+}
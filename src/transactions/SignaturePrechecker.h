@@ -0,0 +1,32 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "transactions/TransactionFrame.h"
+#include <vector>
+
+namespace stellar
+{
+class Application;
+
+// Verifies signatures of a batch of transactions on the worker threads ahead
+// of the serial checkValid pass. Only signatures that can be attributed
+// without loading ledger state are checked: the ones made by the transaction
+// or operation source account keys and by the master account key. Results
+// land in the process-wide verification cache, so when checkValid reaches
+// those signatures it only pays for a cache lookup.
+class SignaturePrechecker
+{
+  public:
+    static void precheck(Application& app,
+                         std::vector<TransactionFramePtr> const& txs);
+
+  private:
+    // below this many signatures the cost of handing work to other threads
+    // outweighs the gain
+    static const size_t MIN_PARALLEL_SIGNATURES = 32;
+    static const size_t CHUNK_SIZE = 16;
+};
+}
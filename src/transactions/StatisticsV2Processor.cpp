@@ -89,7 +89,7 @@ namespace stellar
 
             if (statisticsV2Frame->getConvertNeeded() && (assetCode != statisticsV2Frame->getAsset()))
             {
-                auto statsAssetPair = AssetPairHelper::Instance()->tryLoadAssetPairForAssets(assetCode,
+                auto statsAssetPair = AssetPairHelper::Instance()->findAssetPairForAssets(assetCode,
                                                                                        statisticsV2Frame->getAsset(),
                                                                                        mDb);
                 if (!statsAssetPair){
@@ -9,6 +9,7 @@
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "database/Database.h"
+#include "database/XDRBlob.h"
 #include "herder/TxSetFrame.h"
 #include "ledger/AccountHelper.h"
 #include "ledger/LedgerDelta.h"
@@ -59,20 +60,36 @@ saveTransactionHelper(Database& db, soci::session& sess, uint32 ledgerSeq,
     txResultOut.writeOne(results);
 }
 
-bool
-TransactionFrame::timingExists(Database& db, std::string txID)
+static void
+loadTimingIndex(Database& db, TxTimingIndex& index)
 {
-    int exists = 0;
-    auto timer = db.getSelectTimer("txtiming-exists");
-    auto prep = db.getPreparedStatement(
-        "SELECT EXISTS (SELECT NULL FROM txtiming WHERE txid=:id)");
+    std::string txID;
+    uint64 validBefore;
+    auto timer = db.getSelectTimer("txtiming-load");
+    auto prep =
+        db.getPreparedStatement("SELECT txid, valid_before FROM txtiming");
     auto& st = prep.statement();
-    st.exchange(soci::use(txID));
-    st.exchange(soci::into(exists));
+    st.exchange(soci::into(txID));
+    st.exchange(soci::into(validBefore));
     st.define_and_bind();
     st.execute(true);
+    while (st.got_data())
+    {
+        index.add(hexToBin256(txID), validBefore);
+        st.fetch();
+    }
+    index.setLoaded();
+}
 
-    return exists != 0;
+bool
+TransactionFrame::timingExists(Database& db, Hash const& txID)
+{
+    auto& index = db.getTxTimingIndex();
+    if (!index.isLoaded())
+    {
+        loadTimingIndex(db, index);
+    }
+    return index.exists(txID);
 }
 
 TransactionResultSet
@@ -89,16 +106,11 @@ TransactionFrame::getTransactionHistoryResults(Database& db, uint32 ledgerSeq)
     st.exchange(soci::into(txresult64));
     st.define_and_bind();
     st.execute(true);
+    std::vector<uint8_t> result;
     while (st.got_data())
     {
-        std::vector<uint8_t> result;
-        bn::decode_b64(txresult64, result);
-
         res.results.emplace_back();
-        TransactionResultPair& p = res.results.back();
-
-        xdr::xdr_get g(&result.front(), &result.back() + 1);
-        xdr_argpack_archive(g, p);
+        XDRBlob::decodeObject(db, txresult64, result, res.results.back());
 
         st.fetch();
     }
@@ -119,14 +131,11 @@ TransactionFrame::getTransactionFeeMeta(Database& db, uint32 ledgerSeq)
     st.exchange(soci::use(ledgerSeq));
     st.define_and_bind();
     st.execute(true);
+    std::vector<uint8_t> changesRaw;
     while (st.got_data())
     {
-        std::vector<uint8_t> changesRaw;
-        bn::decode_b64(changes64, changesRaw);
-
-        xdr::xdr_get g1(&changesRaw.front(), &changesRaw.back() + 1);
         res.emplace_back();
-        xdr_argpack_archive(g1, res.back());
+        XDRBlob::decodeObject(db, changes64, changesRaw, res.back());
 
         st.fetch();
     }
@@ -166,6 +175,7 @@ TransactionFrame::copyTransactionsToStream(Hash const& networkID, Database& db,
     uint32_t lastLedgerSeq = curLedgerSeq;
     results.ledgerSeq = curLedgerSeq;
 
+    std::vector<uint8_t> body, result;
     while (st.got_data())
     {
         if (curLedgerSeq != lastLedgerSeq)
@@ -179,24 +189,15 @@ TransactionFrame::copyTransactionsToStream(Hash const& networkID, Database& db,
             lastLedgerSeq = curLedgerSeq;
         }
 
-        std::vector<uint8_t> body;
-        bn::decode_b64(txBody, body);
-
-        std::vector<uint8_t> result;
-        bn::decode_b64(txResult, result);
-
-        xdr::xdr_get g1(&body.front(), &body.back() + 1);
-        xdr_argpack_archive(g1, tx);
+        XDRBlob::decodeObject(db, txBody, body, tx);
 
         TransactionFramePtr txFrame =
             make_shared<TransactionFrameImpl>(networkID, tx);
         txSet.add(txFrame);
 
-        xdr::xdr_get g2(&result.front(), &result.back() + 1);
         results.txResultSet.results.emplace_back();
-
         TransactionResultPair& p = results.txResultSet.results.back();
-        xdr_argpack_archive(g2, p);
+        XDRBlob::decodeObject(db, txResult, result, p);
 
         if (p.transactionHash != txFrame->getContentsHash())
         {
@@ -222,6 +223,7 @@ TransactionFrame::dropAll(Database& db)
     db.getSession() << "DROP TABLE IF EXISTS txfeehistory";
 
     db.getSession() << "DROP TABLE IF EXISTS txtiming";
+    db.getTxTimingIndex().clear();
 
     db.getSession() << "CREATE TABLE txhistory ("
                        "txid        CHARACTER(64) NOT NULL,"
@@ -263,5 +265,6 @@ TransactionFrame::deleteOldEntries(Database& db, uint32_t ledgerSeq,
                     << ledgerSeq;
     db.getSession() << "DELETE FROM txtiming WHERE valid_before < "
                     << ledgerCloseTime;
+    db.getTxTimingIndex().expire(ledgerCloseTime);
 }
 }
@@ -30,6 +30,7 @@ class LedgerDelta;
 class SecretKey;
 class XDROutputFileStream;
 class SHA256;
+class TxHistoryWriter;
 
 class TransactionFrame;
 typedef std::shared_ptr<TransactionFrame> TransactionFramePtr;
@@ -81,7 +82,7 @@ class TransactionFrame
     // returns true if successfully applied
     virtual bool
     apply(LedgerDelta& delta, TransactionMeta& meta, Application& app,
-          std::vector<LedgerDelta::KeyEntryMap>& stateBeforeOp) = 0;
+          std::vector<LedgerDelta::StateSnapshot>& stateBeforeOp) = 0;
 
     // version without meta
     virtual bool apply(LedgerDelta& delta, Application& app) = 0;
@@ -92,17 +93,19 @@ class TransactionFrame
                                               AccountID const& accountID) = 0;
 
 
-    // transaction history
+    // transaction history, rows are buffered in `writer` until it is flushed
     virtual void storeTransaction(LedgerManager& ledgerManager,
+                                  TxHistoryWriter& writer,
                                   TransactionMeta& tm, int txindex,
                                   TransactionResultSet& resultSet) const = 0;
 
     // fee history
     virtual void storeTransactionFee(LedgerManager& ledgerManager,
+                                     TxHistoryWriter& writer,
                                      LedgerEntryChanges const& changes,
                                      int txindex) const = 0;
 
-    virtual void storeTransactionTiming(LedgerManager& ledgerManager,
+    virtual void storeTransactionTiming(TxHistoryWriter& writer,
                                         uint64 maxTime) const = 0;
 
     // transaction fee
@@ -120,7 +123,10 @@ class TransactionFrame
     static std::vector<LedgerEntryChanges>
     getTransactionFeeMeta(Database& db, uint32 ledgerSeq);
     
-    static bool timingExists(Database& db, std::string txID);
+    // replay protection: true if a transaction with contents hash `txID`
+    // was applied and has not expired yet; answered from
+    // Database::getTxTimingIndex(), which is loaded from txtiming on first use
+    static bool timingExists(Database& db, Hash const& txID);
 
     /*
     txOut: stream of TransactionHistoryEntry
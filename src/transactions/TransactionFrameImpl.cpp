@@ -8,6 +8,7 @@
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "database/Database.h"
+#include "database/XDRBlob.h"
 #include "herder/TxSetFrame.h"
 #include "ledger/AccountHelper.h"
 #include "ledger/BalanceHelperLegacy.h"
@@ -17,6 +18,7 @@
 #include "ledger/StorageHelperImpl.h"
 #include "main/Application.h"
 #include "transactions/ManageKeyValueOpFrame.h"
+#include "transactions/TxHistoryWriter.h"
 #include "util/Logging.h"
 #include "util/XDRStream.h"
 #include "util/asio.h"
@@ -485,8 +487,7 @@ TransactionFrameImpl::checkValid(Application& app)
         return false;
     }
 
-    string txIDString(binToHex(getContentsHash()));
-    if (TransactionFrame::timingExists(app.getDatabase(), txIDString))
+    if (TransactionFrame::timingExists(app.getDatabase(), getContentsHash()))
     {
         app.getMetrics()
             .NewMeter({"transaction", "invalid", "duplication"}, "transaction")
@@ -523,7 +524,7 @@ TransactionFrameImpl::markResultFailed()
 bool
 TransactionFrameImpl::applyTx(LedgerDelta& delta, TransactionMeta& meta,
                               Application& app,
-                              vector<LedgerDelta::KeyEntryMap>& stateBeforeOp)
+                              vector<LedgerDelta::StateSnapshot>& stateBeforeOp)
 {
     resetSignatureTracker();
     if (!commonValid(app, &delta))
@@ -561,7 +562,11 @@ TransactionFrameImpl::applyTx(LedgerDelta& delta, TransactionMeta& meta,
             auto time = opTimer.TimeScope();
             LedgerDeltaImpl opDeltaImpl(thisTxDelta);
             LedgerDelta& opDelta = opDeltaImpl;
-            StorageHelperImpl storageHelperImpl(app.getDatabase(), &opDelta);
+            // sqlTx already guards the SQL state of the whole transaction and
+            // the operation is never rolled back on its own, so there is no
+            // need for a savepoint per operation
+            StorageHelperImpl storageHelperImpl(app.getDatabase(), &opDelta,
+                                                false);
             StorageHelper& storageHelper = storageHelperImpl;
             bool txRes = op->apply(storageHelper, app);
 
@@ -627,14 +632,14 @@ bool
 TransactionFrameImpl::apply(LedgerDelta& delta, Application& app)
 {
     TransactionMeta tm;
-    vector<LedgerDelta::KeyEntryMap> stateBeforeOp;
+    vector<LedgerDelta::StateSnapshot> stateBeforeOp;
     return apply(delta, tm, app, stateBeforeOp);
 }
 
 bool
 TransactionFrameImpl::apply(LedgerDelta& delta, TransactionMeta& meta,
                             Application& app,
-                            vector<LedgerDelta::KeyEntryMap>& stateBeforeOp)
+                            vector<LedgerDelta::StateSnapshot>& stateBeforeOp)
 {
     try
     {
@@ -661,6 +666,7 @@ TransactionFrameImpl::toStellarMessage() const
 
 void
 TransactionFrameImpl::storeTransaction(LedgerManager& ledgerManager,
+                                       TxHistoryWriter& writer,
                                        TransactionMeta& tm, int txindex,
                                        TransactionResultSet& resultSet) const
 {
@@ -669,42 +675,14 @@ TransactionFrameImpl::storeTransaction(LedgerManager& ledgerManager,
     resultSet.results.emplace_back(getResultPair());
     auto txResultBytes(xdr::xdr_to_opaque(resultSet.results.back()));
 
-    std::string txBody;
-    txBody = bn::encode_b64(txBytes);
-
-    std::string txResult;
-    txResult = bn::encode_b64(txResultBytes);
-
     xdr::opaque_vec<> txMeta(xdr::xdr_to_opaque(tm));
 
-    std::string meta;
-    meta = bn::encode_b64(txMeta);
-
-    string txIDString(binToHex(getContentsHash()));
-
     auto& db = ledgerManager.getDatabase();
-    auto prep = db.getPreparedStatement(
-        "INSERT INTO txhistory "
-        "( txid, ledgerseq, txindex,  txbody, txresult, txmeta) VALUES "
-        "(:id,  :seq,      :txindex, :txb,   :txres,   :meta)");
-
-    auto& st = prep.statement();
-    st.exchange(soci::use(txIDString));
-    st.exchange(soci::use(ledgerManager.getCurrentLedgerHeader().ledgerSeq));
-    st.exchange(soci::use(txindex));
-    st.exchange(soci::use(txBody));
-    st.exchange(soci::use(txResult));
-    st.exchange(soci::use(meta));
-    st.define_and_bind();
-    {
-        auto timer = db.getInsertTimer("txhistory");
-        st.execute(true);
-    }
-
-    if (st.get_affected_rows() != 1)
-    {
-        throw std::runtime_error("Could not update data in SQL");
-    }
+    writer.addTransaction(binToHex(getContentsHash()),
+                          ledgerManager.getCurrentLedgerHeader().ledgerSeq,
+                          txindex, XDRBlob::encode(db, txBytes),
+                          XDRBlob::encode(db, txResultBytes),
+                          XDRBlob::encode(db, txMeta));
 }
 
 void
@@ -715,63 +693,24 @@ TransactionFrameImpl::processSeqNum()
 }
 
 void
-TransactionFrameImpl::storeTransactionTiming(LedgerManager& ledgerManager,
+TransactionFrameImpl::storeTransactionTiming(TxHistoryWriter& writer,
                                              uint64 maxTime) const
 {
-    string txIDString(binToHex(getContentsHash()));
-
-    auto& db = ledgerManager.getDatabase();
-    auto prep = db.getPreparedStatement("INSERT INTO txtiming "
-                                        "( txid, valid_before) VALUES "
-                                        "(:id,  :vb)");
-
-    auto& st = prep.statement();
-    st.exchange(soci::use(txIDString));
-    st.exchange(soci::use(maxTime));
-    st.define_and_bind();
-    {
-        auto timer = db.getInsertTimer("txtiming");
-        st.execute(true);
-    }
-
-    if (st.get_affected_rows() != 1)
-    {
-        throw std::runtime_error("Could not update data in SQL");
-    }
+    writer.addTransactionTiming(getContentsHash(), maxTime);
 }
 
 void
 TransactionFrameImpl::storeTransactionFee(LedgerManager& ledgerManager,
+                                          TxHistoryWriter& writer,
                                           LedgerEntryChanges const& changes,
                                           int txindex) const
 {
     xdr::opaque_vec<> txChanges(xdr::xdr_to_opaque(changes));
 
-    std::string txChanges64;
-    txChanges64 = bn::encode_b64(txChanges);
-
-    string txIDString(binToHex(getContentsHash()));
-
-    auto& db = ledgerManager.getDatabase();
-    auto prep = db.getPreparedStatement(
-        "INSERT INTO txfeehistory "
-        "( txid, ledgerseq, txindex,  txchanges) VALUES "
-        "(:id,  :seq,      :txindex, :txchanges)");
-
-    auto& st = prep.statement();
-    st.exchange(soci::use(txIDString));
-    st.exchange(soci::use(ledgerManager.getCurrentLedgerHeader().ledgerSeq));
-    st.exchange(soci::use(txindex));
-    st.exchange(soci::use(txChanges64));
-    st.define_and_bind();
-    {
-        auto timer = db.getInsertTimer("txfeehistory");
-        st.execute(true);
-    }
-
-    if (st.get_affected_rows() != 1)
-    {
-        throw std::runtime_error("Could not update data in SQL");
-    }
+    writer.addTransactionFee(binToHex(getContentsHash()),
+                             ledgerManager.getCurrentLedgerHeader().ledgerSeq,
+                             txindex,
+                             XDRBlob::encode(ledgerManager.getDatabase(),
+                                             txChanges));
 }
 } // namespace stellar
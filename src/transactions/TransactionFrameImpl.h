@@ -46,7 +46,7 @@ class TransactionFrameImpl : public TransactionFrame
     void resetResults();
     void markResultFailed();
 
-    bool applyTx(LedgerDelta& delta, TransactionMeta& meta, Application& app, std::vector<LedgerDelta::KeyEntryMap>& stateBeforeOp);
+    bool applyTx(LedgerDelta& delta, TransactionMeta& meta, Application& app, std::vector<LedgerDelta::StateSnapshot>& stateBeforeOp);
     static void unwrapNestedException(const std::exception& e, std::stringstream& str);
 
   public:
@@ -147,7 +147,7 @@ class TransactionFrameImpl : public TransactionFrame
 
     // apply this transaction to the current ledger
     // returns true if successfully applied
-    bool apply(LedgerDelta& delta, TransactionMeta& meta, Application& app, std::vector<LedgerDelta::KeyEntryMap>& stateBeforeOp);
+    bool apply(LedgerDelta& delta, TransactionMeta& meta, Application& app, std::vector<LedgerDelta::StateSnapshot>& stateBeforeOp);
 
     // version without meta
     bool apply(LedgerDelta& delta, Application& app);
@@ -159,16 +159,18 @@ class TransactionFrameImpl : public TransactionFrame
 
 
     // transaction history
-    void storeTransaction(LedgerManager& ledgerManager, TransactionMeta& tm,
+    void storeTransaction(LedgerManager& ledgerManager,
+                          TxHistoryWriter& writer, TransactionMeta& tm,
                           int txindex, TransactionResultSet& resultSet) const;
 
     // fee history
     void storeTransactionFee(LedgerManager& ledgerManager,
+                             TxHistoryWriter& writer,
                              LedgerEntryChanges const& changes,
                              int txindex) const;
 
-    void storeTransactionTiming(LedgerManager& ledgerManager,
-                                      uint64 maxTime) const;
+    void storeTransactionTiming(TxHistoryWriter& writer,
+                                uint64 maxTime) const;
 
     // transaction fee
     bool processTxFee(Application& app, LedgerDelta* delta) override;
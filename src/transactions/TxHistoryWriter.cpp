@@ -0,0 +1,176 @@
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "transactions/TxHistoryWriter.h"
+#include "crypto/Hex.h"
+#include "database/Database.h"
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+namespace stellar
+{
+
+using namespace std;
+
+const size_t TxHistoryWriter::MAX_ROWS_PER_INSERT = 128;
+
+namespace
+{
+string
+buildInsert(string const& head, size_t columns, size_t rows)
+{
+    ostringstream sql;
+    sql << head << " VALUES ";
+    size_t n = 0;
+    for (size_t r = 0; r < rows; r++)
+    {
+        sql << (r == 0 ? "(" : ", (");
+        for (size_t c = 0; c < columns; c++)
+        {
+            sql << (c == 0 ? ":v" : ", :v") << n++;
+        }
+        sql << ")";
+    }
+    return sql.str();
+}
+
+// Splits `rows` into chunks of at most `maxRows` rows and writes
+// each chunk with a single statement; `bind` exchanges the columns of one
+// row with the statement.
+template <typename Row, typename Bind>
+void
+insertChunked(Database& db, vector<Row>& rows, string const& table,
+              string const& head, size_t columns, size_t maxRows, Bind bind)
+{
+    for (size_t begin = 0; begin < rows.size(); begin += maxRows)
+    {
+        auto const end = min(rows.size(), begin + maxRows);
+        auto prep =
+            db.getPreparedStatement(buildInsert(head, columns, end - begin));
+        auto& st = prep.statement();
+        for (auto i = begin; i < end; i++)
+        {
+            bind(st, rows[i]);
+        }
+        st.define_and_bind();
+        {
+            auto timer = db.getInsertTimer(table);
+            st.execute(true);
+        }
+
+        if (st.get_affected_rows() != static_cast<long long>(end - begin))
+        {
+            throw runtime_error("Could not update data in SQL");
+        }
+    }
+    rows.clear();
+}
+}
+
+TxHistoryWriter::TxHistoryWriter(Database& db, size_t maxRowsPerInsert)
+    : mDb(db), mMaxRowsPerInsert(maxRowsPerInsert)
+{
+    assert(mMaxRowsPerInsert > 0 && mMaxRowsPerInsert <= MAX_ROWS_PER_INSERT);
+}
+
+void
+TxHistoryWriter::addTransaction(string txID, uint32_t ledgerSeq, int txIndex,
+                                string txBody, string txResult, string txMeta)
+{
+    mHistory.push_back({move(txID), ledgerSeq, txIndex, move(txBody),
+                        move(txResult), move(txMeta)});
+}
+
+void
+TxHistoryWriter::addTransactionFee(string txID, uint32_t ledgerSeq,
+                                   int txIndex, string txChanges)
+{
+    mFees.push_back({move(txID), ledgerSeq, txIndex, move(txChanges)});
+}
+
+void
+TxHistoryWriter::addTransactionTiming(Hash const& txID, uint64 validBefore)
+{
+    mTimings.push_back({txID, binToHex(txID), validBefore});
+}
+
+size_t
+TxHistoryWriter::pendingRows() const
+{
+    return mHistory.size() + mFees.size() + mTimings.size();
+}
+
+void
+TxHistoryWriter::flush()
+{
+    flushFees();
+    flushTimings();
+    flushHistory();
+}
+
+void
+TxHistoryWriter::flushHistory()
+{
+    insertChunked(
+        mDb, mHistory, "txhistory",
+        "INSERT INTO txhistory "
+        "(txid, ledgerseq, txindex, txbody, txresult, txmeta)",
+        6, mMaxRowsPerInsert,
+        [](soci::statement& st, HistoryRow& row) {
+            st.exchange(soci::use(row.mTxID));
+            st.exchange(soci::use(row.mLedgerSeq));
+            st.exchange(soci::use(row.mTxIndex));
+            st.exchange(soci::use(row.mTxBody));
+            st.exchange(soci::use(row.mTxResult));
+            st.exchange(soci::use(row.mTxMeta));
+        });
+}
+
+void
+TxHistoryWriter::flushFees()
+{
+    insertChunked(mDb, mFees, "txfeehistory",
+                  "INSERT INTO txfeehistory "
+                  "(txid, ledgerseq, txindex, txchanges)",
+                  4, mMaxRowsPerInsert,
+                  [](soci::statement& st, FeeRow& row) {
+                      st.exchange(soci::use(row.mTxID));
+                      st.exchange(soci::use(row.mLedgerSeq));
+                      st.exchange(soci::use(row.mTxIndex));
+                      st.exchange(soci::use(row.mTxChanges));
+                  });
+}
+
+void
+TxHistoryWriter::indexTimings()
+{
+    auto& index = mDb.getTxTimingIndex();
+    // an index that is not loaded yet picks the rows up from the table
+    if (index.isLoaded())
+    {
+        for (auto const& timing : mFlushedTimings)
+        {
+            index.add(timing.first, timing.second);
+        }
+    }
+    mFlushedTimings.clear();
+}
+
+void
+TxHistoryWriter::flushTimings()
+{
+    for (auto const& row : mTimings)
+    {
+        mFlushedTimings.emplace_back(row.mTxHash, row.mValidBefore);
+    }
+    insertChunked(mDb, mTimings, "txtiming",
+                  "INSERT INTO txtiming (txid, valid_before)", 2,
+                  mMaxRowsPerInsert,
+                  [](soci::statement& st, TimingRow& row) {
+                      st.exchange(soci::use(row.mTxID));
+                      st.exchange(soci::use(row.mValidBefore));
+                  });
+}
+}
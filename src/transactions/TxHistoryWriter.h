@@ -0,0 +1,92 @@
+#pragma once
+
+// Copyright 2014 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+class Database;
+
+/**
+ * Buffers the txhistory, txfeehistory and txtiming rows produced while a
+ * ledger is being closed and writes them with a handful of multi-row INSERTs
+ * instead of one round trip per row and table.
+ *
+ * flush() must be called inside the SQL transaction of the ledger close; rows
+ * that were never flushed are dropped together with the writer. Once that
+ * transaction is committed, indexTimings() makes the flushed txtiming rows
+ * visible to the database's TxTimingIndex.
+ */
+class TxHistoryWriter : NonMovableOrCopyable
+{
+  public:
+    // upper bound on rows per INSERT statement, keeps the number of bound
+    // parameters below the SQLite limit (999)
+    static const size_t MAX_ROWS_PER_INSERT;
+
+    // `maxRowsPerInsert` of 1 writes row by row, which only benchmarks want
+    explicit TxHistoryWriter(Database& db,
+                             size_t maxRowsPerInsert = MAX_ROWS_PER_INSERT);
+
+    void addTransaction(std::string txID, uint32_t ledgerSeq, int txIndex,
+                        std::string txBody, std::string txResult,
+                        std::string txMeta);
+
+    void addTransactionFee(std::string txID, uint32_t ledgerSeq, int txIndex,
+                           std::string txChanges);
+
+    void addTransactionTiming(Hash const& txID, uint64 validBefore);
+
+    // writes all buffered rows to the database
+    void flush();
+
+    // adds the txtiming rows written so far to Database::getTxTimingIndex();
+    // must only be called after the enclosing SQL transaction was committed
+    void indexTimings();
+
+    size_t pendingRows() const;
+
+  private:
+    struct HistoryRow
+    {
+        std::string mTxID;
+        uint32_t mLedgerSeq;
+        int mTxIndex;
+        std::string mTxBody;
+        std::string mTxResult;
+        std::string mTxMeta;
+    };
+
+    struct FeeRow
+    {
+        std::string mTxID;
+        uint32_t mLedgerSeq;
+        int mTxIndex;
+        std::string mTxChanges;
+    };
+
+    struct TimingRow
+    {
+        Hash mTxHash;
+        std::string mTxID;
+        uint64 mValidBefore;
+    };
+
+    Database& mDb;
+    size_t const mMaxRowsPerInsert;
+    std::vector<HistoryRow> mHistory;
+    std::vector<FeeRow> mFees;
+    std::vector<TimingRow> mTimings;
+    std::vector<std::pair<Hash, uint64>> mFlushedTimings;
+
+    void flushHistory();
+    void flushFees();
+    void flushTimings();
+};
+}
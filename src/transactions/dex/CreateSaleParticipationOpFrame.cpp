@@ -314,7 +314,7 @@ bool CreateSaleParticipationOpFrame::getSaleCurrentCap(const SaleFrame::pointer
             continue;
         }
 
-        const auto assetPair = AssetPairHelper::Instance()->tryLoadAssetPairForAssets(quoteAsset.quoteAsset, saleEntry.defaultQuoteAsset, db);
+        const auto assetPair = AssetPairHelper::Instance()->findAssetPairForAssets(quoteAsset.quoteAsset, saleEntry.defaultQuoteAsset, db);
         if (!assetPair)
         {
             CLOG(ERROR, Logging::OPERATION_LOGGER) << "Unexpected state: failed to load asset pair for sale: " << saleEntry.saleID
@@ -195,15 +195,21 @@ namespace stellar {
     void ManageSaleOpFrame::cancelAllOffersForQuoteAsset(SaleFrame::pointer sale, SaleQuoteAsset const &saleQuoteAsset,
                                                          LedgerDelta &delta, Database &db) {
         auto orderBookID = sale->getID();
-        const auto offersToCancel = OfferHelper::Instance()->loadOffersWithFilters(sale->getBaseAsset(),
-                                                                                   saleQuoteAsset.quoteAsset,
-                                                                                   &orderBookID, nullptr, db);
-        OfferManager::deleteOffers(offersToCancel, db, delta);
+        OfferHelper::Instance()->forEachOfferPage(sale->getBaseAsset(), saleQuoteAsset.quoteAsset, orderBookID,
+                                                  nullptr, [&](std::vector<OfferFrame::pointer> const &offersToCancel) {
+            OfferManager::deleteOffers(offersToCancel, db, delta);
+        }, db);
     }
 
     void ManageSaleOpFrame::deleteAllAntesForSale(uint64_t saleID, LedgerDelta &delta, Database &db) {
-        auto saleAntes = SaleAnteHelper::Instance()->loadSaleAntesForSale(saleID, db);
-        for (auto &saleAnte : saleAntes) {
+        auto saleAnteHelper = SaleAnteHelper::Instance();
+        auto saleAntes = saleAnteHelper->loadSaleAntesForSale(saleID, db);
+        for (size_t i = 0; i < saleAntes.size(); i++) {
+            if (i % EntryHelperLegacy::MAX_KEYS_PER_LOAD == 0) {
+                saleAnteHelper->loadParticipantBalances(saleAntes, i, db);
+            }
+
+            auto &saleAnte = saleAntes[i];
             auto participantBalanceFrame = BalanceHelperLegacy::Instance()->mustLoadBalance(
                     saleAnte->getParticipantBalanceID(),
                     db, &delta);
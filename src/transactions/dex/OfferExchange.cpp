@@ -8,6 +8,7 @@
 #include "ledger/LedgerManager.h"
 #include "ledger/BalanceHelperLegacy.h"
 #include "ledger/OfferHelper.h"
+#include "OrderBookCursor.h"
 #include "util/Logging.h"
 #include "xdrpp/printer.h"
 
@@ -352,69 +353,52 @@ OfferExchange::convertWithOffers(
     BalanceFrame::pointer quoteBalanceA,
     std::function<OfferFilterResult(OfferFrame const&)> filter)
 {
-    const size_t OFFERS_TO_TAKE = 5;
     Database& db = mLedgerManager.getDatabase();
 
-    size_t offerOffset = 0;
+    OrderBookCursor book(mAssetPair->getBaseAsset(),
+                         mAssetPair->getQuoteAsset(), mOrderBookID,
+                         !offerA.isBuy, db);
 
     while (offerNeedsMore(offerA))
     {
-        std::vector<OfferFrame::pointer> retList;
-        auto offerHelper = OfferHelper::Instance();
-        offerHelper->loadBestOffers(OFFERS_TO_TAKE, offerOffset,
-                                    mAssetPair->getBaseAsset(),
-                                    mAssetPair->getQuoteAsset(), mOrderBookID, !offerA.isBuy,
-                                    retList, db);
-
-        offerOffset += retList.size();
-
-        for (auto& offerB : retList)
+        auto offerB = book.next();
+        // still stuff to fill but no more offers
+        if (!offerB)
         {
-            if (filter)
-            {
-                OfferFilterResult r = filter(*offerB);
-                switch (r)
-                {
-                case eKeep:
-                    break;
-                case eStop:
-                    return eFilterStop;
-                case eSkip:
-                    continue;
-                }
-            }
-
-            CrossOfferResult cor = crossOffer(offerA, baseBalanceA,
-                                              quoteBalanceA, *offerB);
+            return eOK;
+        }
 
-            switch (cor)
+        if (filter)
+        {
+            OfferFilterResult r = filter(*offerB);
+            switch (r)
             {
-            case eOfferTaken:
-                assert(offerOffset > 0);
-                offerOffset--; // adjust offset as an offer was deleted
-                break;
-            case eOfferPartial:
+            case eKeep:
                 break;
-            case eOfferCantConvert:
-                return ePartial;
+            case eStop:
+                return eFilterStop;
+            case eSkip:
+                continue;
             }
+        }
 
-            if (!offerNeedsMore(offerA))
-            {
-                return eOK;
-            }
+        CrossOfferResult cor = crossOffer(offerA, baseBalanceA,
+                                          quoteBalanceA, *offerB);
 
-            if (cor == eOfferPartial)
-            {
-                return ePartial;
-            }
+        if (cor == eOfferCantConvert)
+        {
+            return ePartial;
         }
 
-        // still stuff to fill but no more offers
-        if (offerNeedsMore(offerA) && retList.size() < OFFERS_TO_TAKE)
+        if (!offerNeedsMore(offerA))
         {
             return eOK;
         }
+
+        if (cor == eOfferPartial)
+        {
+            return ePartial;
+        }
     }
     return eOK;
 }
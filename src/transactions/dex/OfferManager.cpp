@@ -7,6 +7,7 @@
 #include "ledger/LedgerDelta.h"
 #include "xdrpp/printer.h"
 #include "ledger/FeeHelper.h"
+#include <algorithm>
 
 namespace stellar
 {
@@ -35,11 +36,37 @@ void OfferManager::deleteOffer(OfferFrame::pointer offerFrame, Database& db,
 void OfferManager::deleteOffers(std::vector<OfferFrame::pointer> offers,
     Database& db, LedgerDelta& delta)
 {
-    for (auto& offer : offers)
+    auto const batchSize = EntryHelperLegacy::MAX_KEYS_PER_LOAD;
+    for (size_t begin = 0; begin < offers.size(); begin += batchSize)
     {
-        delta.recordEntry(*offer);
-        deleteOffer(offer, db, delta);
+        auto const end = std::min(offers.size(), begin + batchSize);
+
+        std::vector<BalanceID> balanceIDs;
+        for (auto i = begin; i < end; i++)
+        {
+            balanceIDs.push_back(offers[i]->getLockedBalance());
+        }
+        BalanceHelperLegacy::Instance()->loadBalancesByID(balanceIDs, db);
+
+        for (auto i = begin; i < end; i++)
+        {
+            delta.recordEntry(*offers[i]);
+            deleteOffer(offers[i], db, delta);
+        }
+    }
+}
+
+void OfferManager::loadOfferBalances(std::vector<OfferFrame::pointer> const& offers,
+    Database& db)
+{
+    std::vector<BalanceID> balanceIDs;
+    balanceIDs.reserve(offers.size() * 2);
+    for (auto const& offer : offers)
+    {
+        balanceIDs.push_back(offer->getOffer().baseBalance);
+        balanceIDs.push_back(offer->getOffer().quoteBalance);
     }
+    BalanceHelperLegacy::Instance()->loadBalancesByID(balanceIDs, db);
 }
 
 OfferFrame::pointer OfferManager::buildOffer(AccountID const& sourceID, ManageOfferOp const& op,
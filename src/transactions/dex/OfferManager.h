@@ -20,6 +20,8 @@ public:
     static void deleteOffer(OfferFrame::pointer offerFrame, Database& db, LedgerDelta& delta);
     // delets all offers and unlocks locked assets by that offers   
     static void deleteOffers(std::vector<OfferFrame::pointer> offers, Database& db, LedgerDelta& delta);
+    // Batch loads base and quote balances of the offers into the entry cache
+    static void loadOfferBalances(std::vector<OfferFrame::pointer> const& offers, Database& db);
     // Builds offer frame base on ManageOfferOp
     static OfferFrame::pointer buildOffer(AccountID const& sourceID, ManageOfferOp const& op, AssetCode const& base, AssetCode const& quote);
     // Builds ManageOfferOp base on based params
@@ -0,0 +1,74 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "OrderBookCursor.h"
+#include "ledger/OfferHelper.h"
+#include "transactions/dex/OfferManager.h"
+#include <algorithm>
+
+namespace stellar
+{
+const size_t OrderBookCursor::FIRST_PAGE_SIZE;
+const size_t OrderBookCursor::MAX_PAGE_SIZE;
+
+OrderBookCursor::OrderBookCursor(AssetCode const& base, AssetCode const& quote,
+                                 uint64_t orderBookID, bool isBuy,
+                                 Database& db)
+    : mBase(base)
+    , mQuote(quote)
+    , mOrderBookID(orderBookID)
+    , mIsBuy(isBuy)
+    , mDb(db)
+    , mPageSize(FIRST_PAGE_SIZE)
+    , mHasLastLoaded(false)
+    , mExhausted(false)
+{
+}
+
+OfferFrame::pointer
+OrderBookCursor::next()
+{
+    if (mPage.empty() && !mExhausted)
+    {
+        loadPage();
+    }
+
+    if (mPage.empty())
+    {
+        return nullptr;
+    }
+
+    auto result = mPage.front();
+    mPage.pop_front();
+    return result;
+}
+
+void
+OrderBookCursor::loadPage()
+{
+    std::vector<OfferFrame::pointer> offers;
+    OfferHelper::Instance()->loadBestOffersAfter(
+        mPageSize, mHasLastLoaded ? &mLastLoaded : nullptr, mBase, mQuote,
+        mOrderBookID, mIsBuy, offers, mDb);
+
+    mExhausted = offers.size() < mPageSize;
+    mPageSize = std::min(mPageSize * 2, MAX_PAGE_SIZE);
+
+    if (offers.empty())
+    {
+        return;
+    }
+
+    // offers taken later are deleted from the book, so the cursor has to
+    // remember its position by value
+    mLastLoaded = offers.back()->getOffer();
+    mHasLastLoaded = true;
+
+    // every offer crossed loads both of its balances, fetch them for the
+    // whole page at once
+    OfferManager::loadOfferBalances(offers, mDb);
+
+    mPage.insert(mPage.end(), offers.begin(), offers.end());
+}
+}
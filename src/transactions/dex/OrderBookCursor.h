@@ -0,0 +1,46 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/OfferFrame.h"
+#include <deque>
+
+namespace stellar
+{
+class Database;
+
+// Walks one side of an order book in matching priority: best price first,
+// lowest offer id first among equal prices. Offers are fetched in pages that
+// grow geometrically and every page continues right after the last fetched
+// offer, so crossing a deep book costs O(depth) rows read instead of
+// rescanning the book with LIMIT/OFFSET for every few offers taken.
+class OrderBookCursor
+{
+  public:
+    OrderBookCursor(AssetCode const& base, AssetCode const& quote,
+                    uint64_t orderBookID, bool isBuy, Database& db);
+
+    // returns next offer of the book or nullptr if there are no more offers
+    OfferFrame::pointer next();
+
+  private:
+    static const size_t FIRST_PAGE_SIZE = 5;
+    static const size_t MAX_PAGE_SIZE = 1000;
+
+    void loadPage();
+
+    AssetCode const mBase;
+    AssetCode const mQuote;
+    uint64_t const mOrderBookID;
+    bool const mIsBuy;
+    Database& mDb;
+
+    std::deque<OfferFrame::pointer> mPage;
+    size_t mPageSize;
+    OfferEntry mLastLoaded;
+    bool mHasLastLoaded;
+    bool mExhausted;
+};
+}
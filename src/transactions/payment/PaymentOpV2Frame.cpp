@@ -246,7 +246,7 @@ namespace stellar {
 
         actualFee.feeAsset = feeFrame->getFeeAsset();
         if (actualFee.feeAsset != transferAsset) {
-            auto assetPair = AssetPairHelper::Instance()->tryLoadAssetPairForAssets(actualFee.feeAsset, transferAsset,
+            auto assetPair = AssetPairHelper::Instance()->findAssetPairForAssets(actualFee.feeAsset, transferAsset,
                                                                                     db);
             if (!assetPair) {
                 CLOG(ERROR, Logging::OPERATION_LOGGER)
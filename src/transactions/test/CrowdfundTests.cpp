@@ -22,6 +22,13 @@
 #include "test_helper/ParticipateInSaleTestHelper.h"
 #include "test_helper/ManageSaleTestHelper.h"
 #include "test_helper/ReviewPromotionUpdateRequestTestHelper.h"
+#include "transactions/dex/ManageSaleOpFrame.h"
+#include "ledger/LedgerDeltaImpl.h"
+#include "ledger/OfferHelper.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
 
 using namespace stellar;
 using namespace stellar::txtest;
@@ -314,3 +321,178 @@ TEST_CASE("Crowdfunding", "[tx][crowdfunding]")
         }
     }
 }
+
+TEST_CASE("Crowdfunding with more participants than an offer page", "[tx][crowdfunding]")
+{
+    using xdr::operator==;
+
+    Config const& cfg = getTestConfig(0, Config::TESTDB_POSTGRESQL);
+    VirtualClock clock;
+    const Application::pointer appPtr = Application::create(clock, cfg);
+    Application& app = *appPtr;
+    app.start();
+    auto testManager = TestManager::make(app);
+    TestManager::upgradeToCurrentLedgerVersion(app);
+
+    Database& db = testManager->getDB();
+    auto root = Account{ getRoot(), Salt(0) };
+
+    const AssetCode defaultQuoteAsset = "USD";
+    auto assetTestHelper = ManageAssetTestHelper(testManager);
+    auto assetCreationRequest = assetTestHelper.createAssetCreationRequest(defaultQuoteAsset, root.key.getPublicKey(), "{}", INT64_MAX,
+                                                                           uint32_t(AssetPolicy::BASE_ASSET));
+    assetTestHelper.applyManageAssetTx(root, 0, assetCreationRequest);
+
+    const AssetCode quoteAsset = "ETH";
+    assetCreationRequest = assetTestHelper.createAssetCreationRequest(quoteAsset, root.key.getPublicKey(), "{}", INT64_MAX,
+        uint32_t(AssetPolicy::BASE_ASSET));
+    assetTestHelper.applyManageAssetTx(root, 0, assetCreationRequest);
+    ManageAssetPairTestHelper(testManager).applyManageAssetPairTx(root, quoteAsset, defaultQuoteAsset, ONE, 0, 0);
+
+    auto syndicate = Account{ SecretKey::random(), 0 };
+    CreateAccountTestHelper(testManager).applyCreateAccountTx(root, syndicate.key.getPublicKey(), AccountType::SYNDICATE);
+    const AssetCode baseAsset = "XAU";
+    const uint64_t maxIssuanceAmount = 2000 * ONE;
+    assetCreationRequest = assetTestHelper.createAssetCreationRequest(baseAsset, syndicate.key.getPublicKey(), "{}",
+                                                                      maxIssuanceAmount, 0, maxIssuanceAmount);
+    assetTestHelper.createApproveRequest(root, syndicate, assetCreationRequest);
+
+    const uint64_t hardCap = 10000 * ONE;
+    const uint64_t softCap = hardCap / 2;
+    const auto currentTime = testManager->getLedgerManager().getCloseTime();
+    const auto endTime = currentTime + 1000;
+    SaleType saleType = SaleType::CROWD_FUNDING;
+    const uint64_t maxAmountToBeSold = maxIssuanceAmount / 2;
+    SaleRequestHelper saleRequestHelper(testManager);
+    const auto saleRequest = saleRequestHelper.createSaleRequest(baseAsset, defaultQuoteAsset, currentTime,
+        endTime, softCap, hardCap, "{}", { saleRequestHelper.createSaleQuoteAsset(quoteAsset, ONE) }, &saleType, &maxAmountToBeSold);
+    saleRequestHelper.createApprovedSale(root, syndicate, saleRequest);
+    auto sales = SaleHelper::Instance()->loadSalesForOwner(syndicate.key.getPublicKey(), db);
+    REQUIRE(sales.size() == 1);
+    uint64_t saleID = sales[0]->getID();
+
+    // every fourth participant invests just enough to get some tokens on soft
+    // cap, but not on close, so cleaning the sale cancels those offers
+    // while the rest of the order book is walked
+    const size_t numberOfParticipants = 2 * OfferHelper::OFFERS_PAGE_SIZE + 2;
+    const size_t numberOfSmallParticipants = (numberOfParticipants + 3) / 4;
+    const uint64_t smallQuoteAmount = 9;
+    const uint64_t quoteAmount = (hardCap - ONE) / (numberOfParticipants - numberOfSmallParticipants);
+    ParticipateInSaleTestHelper participationHelper(testManager);
+    for (size_t i = 0; i < numberOfParticipants; i++)
+    {
+        participationHelper.addNewParticipant(root, saleID, baseAsset, quoteAsset,
+                                              i % 4 == 0 ? smallQuoteAmount : quoteAmount, ONE, 0);
+    }
+
+    auto sortedOfferIDs = [](std::vector<OfferFrame::pointer> const& offers) -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> offerIDs;
+        for (auto const& offer : offers)
+        {
+            offerIDs.push_back(offer->getOfferID());
+        }
+        std::sort(offerIDs.begin(), offerIDs.end());
+        return offerIDs;
+    };
+
+    const auto offers = OfferHelper::Instance()->loadOffersWithFilters(baseAsset, quoteAsset, &saleID, nullptr, db);
+    REQUIRE(offers.size() == numberOfParticipants);
+    const auto offerIDs = sortedOfferIDs(offers);
+
+    SECTION("Offers deleted during the walk are visited at most once")
+    {
+        // deletes the offers of every page while they are processed, the
+        // first page also deletes the first offer of the next page and the
+        // last offer of the book
+        std::set<uint64_t> deletedAhead = { offerIDs[OfferHelper::OFFERS_PAGE_SIZE], offerIDs.back() };
+        std::map<uint64_t, int> visits;
+        LedgerDeltaImpl delta(testManager->getLedgerManager().getCurrentLedgerHeader(), db);
+        OfferHelper::Instance()->forEachOfferPage(baseAsset, quoteAsset, saleID, nullptr,
+                                                  [&](std::vector<OfferFrame::pointer> const& page)
+        {
+            for (auto const& offer : page)
+            {
+                visits[offer->getOfferID()]++;
+            }
+            OfferManager::deleteOffers(page, db, delta);
+            if (visits.size() == page.size())
+            {
+                std::vector<OfferFrame::pointer> offersAhead;
+                for (auto const& offer : offers)
+                {
+                    if (deletedAhead.count(offer->getOfferID()) > 0)
+                    {
+                        offersAhead.push_back(offer);
+                    }
+                }
+                OfferManager::deleteOffers(offersAhead, db, delta);
+            }
+        }, db);
+
+        REQUIRE(visits.size() == offerIDs.size() - deletedAhead.size());
+        for (auto offerID : offerIDs)
+        {
+            REQUIRE(visits[offerID] == (deletedAhead.count(offerID) > 0 ? 0 : 1));
+        }
+    }
+    SECTION("Cancelling the offers of a quote asset matches the unpaged path")
+    {
+        // the offers as cancelled before paging, rolled back afterwards
+        LedgerEntryChanges unpagedChanges;
+        {
+            soci::transaction sqlTx(db.getSession());
+            LedgerDeltaImpl delta(testManager->getLedgerManager().getCurrentLedgerHeader(), db);
+            OfferManager::deleteOffers(offers, db, delta);
+            unpagedChanges = delta.getChanges();
+        }
+
+        auto sale = SaleHelper::Instance()->loadSale(saleID, db);
+        LedgerDeltaImpl delta(testManager->getLedgerManager().getCurrentLedgerHeader(), db);
+        ManageSaleOpFrame::cancelAllOffersForQuoteAsset(sale, sale->getSaleEntry().quoteAssets[0], delta, db);
+        REQUIRE(delta.getChanges() == unpagedChanges);
+        REQUIRE(OfferHelper::Instance()->loadOffersWithFilters(baseAsset, quoteAsset, &saleID, nullptr, db).empty());
+    }
+    SECTION("Cleaning and closing visit every offer exactly once")
+    {
+        const auto smallOffers = OfferHelper::Instance()->loadOffers(baseAsset, quoteAsset, saleID, smallQuoteAmount + 1, db);
+        REQUIRE(smallOffers.size() == numberOfSmallParticipants);
+        const auto smallOfferIDs = sortedOfferIDs(smallOffers);
+        std::vector<uint64_t> expectedClaimedIDs;
+        std::set_difference(offerIDs.begin(), offerIDs.end(), smallOfferIDs.begin(), smallOfferIDs.end(),
+                            std::back_inserter(expectedClaimedIDs));
+
+        std::vector<BalanceFrame::pointer> smallQuoteBalancesBefore;
+        for (auto const& offer : smallOffers)
+        {
+            smallQuoteBalancesBefore.push_back(BalanceHelperLegacy::Instance()->mustLoadBalance(offer->getOffer().quoteBalance, db));
+        }
+
+        testManager->advanceToTime(endTime + 1);
+
+        CheckSaleStateHelper checkStateHelper(testManager);
+        auto checkRes = checkStateHelper.applyCheckSaleStateTx(root, saleID);
+        REQUIRE(checkRes.success().effect.effect() == CheckSaleStateEffect::UPDATED);
+        const auto offersLeft = OfferHelper::Instance()->loadOffersWithFilters(baseAsset, quoteAsset, &saleID, nullptr, db);
+        REQUIRE(sortedOfferIDs(offersLeft) == expectedClaimedIDs);
+        for (size_t i = 0; i < smallOffers.size(); i++)
+        {
+            auto quoteBalanceAfter = BalanceHelperLegacy::Instance()->mustLoadBalance(smallOffers[i]->getOffer().quoteBalance, db);
+            REQUIRE(quoteBalanceAfter->getLocked() == smallQuoteBalancesBefore[i]->getLocked() - smallOffers[i]->getLockedAmount());
+            REQUIRE(quoteBalanceAfter->getAmount() == smallQuoteBalancesBefore[i]->getAmount() + smallOffers[i]->getLockedAmount());
+        }
+
+        checkRes = checkStateHelper.applyCheckSaleStateTx(root, saleID);
+        REQUIRE(checkRes.success().effect.effect() == CheckSaleStateEffect::CLOSED);
+        std::vector<uint64_t> claimedIDs;
+        for (auto const& quoteAssetResult : checkRes.success().effect.saleClosed().results)
+        {
+            for (auto const& claimedOffer : quoteAssetResult.saleDetails.offersClaimed)
+            {
+                claimedIDs.push_back(claimedOffer.offerID);
+            }
+        }
+        std::sort(claimedIDs.begin(), claimedIDs.end());
+        REQUIRE(claimedIDs == expectedClaimedIDs);
+    }
+}
@@ -9,6 +9,7 @@
 #include "main/test.h"
 #include "TxTests.h"
 #include "transactions/dex/OfferExchange.h"
+#include "transactions/dex/OfferManager.h"
 #include "ledger/LedgerDeltaImpl.h"
 #include "ledger/BalanceHelperLegacy.h"
 #include "ledger/OfferHelper.h"
@@ -17,6 +18,7 @@
 #include "test_helper/ManageAssetPairTestHelper.h"
 #include "test_helper/ManageOfferTestHelper.h"
 #include "test/test_marshaler.h"
+#include <chrono>
 
 using namespace stellar;
 using namespace stellar::txtest;
@@ -680,3 +682,98 @@ TEST_CASE("manage offer", "[tx][offer]")
             quoteSellerBalance->getAmount() == quoteAssetAmount);
     }
 }
+
+TEST_CASE("match against deep order book", "[tx][offer][bench][hide]")
+{
+    const int64_t bookDepth = 100000;
+    const int64_t offersToTake = 2000;
+
+    Config const& cfg = getTestConfig(0, Config::TESTDB_POSTGRESQL);
+    VirtualClock clock;
+    Application::pointer appPtr = Application::create(clock, cfg);
+    Application& app = *appPtr;
+    app.start();
+    auto testManager = TestManager::make(app);
+    auto& db = testManager->getDB();
+
+    SecretKey root = getRoot();
+    auto rootAccount = Account{ root, 0 };
+    Salt rootSeq = 1;
+
+    auto assetTestHelper = ManageAssetTestHelper(testManager);
+    AssetCode base = "BTC";
+    assetTestHelper.createAsset(rootAccount, rootAccount.key, base, rootAccount, int32(AssetPolicy::BASE_ASSET));
+    AssetCode quote = "USD";
+    assetTestHelper.createAsset(rootAccount, rootAccount.key, quote, rootAccount, int32(AssetPolicy::BASE_ASSET));
+
+    auto assetPairHelper = ManageAssetPairTestHelper(testManager);
+    assetPairHelper.applyManageAssetPairTx(rootAccount, base, quote, 1, 0, 0, int32(AssetPairPolicy::TRADEABLE_SECONDARY_MARKET));
+
+    auto issuanceHelper = IssuanceRequestHelper(testManager);
+    auto fundAccount = [&issuanceHelper, &rootAccount](AssetCode code, uint64_t amount, BalanceID receiver)
+    {
+        issuanceHelper.authorizePreIssuedAmount(rootAccount, rootAccount.key, code, amount, rootAccount);
+        issuanceHelper.applyCreateIssuanceRequest(rootAccount, code, amount, receiver, SecretKey::random().getStrKeyPublic());
+    };
+
+    auto balanceHelper = BalanceHelperLegacy::Instance();
+
+    auto seller = Account{ SecretKey::random(), 0 };
+    applyCreateAccountTx(app, root, seller.key, rootSeq, AccountType::GENERAL);
+    auto baseSellerBalance = balanceHelper->loadBalance(seller.key.getPublicKey(), base, db);
+    auto quoteSellerBalance = balanceHelper->loadBalance(seller.key.getPublicKey(), quote, db);
+    fundAccount(base, bookDepth * ONE, baseSellerBalance->getBalanceID());
+
+    // the book is written directly, placing 100k offers through transactions
+    // would take far longer than matching against them
+    {
+        LedgerDeltaImpl deltaImpl(testManager->getLedgerManager().getCurrentLedgerHeader(), db);
+        LedgerDelta& delta = deltaImpl;
+        baseSellerBalance = balanceHelper->loadBalance(baseSellerBalance->getBalanceID(), db, &delta);
+        REQUIRE(baseSellerBalance->lockBalance(bookDepth * ONE) == BalanceFrame::Result::SUCCESS);
+        EntryHelperProvider::storeChangeEntry(delta, db, baseSellerBalance->mEntry);
+
+        LedgerEntry le;
+        le.data.type(LedgerEntryType::OFFER_ENTRY);
+        auto& offer = le.data.offer();
+        offer.ownerID = seller.key.getPublicKey();
+        offer.orderBookID = 0;
+        offer.base = base;
+        offer.quote = quote;
+        offer.isBuy = false;
+        offer.baseAmount = ONE;
+        offer.fee = 0;
+        offer.percentFee = 0;
+        offer.baseBalance = baseSellerBalance->getBalanceID();
+        offer.quoteBalance = quoteSellerBalance->getBalanceID();
+        offer.createdAt = testManager->getLedgerManager().getCloseTime();
+        for (int64_t i = 0; i < bookDepth; i++)
+        {
+            offer.offerID = delta.getHeaderFrame().generateID(LedgerEntryType::OFFER_ENTRY);
+            offer.price = ONE + i;
+            offer.quoteAmount = OfferManager::calculateQuoteAmount(offer.baseAmount, offer.price);
+            EntryHelperProvider::storeAddEntry(delta, db, le);
+        }
+        delta.commit();
+    }
+
+    auto buyer = Account{ SecretKey::random(), 0 };
+    applyCreateAccountTx(app, root, buyer.key, rootSeq, AccountType::GENERAL);
+    auto baseBuyerBalance = balanceHelper->loadBalance(buyer.key.getPublicKey(), base, db);
+    auto quoteBuyerBalance = balanceHelper->loadBalance(buyer.key.getPublicKey(), quote, db);
+
+    const int64_t buyPrice = ONE + offersToTake;
+    const int64_t buyAmount = offersToTake * ONE;
+    fundAccount(quote, OfferManager::calculateQuoteAmount(buyAmount, buyPrice), quoteBuyerBalance->getBalanceID());
+
+    auto offerTestHelper = ManageOfferTestHelper(testManager);
+    auto start = std::chrono::steady_clock::now();
+    auto result = offerTestHelper.applyManageOffer(buyer, 0, baseBuyerBalance->getBalanceID(),
+                                                   quoteBuyerBalance->getBalanceID(),
+                                                   buyAmount, buyPrice, true, 0);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    REQUIRE(result.success().offersClaimed.size() == offersToTake);
+    LOG(INFO) << "Matched " << offersToTake << " offers of " << bookDepth
+              << "-offer book in " << elapsed.count() << "ms";
+}
@@ -19,6 +19,8 @@ class MockDatabase : public Database
     MOCK_METHOD1(getPreparedStatement,
                  StatementContext(std::string const& query));
     MOCK_METHOD0(clearPreparedStatementCache, void());
+    MOCK_CONST_METHOD0(getPreparedStatementEntities,
+                       Database::StatementEntities());
     MOCK_METHOD1(getInsertTimer,
                  medida::TimerContext(std::string const& entityName));
     MOCK_METHOD1(getSelectTimer,
@@ -38,6 +40,12 @@ class MockDatabase : public Database
     MOCK_METHOD0(getSession, soci::session&());
     MOCK_METHOD0(getPool, soci::connection_pool&());
     MOCK_METHOD0(getEntryCache, Database::EntryCache&());
+    MOCK_METHOD0(getTxTimingIndex, TxTimingIndex&());
+    MOCK_METHOD0(getFeeIndex, FeeIndex&());
+    MOCK_METHOD0(getKeyValueIndex, KeyValueIndex&());
+    MOCK_METHOD0(getAssetPairCache, AssetPairCache&());
+    MOCK_METHOD0(getLedgerOverlay, LedgerOverlay&());
+    MOCK_CONST_METHOD0(hasBinaryXDRBlobs, bool());
 };
 
 } // namespace stellar
\ No newline at end of file
@@ -25,7 +25,7 @@ class MockLedgerDelta : public LedgerDelta
     MOCK_CONST_METHOD0(getChanges, LedgerEntryChanges());
     MOCK_CONST_METHOD0(getAllChanges, const LedgerEntryChanges&());
     MOCK_CONST_METHOD1(checkAgainstDatabase, void(Application& app));
-    MOCK_CONST_METHOD0(getState, KeyEntryMap());
+    MOCK_CONST_METHOD0(getState, StateSnapshot());
     MOCK_CONST_METHOD0(isStateActive, bool());
     MOCK_METHOD0(getDatabase, Database&());
     MOCK_CONST_METHOD0(getPreviousFrames, const KeyEntryMap&());
@@ -35,20 +35,22 @@ class MockTransactionFrame : public TransactionFrame
     MOCK_METHOD4(apply,
                  bool(LedgerDelta& delta, TransactionMeta& meta,
                       Application& app,
-                      std::vector<LedgerDelta::KeyEntryMap>& stateBeforeOp));
+                      std::vector<LedgerDelta::StateSnapshot>& stateBeforeOp));
     MOCK_METHOD2(apply, bool(LedgerDelta& delta, Application& app));
     MOCK_CONST_METHOD0(toStellarMessage, StellarMessage());
     MOCK_METHOD3(loadAccount,
                  AccountFrame::pointer(LedgerDelta* delta, Database& app,
                                        AccountID const& accountID));
-    MOCK_CONST_METHOD4(storeTransaction,
-                       void(LedgerManager& ledgerManager, TransactionMeta& tm,
+    MOCK_CONST_METHOD5(storeTransaction,
+                       void(LedgerManager& ledgerManager,
+                            TxHistoryWriter& writer, TransactionMeta& tm,
                             int txindex, TransactionResultSet& resultSet));
-    MOCK_CONST_METHOD3(storeTransactionFee,
+    MOCK_CONST_METHOD4(storeTransactionFee,
                        void(LedgerManager& ledgerManager,
+                            TxHistoryWriter& writer,
                             LedgerEntryChanges const& changes, int txindex));
     MOCK_CONST_METHOD2(storeTransactionTiming,
-                       void(LedgerManager& ledgerManager, uint64 maxTime));
+                       void(TxHistoryWriter& writer, uint64 maxTime));
     MOCK_METHOD2(processTxFee, bool(Application& app, LedgerDelta* delta));
     MOCK_METHOD2(tryGetTxFeeAsset, bool(Database& db, AssetCode& txFeeAssetCode));
     MOCK_METHOD5(storeFeeForOpType,
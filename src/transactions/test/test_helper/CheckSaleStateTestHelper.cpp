@@ -216,7 +216,7 @@ CheckSaleStateResult CheckSaleStateHelper::applyCheckSaleStateTx(
     auto saleAntesBeforeTx = SaleAnteHelper::Instance()->loadSaleAntes(saleID, mTestManager->getDB());
 
     auto tx = createCheckSaleStateTx(source, saleID);
-    std::vector<LedgerDelta::KeyEntryMap> stateBeforeOps;
+    std::vector<LedgerDelta::StateSnapshot> stateBeforeOps;
     mTestManager->applyCheck(tx, stateBeforeOps);
     auto txResult = tx->getResult();
     const auto checkSaleStateResult = txResult.result.results()[0].tr().checkSaleStateResult();
@@ -230,7 +230,7 @@ CheckSaleStateResult CheckSaleStateHelper::applyCheckSaleStateTx(
     }
 
     REQUIRE(stateBeforeOps.size() == 1);
-    const auto stateBeforeOp = stateBeforeOps[0];
+    auto const& stateBeforeOp = *stateBeforeOps[0];
     auto stateHelper = StateBeforeTxHelper(stateBeforeOp);
     const auto effect = checkSaleStateResult.success().effect.effect();
     switch(effect)
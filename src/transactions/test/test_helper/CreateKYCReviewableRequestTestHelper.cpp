@@ -53,7 +53,7 @@ namespace stellar {
             txFrame = createUpdateKYCRequestTx(source, requestID, accountToUpdateKYC, accountType, kycData, kycLevel,
                                                allTasks);
 
-            std::vector<LedgerDelta::KeyEntryMap> stateBeforeOps;
+            std::vector<LedgerDelta::StateSnapshot> stateBeforeOps;
             mTestManager->applyCheck(txFrame, stateBeforeOps);
 
             auto txResult = txFrame->getResult();
@@ -101,7 +101,7 @@ namespace stellar {
             requestID = opResult.success().requestID;
 
             if (allTasks != nullptr && *allTasks == 0) {
-                return checkApprovedCreation(opResult, accountToUpdateKYC, stateBeforeOps[0]);
+                return checkApprovedCreation(opResult, accountToUpdateKYC, *stateBeforeOps[0]);
             }
 
             REQUIRE_FALSE(opResult.success().fulfilled);
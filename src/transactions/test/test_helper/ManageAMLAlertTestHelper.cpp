@@ -31,7 +31,7 @@ CreateAMLAlertRequestResult ManageAMLAlertTestHelper::applyCreateAmlAlert(
     CreateAMLAlertRequestResultCode expectedResultCode)
 {
     auto tx = createAmlAlertTx(source, balance, amount, reason, reference);
-    std::vector<LedgerDelta::KeyEntryMap> stateBeforeOps;
+    std::vector<LedgerDelta::StateSnapshot> stateBeforeOps;
     mTestManager->applyCheck(tx, stateBeforeOps);
     auto txResult = tx->getResult();
     const auto amlAlertResult = txResult.result.results()[0].tr().createAMLAlertRequestResult();
@@ -45,7 +45,7 @@ CreateAMLAlertRequestResult ManageAMLAlertTestHelper::applyCreateAmlAlert(
     }
 
     REQUIRE(stateBeforeOps.size() == 1);
-    const auto stateBeforeOp = stateBeforeOps[0];
+    auto const& stateBeforeOp = *stateBeforeOps[0];
     auto stateHelper = StateBeforeTxHelper(stateBeforeOp);
     auto balanceBeforeTx = stateHelper.getBalance(balance);
     auto balanceAfterTx = BalanceHelperLegacy::Instance()->loadBalance(balance, mTestManager->getDB());
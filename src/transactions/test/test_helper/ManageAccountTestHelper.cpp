@@ -22,7 +22,7 @@ namespace txtest
         Database& db = mTestManager->getDB();
         auto txFrame = createManageAccountTx(root, destination, accountType, toAdd, toRemove);
 
-        std::vector<LedgerDelta::KeyEntryMap> stateBeforeOps;
+        std::vector<LedgerDelta::StateSnapshot> stateBeforeOps;
         mTestManager->applyCheck(txFrame, stateBeforeOps);
 
         auto opRes = txFrame->getResult().result.results()[0];
@@ -34,7 +34,7 @@ namespace txtest
         if (actualResult != ManageAccountResultCode::SUCCESS)
             return opRes.tr().manageAccountResult();
 
-        StateBeforeTxHelper stateHelper(stateBeforeOps[0]);
+        StateBeforeTxHelper stateHelper(*stateBeforeOps[0]);
         auto accountBeforeTx = stateHelper.getAccount(destination);
         REQUIRE(accountBeforeTx);
         auto accountAfterTx = AccountHelper::Instance()->loadAccount(destination, db);
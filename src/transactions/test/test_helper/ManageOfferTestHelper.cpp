@@ -125,7 +125,7 @@ ManageOfferResult ManageOfferTestHelper::applyManageOffer(Account& source,
     ManageOfferOp& manageOfferOp, ManageOfferResultCode expectedResult)
 {
     auto txFrame = createManageOfferTx(source, manageOfferOp);
-    std::vector<LedgerDelta::KeyEntryMap> stateBeforeOps;
+    std::vector<LedgerDelta::StateSnapshot> stateBeforeOps;
     mTestManager->applyCheck(txFrame, stateBeforeOps);
     auto txResult = txFrame->getResult();
     const auto manageOfferResult = txResult.result.results()[0].tr().manageOfferResult();
@@ -139,7 +139,7 @@ ManageOfferResult ManageOfferTestHelper::applyManageOffer(Account& source,
     }
 
     REQUIRE(stateBeforeOps.size() == 1);
-    auto stateBeforeOp = stateBeforeOps[0];
+    auto stateBeforeOp = *stateBeforeOps[0];
     const auto isCreate = manageOfferOp.offerID == 0;
     if (isCreate)
     {
@@ -143,7 +143,7 @@ ManageSaleTestHelper::applyManageSaleTx(Account& source, uint64_t saleID,
     auto saleAntesBeforeTx =
         SaleAnteHelper::Instance()->loadSaleAntes(saleID, db);
 
-    std::vector<LedgerDelta::KeyEntryMap> stateBeforeOp;
+    std::vector<LedgerDelta::StateSnapshot> stateBeforeOp;
     TransactionFramePtr txFrame;
     txFrame = createManageSaleTx(source, saleID, data);
     mTestManager->applyCheck(txFrame, stateBeforeOp);
@@ -243,7 +243,7 @@ ManageSaleTestHelper::applyManageSaleTx(Account& source, uint64_t saleID,
     {
         REQUIRE(!saleAfterOp);
         REQUIRE(stateBeforeOp.size() == 1);
-        StateBeforeTxHelper stateBeforeTxHelper(stateBeforeOp[0]);
+        StateBeforeTxHelper stateBeforeTxHelper(*stateBeforeOp[0]);
         CheckSaleStateHelper(mTestManager)
             .ensureCancel(saleID, stateBeforeTxHelper, saleAntesBeforeTx);
         break;
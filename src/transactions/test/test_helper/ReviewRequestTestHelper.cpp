@@ -36,7 +36,7 @@ ReviewRequestResult ReviewRequestHelper::applyReviewRequestTx(
     auto txFrame = createReviewRequestTx(source, requestID, requestHash,
                                          requestType, action, rejectReason);
 
-    std::vector<LedgerDelta::KeyEntryMap> stateBeforeOp;
+    std::vector<LedgerDelta::StateSnapshot> stateBeforeOp;
     mTestManager->applyCheck(txFrame, stateBeforeOp);
     auto txResult = txFrame->getResult();
     auto opResult = txResult.result.results()[0];
@@ -47,7 +47,7 @@ ReviewRequestResult ReviewRequestHelper::applyReviewRequestTx(
     auto txOperation = txFrame->getOperations()[0]->getOperation();
     reviewChecker.setOperation(txOperation);
     REQUIRE(stateBeforeOp.size() == 1);
-    const StateBeforeTxHelper stateBeforeTxHelper(stateBeforeOp[0]);
+    const StateBeforeTxHelper stateBeforeTxHelper(*stateBeforeOp[0]);
     reviewChecker.setStateBeforeTxHelper(stateBeforeTxHelper);
 
     auto reviewResult = opResult.tr().reviewRequestResult();
@@ -49,7 +49,7 @@ namespace stellar {
             app.getLedgerManager().closeLedger(ledgerData);
         }
 
-        bool TestManager::apply(TransactionFramePtr tx, std::vector<LedgerDelta::KeyEntryMap> &stateBeforeOp, LedgerDelta &txDelta) {
+        bool TestManager::apply(TransactionFramePtr tx, std::vector<LedgerDelta::StateSnapshot> &stateBeforeOp, LedgerDelta &txDelta) {
             tx->clearCached();
             bool isTxValid = tx->checkValid(mApp);
             auto validationResult = tx->getResult();
@@ -105,11 +105,11 @@ namespace stellar {
         }
 
         bool TestManager::applyCheck(TransactionFramePtr tx) {
-            std::vector<LedgerDelta::KeyEntryMap> stateBeforeOp;
+            std::vector<LedgerDelta::StateSnapshot> stateBeforeOp;
             return applyCheck(tx, stateBeforeOp);
         }
 
-        bool TestManager::applyCheck(TransactionFramePtr tx, std::vector<LedgerDelta::KeyEntryMap> &stateBeforeOp) {
+        bool TestManager::applyCheck(TransactionFramePtr tx, std::vector<LedgerDelta::StateSnapshot> &stateBeforeOp) {
             LedgerDeltaImpl delta(mLm.getCurrentLedgerHeader(), mDB);
             const bool isApplied = apply(tx, stateBeforeOp, delta);
             // validates db state
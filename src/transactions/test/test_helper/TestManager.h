@@ -18,7 +18,7 @@ namespace stellar {
             Database& mDB;
             LedgerManager& mLm;
 
-            bool apply(TransactionFramePtr tx, std::vector<LedgerDelta::KeyEntryMap> &stateBeforeOp, LedgerDelta &txDelta);
+            bool apply(TransactionFramePtr tx, std::vector<LedgerDelta::StateSnapshot> &stateBeforeOp, LedgerDelta &txDelta);
 
             void checkResult(TransactionResult result, bool mustSuccess);
 
@@ -55,7 +55,7 @@ namespace stellar {
 
             bool applyCheck(TransactionFramePtr tx);
 
-            bool applyCheck(TransactionFramePtr tx, std::vector<LedgerDelta::KeyEntryMap> &stateBeforeOp);
+            bool applyCheck(TransactionFramePtr tx, std::vector<LedgerDelta::StateSnapshot> &stateBeforeOp);
 
             // closes an empty ledger on given time
             void advanceToTime(uint64_t closeTime);
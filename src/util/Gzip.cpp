@@ -0,0 +1,182 @@
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Gzip.h"
+#include "crypto/ByteSlice.h"
+#include "crypto/SHA.h"
+#include "util/Logging.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <zlib.h>
+
+namespace stellar
+{
+
+namespace
+{
+const size_t GZIP_CHUNK_SIZE = 64 * 1024;
+
+void
+throwGzipError(std::string const& what, std::string const& filename,
+               gzFile file = nullptr)
+{
+    std::string msg = what + ": " + filename;
+    if (file)
+    {
+        int err = Z_OK;
+        msg += ", reason: ";
+        msg += gzerror(file, &err);
+    }
+    CLOG(ERROR, "Fs") << msg;
+    throw std::runtime_error(msg);
+}
+}
+
+void
+gzipFile(std::string const& src, std::string const& dst)
+{
+    std::ifstream in(src, std::ifstream::binary);
+    if (!in)
+    {
+        throwGzipError("failed to open file for compression", src);
+    }
+
+    GzipOutputFile out;
+    out.open(dst);
+    std::vector<char> buf(GZIP_CHUNK_SIZE);
+    while (in)
+    {
+        in.read(buf.data(), buf.size());
+        if (in.gcount() > 0 &&
+            !out.write(buf.data(), static_cast<size_t>(in.gcount())))
+        {
+            throwGzipError("failed to write gzip file", dst);
+        }
+    }
+    if (in.bad())
+    {
+        throwGzipError("failed to read file for compression", src);
+    }
+    out.close();
+    if (!out.good())
+    {
+        throwGzipError("failed to finish gzip file", dst);
+    }
+}
+
+void
+gunzipFile(std::string const& src, std::string const& dst, SHA256* hasher)
+{
+    gzFile in = gzopen(src.c_str(), "rb");
+    if (!in)
+    {
+        throwGzipError("failed to open gzip file", src);
+    }
+    gzbuffer(in, GZIP_CHUNK_SIZE);
+
+    std::vector<char> buf(GZIP_CHUNK_SIZE);
+    try
+    {
+        std::ofstream out(dst, std::ofstream::binary | std::ofstream::trunc);
+        if (!out)
+        {
+            throwGzipError("failed to open file for decompression", dst);
+        }
+
+        int n;
+        while ((n = gzread(in, buf.data(), static_cast<unsigned>(buf.size()))) >
+               0)
+        {
+            // zlib passes non-gzip input through unchanged, `gzip -d` rejects
+            // it
+            if (gzdirect(in))
+            {
+                throwGzipError("not in gzip format", src);
+            }
+            if (!out.write(buf.data(), n))
+            {
+                throwGzipError("failed to write decompressed file", dst);
+            }
+            if (hasher)
+            {
+                hasher->add(ByteSlice(buf.data(), n));
+            }
+        }
+        if (n < 0)
+        {
+            throwGzipError("failed to decompress", src, in);
+        }
+        out.close();
+        if (!out)
+        {
+            throwGzipError("failed to write decompressed file", dst);
+        }
+    }
+    catch (...)
+    {
+        gzclose(in);
+        throw;
+    }
+    // a truncated stream reads as a short one, only closing tells
+    if (gzclose(in) != Z_OK)
+    {
+        throwGzipError("failed to decompress", src);
+    }
+}
+
+GzipOutputFile::~GzipOutputFile()
+{
+    close();
+}
+
+void
+GzipOutputFile::open(std::string const& filename)
+{
+    close();
+    mFile = gzopen(filename.c_str(), "wb");
+    if (!mFile)
+    {
+        throwGzipError("failed to open gzip file", filename);
+    }
+    gzbuffer(mFile, GZIP_CHUNK_SIZE);
+    mGood = true;
+}
+
+bool
+GzipOutputFile::write(char const* data, size_t size)
+{
+    if (!mGood)
+    {
+        return false;
+    }
+    while (size > 0)
+    {
+        auto chunk = static_cast<unsigned>(std::min(size, GZIP_CHUNK_SIZE));
+        if (gzwrite(mFile, data, chunk) != static_cast<int>(chunk))
+        {
+            mGood = false;
+            return false;
+        }
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+void
+GzipOutputFile::close()
+{
+    if (mFile)
+    {
+        if (gzclose(mFile) != Z_OK)
+        {
+            mGood = false;
+        }
+        mFile = nullptr;
+    }
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Copyright 2017 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <string>
+
+struct gzFile_s;
+
+namespace stellar
+{
+class SHA256;
+
+////
+// In-process replacements for `gzip` and `gzip -d`, streaming through zlib in
+// fixed size chunks. Both throw std::runtime_error on failure, in which case
+// `dst` may be left partially written.
+////
+
+// Compresses `src` into the gzip file `dst`.
+void gzipFile(std::string const& src, std::string const& dst);
+
+// Decompresses the gzip file `src` into `dst`; when `hasher` is given, every
+// decompressed byte is also added to it.
+void gunzipFile(std::string const& src, std::string const& dst,
+                SHA256* hasher = nullptr);
+
+/**
+ * Writes a gzip file, compressing the data as it is written.
+ */
+class GzipOutputFile : NonMovableOrCopyable
+{
+    gzFile_s* mFile{nullptr};
+    bool mGood{false};
+
+  public:
+    ~GzipOutputFile();
+
+    // Throws std::runtime_error if the file can not be opened.
+    void open(std::string const& filename);
+    bool write(char const* data, size_t size);
+    void close();
+
+    bool
+    good() const
+    {
+        return mGood;
+    }
+};
+}
@@ -0,0 +1,544 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/JsonValidator.h"
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+
+namespace stellar
+{
+
+const size_t JsonValidator::MAX_DEPTH;
+
+namespace
+{
+// the tokens of jsoncpp's Reader, read the same way
+enum TokenType
+{
+    TOKEN_END,
+    TOKEN_OBJECT_BEGIN,
+    TOKEN_OBJECT_END,
+    TOKEN_ARRAY_BEGIN,
+    TOKEN_ARRAY_END,
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_TRUE,
+    TOKEN_FALSE,
+    TOKEN_NULL,
+    TOKEN_COMMA,
+    TOKEN_COLON,
+    TOKEN_COMMENT,
+    TOKEN_ERROR
+};
+
+struct Token
+{
+    TokenType mType;
+    char const* mStart;
+    char const* mEnd;
+    // strings only: every escape sequence decodes
+    bool mValidEscapes;
+};
+
+bool
+isHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+           (c >= 'A' && c <= 'F');
+}
+
+unsigned int
+hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    return c - 'A' + 10;
+}
+
+// length of the valid escape sequence following a backslash at `p`, 0 if it
+// is not valid; a high surrogate takes the \u escape that follows with it,
+// whatever its value
+size_t
+escapeLength(char const* p, char const* end)
+{
+    if (p == end)
+    {
+        return 0;
+    }
+    switch (*p)
+    {
+    case '"':
+    case '/':
+    case '\\':
+    case 'b':
+    case 'f':
+    case 'n':
+    case 'r':
+    case 't':
+        return 1;
+    case 'u':
+        break;
+    default:
+        return 0;
+    }
+
+    if (end - p < 5)
+    {
+        return 0;
+    }
+    unsigned int unicode = 0;
+    for (int i = 1; i <= 4; i++)
+    {
+        if (!isHex(p[i]))
+        {
+            return 0;
+        }
+        unicode = unicode * 16 + hexValue(p[i]);
+    }
+    if (unicode < 0xD800 || unicode > 0xDBFF)
+    {
+        return 5;
+    }
+
+    if (end - p < 11 || p[5] != '\\' || p[6] != 'u')
+    {
+        return 0;
+    }
+    for (int i = 7; i <= 10; i++)
+    {
+        if (!isHex(p[i]))
+        {
+            return 0;
+        }
+    }
+    return 11;
+}
+
+bool
+isValidNumber(Token const& token)
+{
+    bool isDouble = false;
+    for (auto p = token.mStart; p != token.mEnd; ++p)
+    {
+        isDouble = isDouble || *p == '.' || *p == 'e' || *p == 'E' ||
+                   *p == '+' || (*p == '-' && p != token.mStart);
+    }
+    if (!isDouble)
+    {
+        // digits with an optional leading minus, the reader takes even a
+        // lone minus for zero
+        return true;
+    }
+
+    // the reader hands these to sscanf, so that is what decides
+    double value = 0;
+    size_t const length = token.mEnd - token.mStart;
+    char buffer[33];
+    if (length < sizeof(buffer))
+    {
+        std::memcpy(buffer, token.mStart, length);
+        buffer[length] = 0;
+        return std::sscanf(buffer, "%lf", &value) == 1;
+    }
+    std::string number(token.mStart, token.mEnd);
+    return std::sscanf(number.c_str(), "%lf", &value) == 1;
+}
+
+class Scanner
+{
+    char const* mCurrent;
+    char const* const mEnd;
+
+  public:
+    Scanner(char const* begin, char const* end) : mCurrent(begin), mEnd(end)
+    {
+    }
+
+    char
+    peek() const
+    {
+        return mCurrent != mEnd ? *mCurrent : 0;
+    }
+
+    char
+    next()
+    {
+        return mCurrent != mEnd ? *mCurrent++ : 0;
+    }
+
+    void
+    skipSpaces()
+    {
+        while (mCurrent != mEnd && (*mCurrent == ' ' || *mCurrent == '\t' ||
+                                    *mCurrent == '\r' || *mCurrent == '\n'))
+        {
+            ++mCurrent;
+        }
+    }
+
+    Token
+    readToken()
+    {
+        Token token;
+        token.mValidEscapes = false;
+        skipSpaces();
+        token.mStart = mCurrent;
+        bool ok = true;
+        switch (next())
+        {
+        case '{':
+            token.mType = TOKEN_OBJECT_BEGIN;
+            break;
+        case '}':
+            token.mType = TOKEN_OBJECT_END;
+            break;
+        case '[':
+            token.mType = TOKEN_ARRAY_BEGIN;
+            break;
+        case ']':
+            token.mType = TOKEN_ARRAY_END;
+            break;
+        case '"':
+            token.mType = TOKEN_STRING;
+            ok = readString(token.mValidEscapes);
+            break;
+        case '/':
+            token.mType = TOKEN_COMMENT;
+            ok = readComment();
+            break;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '-':
+            token.mType = TOKEN_NUMBER;
+            readNumber();
+            break;
+        case 't':
+            token.mType = TOKEN_TRUE;
+            ok = match("rue", 3);
+            break;
+        case 'f':
+            token.mType = TOKEN_FALSE;
+            ok = match("alse", 4);
+            break;
+        case 'n':
+            token.mType = TOKEN_NULL;
+            ok = match("ull", 3);
+            break;
+        case ',':
+            token.mType = TOKEN_COMMA;
+            break;
+        case ':':
+            token.mType = TOKEN_COLON;
+            break;
+        case 0:
+            // the end of the document, or a NUL character
+            token.mType = TOKEN_END;
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok)
+        {
+            token.mType = TOKEN_ERROR;
+        }
+        token.mEnd = mCurrent;
+        return token;
+    }
+
+    // skips the comments in front of the next token
+    Token
+    readTokenSkippingComments()
+    {
+        auto token = readToken();
+        while (token.mType == TOKEN_COMMENT)
+        {
+            token = readToken();
+        }
+        return token;
+    }
+
+  private:
+    bool
+    match(char const* pattern, size_t length)
+    {
+        if (static_cast<size_t>(mEnd - mCurrent) < length ||
+            std::memcmp(mCurrent, pattern, length) != 0)
+        {
+            return false;
+        }
+        mCurrent += length;
+        return true;
+    }
+
+    void
+    readNumber()
+    {
+        while (mCurrent != mEnd &&
+               ((*mCurrent >= '0' && *mCurrent <= '9') || *mCurrent == '.' ||
+                *mCurrent == 'e' || *mCurrent == 'E' || *mCurrent == '+' ||
+                *mCurrent == '-'))
+        {
+            ++mCurrent;
+        }
+    }
+
+    // finds the closing quote the way the reader does, skipping one
+    // character after each backslash, and checks the escapes on the way
+    bool
+    readString(bool& validEscapes)
+    {
+        validEscapes = true;
+        char c = 0;
+        while (mCurrent != mEnd)
+        {
+            // only quotes and backslashes need a closer look
+            auto run = mCurrent;
+            while (run != mEnd && *run != '"' && *run != '\\')
+            {
+                ++run;
+            }
+            if (run != mCurrent)
+            {
+                c = run[-1];
+                mCurrent = run;
+                continue;
+            }
+
+            c = next();
+            if (c == '"')
+            {
+                break;
+            }
+            if (c != '\\')
+            {
+                continue;
+            }
+            // a valid escape has neither quotes nor lone backslashes in it,
+            // so skipping all of it agrees with skipping one character
+            auto length = validEscapes ? escapeLength(mCurrent, mEnd) : 0;
+            if (length != 0)
+            {
+                mCurrent += length;
+            }
+            else
+            {
+                validEscapes = false;
+                next();
+            }
+        }
+        return c == '"';
+    }
+
+    bool
+    readComment()
+    {
+        char c = next();
+        if (c == '*')
+        {
+            while (mCurrent != mEnd)
+            {
+                if (next() == '*' && peek() == '/')
+                {
+                    break;
+                }
+            }
+            return next() == '/';
+        }
+        if (c == '/')
+        {
+            while (mCurrent != mEnd)
+            {
+                c = next();
+                if (c == '\r' || c == '\n')
+                {
+                    break;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+};
+}
+
+JsonValidator::JsonValidator() : mMaxDepth(MAX_DEPTH), mMaxSize(0)
+{
+}
+
+JsonValidator::JsonValidator(size_t maxDepth, size_t maxSize)
+    : mMaxDepth(std::min(maxDepth, MAX_DEPTH)), mMaxSize(maxSize)
+{
+}
+
+bool
+JsonValidator::isValidObject(std::string const& json) const
+{
+    return isValidObject(json.data(), json.data() + json.size());
+}
+
+bool
+JsonValidator::isValidObject(char const* begin, char const* end) const
+{
+    if (mMaxSize != 0 && static_cast<size_t>(end - begin) > mMaxSize)
+    {
+        return false;
+    }
+
+    Scanner scanner(begin, end);
+    if (mMaxDepth == 0 || scanner.readToken().mType != TOKEN_OBJECT_BEGIN)
+    {
+        return false;
+    }
+
+    // per open container: whether it is an object, and for objects whether
+    // the name of the last member was empty, in which case the reader takes
+    // a '}' in place of the next name
+    std::bitset<MAX_DEPTH> isObject;
+    std::bitset<MAX_DEPTH> emptyName;
+    size_t depth = 1;
+    isObject[0] = true;
+    emptyName[0] = true;
+
+    enum
+    {
+        MEMBER_NAME,
+        VALUE,
+        AFTER_VALUE
+    } state = MEMBER_NAME;
+
+    for (;;)
+    {
+        bool close = false;
+        switch (state)
+        {
+        case MEMBER_NAME:
+        {
+            auto name = scanner.readTokenSkippingComments();
+            if (name.mType == TOKEN_OBJECT_END && emptyName[depth - 1])
+            {
+                close = true;
+                break;
+            }
+            if (name.mType != TOKEN_STRING || !name.mValidEscapes ||
+                scanner.readToken().mType != TOKEN_COLON)
+            {
+                return false;
+            }
+            emptyName[depth - 1] = name.mEnd - name.mStart == 2;
+            state = VALUE;
+            break;
+        }
+        case VALUE:
+        {
+            auto value = scanner.readToken();
+            switch (value.mType)
+            {
+            case TOKEN_OBJECT_BEGIN:
+            case TOKEN_ARRAY_BEGIN:
+                if (depth >= mMaxDepth)
+                {
+                    return false;
+                }
+                isObject[depth] = value.mType == TOKEN_OBJECT_BEGIN;
+                emptyName[depth] = true;
+                depth++;
+                if (isObject[depth - 1])
+                {
+                    state = MEMBER_NAME;
+                    break;
+                }
+                scanner.skipSpaces();
+                if (scanner.peek() == ']')
+                {
+                    scanner.readToken();
+                    close = true;
+                    break;
+                }
+                state = VALUE;
+                break;
+            case TOKEN_STRING:
+                if (!value.mValidEscapes)
+                {
+                    return false;
+                }
+                state = AFTER_VALUE;
+                break;
+            case TOKEN_NUMBER:
+                if (!isValidNumber(value))
+                {
+                    return false;
+                }
+                state = AFTER_VALUE;
+                break;
+            case TOKEN_TRUE:
+            case TOKEN_FALSE:
+            case TOKEN_NULL:
+                state = AFTER_VALUE;
+                break;
+            default:
+                return false;
+            }
+            break;
+        }
+        case AFTER_VALUE:
+            if (isObject[depth - 1])
+            {
+                auto separator = scanner.readToken();
+                if (separator.mType != TOKEN_OBJECT_END &&
+                    separator.mType != TOKEN_COMMA &&
+                    separator.mType != TOKEN_COMMENT)
+                {
+                    return false;
+                }
+                // after comments the reader takes any token for the comma
+                while (separator.mType == TOKEN_COMMENT)
+                {
+                    separator = scanner.readToken();
+                }
+                close = separator.mType == TOKEN_OBJECT_END;
+                state = MEMBER_NAME;
+            }
+            else
+            {
+                auto separator = scanner.readTokenSkippingComments();
+                if (separator.mType != TOKEN_COMMA &&
+                    separator.mType != TOKEN_ARRAY_END)
+                {
+                    return false;
+                }
+                close = separator.mType == TOKEN_ARRAY_END;
+                state = VALUE;
+            }
+            break;
+        }
+
+        if (close)
+        {
+            if (--depth == 0)
+            {
+                // whatever follows the root object is ignored
+                return true;
+            }
+            state = AFTER_VALUE;
+        }
+    }
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include <cstddef>
+#include <string>
+
+namespace stellar
+{
+
+/**
+ * Validates the JSON documents carried by operations and ledger entries
+ * (asset and sale details, KYC data, external details of requests, ...)
+ * in a single pass, without building a DOM.
+ *
+ * Details are checked as part of consensus, so a document is accepted
+ * exactly when jsoncpp's Reader in strict mode parses it into an object,
+ * quirks included:
+ *
+ * - whatever follows the root object is ignored;
+ * - comments are skipped where the reader skips them, in between object
+ *   members and after array elements;
+ * - numbers with a fraction or an exponent are checked with sscanf, as the
+ *   reader does.
+ *
+ * Nesting is tracked in fixed size bitsets instead of recursion, so nothing
+ * is allocated, except for numbers of the last kind that are longer than 32
+ * characters.
+ *
+ * Documents larger than the size limit (0 for no limit), or nested deeper
+ * than the depth limit (the root object being at depth 1) are refused.
+ */
+class JsonValidator
+{
+  public:
+    // upper bound on the depth limit
+    static const size_t MAX_DEPTH = 65536;
+
+    // validator with no size limit and a depth limit of MAX_DEPTH
+    JsonValidator();
+    JsonValidator(size_t maxDepth, size_t maxSize);
+
+    bool isValidObject(std::string const& json) const;
+    bool isValidObject(char const* begin, char const* end) const;
+
+  private:
+    size_t mMaxDepth;
+    size_t mMaxSize;
+};
+}
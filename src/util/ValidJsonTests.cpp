@@ -2,7 +2,12 @@
 // Created by volodymyr on 13.01.18.
 //
 #include "util/types.h"
+#include "util/JsonValidator.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "lib/json/json.h"
 #include "test/test_marshaler.h"
+#include <chrono>
 
 using std::string;
 using namespace stellar;
@@ -52,4 +57,184 @@ TEST_CASE("json", "[valid_json]")
         string str = "{[\"one\", \"two\"]}";
         REQUIRE(!isValidJson(str));
     }
-}
\ No newline at end of file
+}
+
+namespace
+{
+// the validator isValidJson used to be, JsonValidator must agree with it
+bool
+isValidJsonWithReader(string const& str)
+{
+    Json::Features features = Json::Features::strictMode();
+    Json::Reader reader(features);
+
+    Json::Value root;
+    if (!reader.parse(str, root, false))
+        return false;
+
+    return root.isObject();
+}
+
+string
+kycPayload()
+{
+    string documents;
+    for (int i = 0; i < 8; i++)
+    {
+        documents += string(i == 0 ? "" : ", ") + "{\"type\": \"document_" +
+                     std::to_string(i) + "\", \"mime_type\": \"image/jpeg\", "
+                     "\"name\": \"scan_" + std::to_string(i) + ".jpg\", "
+                     "\"key\": \"dpurgh4infnubjhcost7fyeyrx5m4yxqjzbdmc3ugqfzk"
+                     "ntuuwc4gqkb\", \"size\": 2391812, \"approved\": true}";
+    }
+    return "{\n  \"first_name\": \"Ren\\u00e9e\",\n  \"last_name\": "
+           "\"O'Connor-Smith\",\n  \"date_of_birth\": "
+           "\"1987-03-14T00:00:00Z\",\n  \"address\": {\"line_1\": \"221B "
+           "Baker Street\", \"line_2\": null, \"city\": \"London\", "
+           "\"state\": \"\", \"postal_code\": \"NW1 6XE\", \"country\": "
+           "\"GB\"},\n  \"id_document\": {\"type\": \"passport\", "
+           "\"number\": \"533380006\", \"expires_at\": "
+           "\"2027-11-01T00:00:00Z\"},\n  \"investment\": {\"amount\": "
+           "25000.50, \"currency\": \"USD\", \"accredited\": false},\n  "
+           "\"notes\": \"Lives abroad since 2012\\nTax resident in the UK\\t"
+           "\\\"verified\\\"\",\n  \"documents\": [" +
+           documents + "]\n}";
+}
+
+string
+assetDetailsPayload()
+{
+    return "{\"name\": \"Token of Tokens\", \"logo\": {\"key\": "
+           "\"dpurgh4infnubjhcost7fyeyrx5m4yxqjzbdmc3ugqfzkntuuwc4gqkb\", "
+           "\"type\": \"image/png\"}, \"terms\": {\"key\": "
+           "\"6jcu5sxvumrg2zcdx3jecmdfrb3r4tkkvvsd5nrh7jr4avjcyr6awsls\", "
+           "\"name\": \"terms.pdf\", \"type\": \"application/pdf\"}, "
+           "\"external_system_type\": 4, \"is_coupon\": false}";
+}
+}
+
+TEST_CASE("json validator quirks", "[valid_json]")
+{
+    JsonValidator validator;
+    SECTION("content after the root object is ignored")
+    {
+        REQUIRE(validator.isValidObject("{\"a\": 1} trailing ]"));
+    }
+    SECTION("comments")
+    {
+        REQUIRE(validator.isValidObject("{/* c */ \"a\": [1 // c\n]}"));
+        REQUIRE(validator.isValidObject("{\"a\": 1 /* c */ , \"b\": 2}"));
+        // the reader takes whatever follows such a comment for the comma
+        REQUIRE(validator.isValidObject("{\"a\": 1 /* c */ : \"b\": 2}"));
+        REQUIRE(!validator.isValidObject("/* c */ {}"));
+        REQUIRE(!validator.isValidObject("{\"a\": /* c */ 1}"));
+        REQUIRE(!validator.isValidObject("{\"a\": 1 /* c }"));
+    }
+    SECTION("trailing commas")
+    {
+        REQUIRE(!validator.isValidObject("{\"a\": 1,}"));
+        REQUIRE(validator.isValidObject("{\"\": 1,}"));
+        REQUIRE(!validator.isValidObject("{\"a\": [1,]}"));
+    }
+    SECTION("strings")
+    {
+        REQUIRE(validator.isValidObject("{\"a\": \"\\uD83D\\uDE00\\/\\b\"}"));
+        REQUIRE(validator.isValidObject(string("{\"a\": \"\0\x01\"}", 11)));
+        REQUIRE(!validator.isValidObject("{\"a\": \"\\uD83D\"}"));
+        REQUIRE(!validator.isValidObject("{\"a\": \"\\u12\"}"));
+        REQUIRE(!validator.isValidObject("{\"a\": \"\\x\"}"));
+        REQUIRE(!validator.isValidObject("{\"a\": \"open}"));
+    }
+    SECTION("numbers")
+    {
+        REQUIRE(validator.isValidObject("{\"a\": -}"));
+        REQUIRE(validator.isValidObject("{\"a\": 00012}"));
+        REQUIRE(validator.isValidObject("{\"a\": 1.2.3}"));
+        REQUIRE(validator.isValidObject(
+            "{\"a\": 1.00000000000000000000000000000000000000001}"));
+        REQUIRE(!validator.isValidObject("{\"a\": .5}"));
+        REQUIRE(!validator.isValidObject("{\"a\": --1}"));
+    }
+    SECTION("embedded NUL ends the document")
+    {
+        REQUIRE(!validator.isValidObject(string("{\"a\":\0 1}", 9)));
+        REQUIRE(validator.isValidObject(string("{}\0garbage", 10)));
+    }
+    SECTION("limits")
+    {
+        string nested = "{\"a\": [[{\"b\": []}]]}";
+        REQUIRE(JsonValidator(5, 0).isValidObject(nested));
+        REQUIRE(!JsonValidator(4, 0).isValidObject(nested));
+        REQUIRE(JsonValidator(5, nested.size()).isValidObject(nested));
+        REQUIRE(!JsonValidator(5, nested.size() - 1).isValidObject(nested));
+
+        string deep = "{\"a\": " + string(JsonValidator::MAX_DEPTH, '[');
+        REQUIRE(!validator.isValidObject(deep));
+    }
+}
+
+TEST_CASE("json validator matches jsoncpp", "[valid_json]")
+{
+    std::vector<string> const pieces = {
+        "{", "}", "[", "]", ",", ":", "\"", "\\", "\\u", "D800", "\\uDC00",
+        "12", "-", "1.5", "1e", "e5", "+", ".", "true", "tru", "false",
+        "null", "/*", "*/", "//", "\n", " ", "a", "\"a\"", "\"\"", "\\n",
+        "\\x", string(1, '\0')};
+    JsonValidator validator;
+
+    auto check = [&](string const& str) {
+        INFO(str);
+        REQUIRE(validator.isValidObject(str) == isValidJsonWithReader(str));
+    };
+
+    check(kycPayload());
+    check(assetDetailsPayload());
+    for (int i = 0; i < 20000; i++)
+    {
+        string str = rand_flip() ? "{" : "";
+        auto n = rand_uniform(0, 12);
+        for (int j = 0; j < n; j++)
+        {
+            str += rand_element(pieces);
+        }
+        check(str);
+
+        // and documents that are mostly valid
+        str = kycPayload();
+        auto pos = rand_uniform<size_t>(0, str.size() - 1);
+        str.replace(pos, rand_uniform<size_t>(0, 2), rand_element(pieces));
+        check(str);
+    }
+}
+
+TEST_CASE("json validation performance",
+          "[valid_json][performance][hide]")
+{
+    int const n = 100000;
+    for (auto const& payload : {kycPayload(), assetDetailsPayload()})
+    {
+        REQUIRE(isValidJsonWithReader(payload));
+        REQUIRE(isValidJson(payload));
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++)
+        {
+            isValidJsonWithReader(payload);
+        }
+        auto reader = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++)
+        {
+            isValidJson(payload);
+        }
+        auto validator = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        LOG(INFO) << n << " validations of a " << payload.size()
+                  << " bytes payload: " << reader.count()
+                  << "ms with Json::Reader, " << validator.count()
+                  << "ms with JsonValidator";
+    }
+}
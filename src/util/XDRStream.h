@@ -10,7 +10,9 @@
 #include "xdrpp/marshal.h"
 #include "crypto/SHA.h"
 #include "crypto/ByteSlice.h"
+#include "util/Gzip.h"
 #include "util/Logging.h"
+#include "util/make_unique.h"
 
 namespace stellar
 {
@@ -23,6 +25,7 @@ class XDRInputFileStream
 {
     std::ifstream mIn;
     std::vector<char> mBuf;
+    std::vector<char> mStreamBuf;
 
   public:
     void
@@ -31,9 +34,17 @@ class XDRInputFileStream
         mIn.close();
     }
 
+    // bufferSize, when not 0, replaces the (small) default buffer of the
+    // underlying file stream, so that large files are read in big chunks.
     void
-    open(std::string const& filename)
+    open(std::string const& filename, size_t bufferSize = 0)
     {
+        if (bufferSize != 0)
+        {
+            // has to be set up before the file is opened
+            mStreamBuf.resize(bufferSize);
+            mIn.rdbuf()->pubsetbuf(mStreamBuf.data(), mStreamBuf.size());
+        }
         mIn.open(filename, std::ifstream::binary);
         if (!mIn)
         {
@@ -89,18 +100,42 @@ class XDRInputFileStream
 class XDROutputFileStream
 {
     std::ofstream mOut;
+    std::unique_ptr<GzipOutputFile> mGzOut;
     std::vector<char> mBuf;
 
+    bool
+    put(char const* data, size_t size)
+    {
+        if (mGzOut)
+        {
+            return mGzOut->write(data, size);
+        }
+        return static_cast<bool>(mOut.write(data, size));
+    }
+
   public:
     void
     close()
     {
+        if (mGzOut)
+        {
+            mGzOut->close();
+        }
         mOut.close();
     }
 
+    // With `gzip` set the objects are compressed as they are written and the
+    // file is a regular gzip file.
     void
-    open(std::string const& filename)
+    open(std::string const& filename, bool gzip = false)
     {
+        if (gzip)
+        {
+            mGzOut = make_unique<GzipOutputFile>();
+            mGzOut->open(filename);
+            return;
+        }
+        mGzOut.reset();
         mOut.open(filename, std::ofstream::binary | std::ofstream::trunc);
         if (!mOut)
         {
@@ -115,7 +150,7 @@ class XDROutputFileStream
 
     operator bool() const
     {
-        return mOut.good();
+        return mGzOut ? mGzOut->good() : mOut.good();
     }
 
     template <typename T>
@@ -140,7 +175,7 @@ class XDROutputFileStream
         xdr::xdr_put p(mBuf.data() + 4, mBuf.data() + 4 + sz);
         xdr_argpack_archive(p, t);
 
-        if (!mOut.write(mBuf.data(), sz + 4))
+        if (!put(mBuf.data(), sz + 4))
         {
             return false;
         }
@@ -4,6 +4,7 @@
 
 #include "util/types.h"
 #include "lib/util/uint128_t.h"
+#include "util/JsonValidator.h"
 #include <locale>
 #include <algorithm>
 
@@ -313,16 +314,8 @@ iequals(std::string const& a, std::string const& b)
     return true;
 }
 
-bool isValidJson(std::string strJson)
+bool isValidJson(std::string const& strJson)
 {
-    // get parser with strict configuration
-    Json::Features features = Json::Features::strictMode();
-    Json::Reader reader(features);
-
-    Json::Value root;
-    if (!reader.parse(strJson, root, false))
-        return false;
-
-    return root.isObject();
+    return JsonValidator().isValidObject(strJson);
 }
 }
@@ -93,8 +93,8 @@ bool isSetFlag(uint32 value, EnumType flag)
     return (flagValue & value) == flagValue;
 }
 
-// returns true if strJson is a valid json
-bool isValidJson(std::string strJson);
+// returns true if strJson is a valid json object, see JsonValidator
+bool isValidJson(std::string const& strJson);
 
 // returns true if result is valid (no overflow)
 bool safeSum(uint64_t a, uint64_t b, uint64_t& result);